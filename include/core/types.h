@@ -23,9 +23,14 @@
 
 #define GRID_SIZE (GRID_WIDTH * GRID_HEIGHT)
 
-/* Window dimensions (pixels) */
-#define WINDOW_WIDTH  GRID_WIDTH
-#define WINDOW_HEIGHT GRID_HEIGHT
+/* Window dimensions (pixels); larger worlds are shown through the camera */
+#ifndef WINDOW_WIDTH
+#define WINDOW_WIDTH  (GRID_WIDTH < 1024 ? GRID_WIDTH : 1024)
+#endif
+
+#ifndef WINDOW_HEIGHT
+#define WINDOW_HEIGHT (GRID_HEIGHT < 1024 ? GRID_HEIGHT : 1024)
+#endif
 
 /* Simulation tick rate (Hz) */
 #define TICK_HZ 120
@@ -34,11 +39,14 @@
 /* Gravity acceleration in cells/tick^2 (scaled from 9.81 m/s^2) */
 #define GRAVITY_ACCEL 0.08f
 
-/* Chunk size for dirty region tracking */
-#define CHUNK_SIZE 32
-#define CHUNKS_X ((GRID_WIDTH + CHUNK_SIZE - 1) / CHUNK_SIZE)
-#define CHUNKS_Y ((GRID_HEIGHT + CHUNK_SIZE - 1) / CHUNK_SIZE)
-#define CHUNK_COUNT (CHUNKS_X * CHUNKS_Y)
+/* Chunk size for dirty region tracking: a runtime power of two per world
+ * (World.chunk_size), bounded so chunk tables can be sized statically */
+#define CHUNK_SIZE_DEFAULT 32
+#define CHUNK_SIZE_MIN 8
+#define CHUNK_SIZE_MAX 128
+#define CHUNKS_X_MAX ((GRID_WIDTH + CHUNK_SIZE_MIN - 1) / CHUNK_SIZE_MIN)
+#define CHUNKS_Y_MAX ((GRID_HEIGHT + CHUNK_SIZE_MIN - 1) / CHUNK_SIZE_MIN)
+#define CHUNK_COUNT_MAX (CHUNKS_X_MAX * CHUNKS_Y_MAX)
 
 /* =============================================================================
  * Cell Flags (per-cell overlay states)
@@ -65,7 +73,8 @@ typedef enum {
     STATE_SOLID,
     STATE_POWDER,
     STATE_FLUID,
-    STATE_GAS
+    STATE_GAS,
+    STATE_COUNT
 } MaterialState;
 
 /* =============================================================================
@@ -120,9 +129,6 @@ typedef int16_t Fixed8;
 /* Check if coordinates are within grid bounds */
 #define IN_BOUNDS(x, y) ((x) >= 0 && (x) < GRID_WIDTH && (y) >= 0 && (y) < GRID_HEIGHT)
 
-/* Get chunk index from cell coordinates */
-#define CHUNK_IDX(x, y) (((y) / CHUNK_SIZE) * CHUNKS_X + ((x) / CHUNK_SIZE))
-
 /* Min/Max macros */
 #define MIN(a, b) ((a) < (b) ? (a) : (b))
 #define MAX(a, b) ((a) > (b) ? (a) : (b))
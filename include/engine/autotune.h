@@ -0,0 +1,57 @@
+/*
+ * autotune.h - Startup tuning of thread count, chunk size and kernel ISA
+ *
+ * Runs a short synthetic scene (sand, water, smoke, burning wood, acid)
+ * through the real tick pipeline for every candidate configuration and
+ * keeps the one with the lowest median tick time. The kernel ISA is tried
+ * afterwards on the winning configuration, unless PIXELSIM_ISA fixes it.
+ * Results are cached in a local text file, one line per host key (CPU
+ * model, CPU count, grid size, configured update modes).
+ *
+ * The update modes are different movement rules, not faster versions of
+ * the same one, so they are measured as configured and only become
+ * candidates when the caller opts in.
+ */
+#ifndef AUTOTUNE_H
+#define AUTOTUNE_H
+
+#include "core/types.h"
+#include "engine/simulation.h"
+#include "engine/kernels.h"
+
+#define AUTOTUNE_DEFAULT_FILE ".pixelsim-tune"
+
+typedef struct {
+    int threads;              /* Worker pool size */
+    int chunk_size;           /* World chunk size */
+    bool mode_tuned;          /* mode was a candidate */
+    UpdateMode mode;          /* Movement rule for powders, fluids and gases, if mode_tuned */
+    KernelIsa isa;            /* Kernel instruction set */
+    double tick_us;           /* Median tick time measured for this config */
+} TuneConfig;
+
+/* Cache file: PIXELSIM_TUNE_FILE or AUTOTUNE_DEFAULT_FILE */
+const char* autotune_cache_path(void);
+
+/* Host key for the cache ("<cpu model>/<cpus>/<width>x<height>/<powder>,<fluid>,<gas>"
+ * with sim's update modes) */
+void autotune_host_key(const Simulation* sim, char* buf, size_t size);
+
+/* Look up the cached config for this host and sim's modes; false if absent
+ * or unreadable */
+bool autotune_load(const Simulation* sim, const char* path, TuneConfig* config);
+
+/* Store config for this host and sim's modes, replacing its previous line */
+bool autotune_save(const Simulation* sim, const char* path, const TuneConfig* config);
+
+/* Measure all candidates on sim (its pool, and its modes with tune_modes,
+ * are changed while tuning) and return the fastest; verbose prints one
+ * line per candidate */
+bool autotune_run(Simulation* sim, TuneConfig* best, bool tune_modes, bool verbose);
+
+/* Apply threads, the kernel ISA (unless PIXELSIM_ISA is set) and, with
+ * apply_mode and a tuned mode, the update mode to sim. Call before creating
+ * the world so it is placed with the new pool. */
+bool autotune_apply(Simulation* sim, const TuneConfig* config, bool apply_mode);
+
+#endif /* AUTOTUNE_H */
@@ -0,0 +1,31 @@
+/*
+ * image.h - Writing rendered frames to disk (PNG and raw ARGB)
+ *
+ * PNG files are 8-bit RGB, composited over black like the window shows
+ * them, and compressed with a small built-in deflate encoder (no zlib).
+ * Raw files hold the frame as-is: width * height ARGB words in native
+ * (little-endian) order, rows top to bottom, no header.
+ */
+#ifndef IMAGE_H
+#define IMAGE_H
+
+#include "core/types.h"
+
+typedef enum {
+    IMAGE_PNG = 0,
+    IMAGE_RAW,
+} ImageFormat;
+
+/* Format from a file name extension (.png or .raw); false if unknown */
+bool image_format_from_path(const char* path, ImageFormat* format);
+
+/* Write an ARGB frame (pitch in pixels); false on I/O error */
+bool image_write(const char* path, ImageFormat format, const uint32_t* argb,
+                 int width, int height, int pitch);
+
+/* File name of frame index in a sequence: pattern holds exactly one %d
+ * conversion (optionally zero-padded, e.g. "out/frame_%05d.png"). False if
+ * the pattern is invalid or the result does not fit. */
+bool image_sequence_path(char* buf, size_t size, const char* pattern, int index);
+
+#endif /* IMAGE_H */
@@ -6,7 +6,7 @@
 
 #include "core/types.h"
 #include "world/world.h"
-#include "engine/simulation.h"
+#include "engine/sim_thread.h"
 #include "engine/render.h"
 #include <SDL2/SDL.h>
 
@@ -37,12 +37,18 @@ typedef struct {
     bool key_s;          /* Toggle stats */
     bool key_period;     /* Step once */
     
+    /* Camera (view changes of this frame) */
+    int pan_x, pan_y;    /* Arrow keys and middle-button drag, in window pixels */
+    int zoom_steps;      /* Ctrl + mouse wheel */
+    bool key_home;       /* Reset view */
+    
     /* Number keys for material selection */
     bool key_1, key_2, key_3, key_4, key_5, key_6, key_7, key_8, key_9, key_0;
     bool key_minus, key_equals;  /* For additional materials */
     
     /* Application state */
     bool quit_requested;
+    bool window_exposed;  /* Window contents must be redrawn */
     
 } Input;
 
@@ -59,8 +65,9 @@ void input_destroy(Input* input);
 /* Process SDL events and update input state */
 void input_update(Input* input);
 
-/* Apply input to world (painting, etc.) */
-void input_apply(Input* input, World* world, Simulation* sim, Renderer* renderer);
+/* Apply input: world edits and simulation controls are queued on the
+ * simulation thread, view changes go to the renderer */
+void input_apply(Input* input, SimThread* sim, Renderer* renderer);
 
 /* Get name of current material */
 const char* input_get_material_name(const Input* input);
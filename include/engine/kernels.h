@@ -0,0 +1,95 @@
+/*
+ * kernels.h - Hot loop kernels with runtime CPU dispatch
+ *
+ * Each kernel is compiled once per instruction set (generic C, SSE2, AVX2,
+ * AVX-512) and the best one the CPU supports is selected by kernels_init().
+ * PIXELSIM_ISA=scalar|sse2|avx2|avx512 caps the choice for testing. All
+ * variants produce bit-identical results, so the simulation stays
+ * deterministic across machines.
+ */
+#ifndef KERNELS_H
+#define KERNELS_H
+
+#include "core/types.h"
+
+/* Row classification tables are indexed by MaterialID */
+#define KERNEL_LUT_SIZE 16
+
+/* Fire glow: 7-tap [1 2 3 4 3 2 1] blur per axis; the 2D weight of the
+ * center is 16, so glow_add scales the blurred sum down by 16 */
+#define KERNEL_GLOW_RADIUS 3
+
+/* Temperature heatmap colors, one entry per degree: entry i covers
+ * [MIN_TEMPERATURE + i, MIN_TEMPERATURE + i + 1), so the color ramp's
+ * breakpoints fall on entry boundaries */
+#define KERNEL_HEAT_LUT_SIZE 2101
+
+typedef enum {
+    KERNEL_ISA_SCALAR = 0,    /* Portable C */
+    KERNEL_ISA_SSE2,
+    KERNEL_ISA_AVX2,
+    KERNEL_ISA_AVX512,        /* AVX-512F + BW */
+    KERNEL_ISA_COUNT
+} KernelIsa;
+
+/* One row of the heat diffusion stencil (see physics/thermal.c) */
+typedef struct {
+    const MaterialID* mat;    /* Row y; rows y -/+ 1 are at -/+ stride */
+    const float* temp;        /* Same layout as mat */
+    float* out;               /* temp_next, row y */
+    int stride;               /* Cells per row */
+    const float* conductivity;  /* Per material, KERNEL_LUT_SIZE entries */
+    const float* thermal_mass;  /* MAX(heat_capacity, 0.1) per material */
+} ThermalRow;
+
+typedef struct {
+    KernelIsa isa;
+
+    /* Bit i set iff lut[mat[i]] != 0, for n <= 64 cells */
+    uint64_t (*row_classify)(const MaterialID* mat, int n, const uint8_t* lut);
+
+    /* Diffuse cells [x0, x1) of an interior row (all four neighbors exist) */
+    void (*thermal_row)(const ThermalRow* row, int x0, int x1);
+
+    /* dst[i] = value */
+    void (*fill_u32)(uint32_t* dst, size_t n, uint32_t value);
+    
+    /* dst[i] = sum over |d| <= KERNEL_GLOW_RADIUS of tap(d) * src[i + d * step]
+     * (step 1: along a row, step = row length: down a column) */
+    void (*glow_blur)(uint16_t* dst, const uint16_t* src, int n, int step);
+    
+    /* dst[i] = src[i] with glow[i] / 16 added to red and half of it to
+     * green, saturating, except on fire cells; glowing pixels become opaque.
+     * Only writes dst, so it may point into a locked texture. */
+    void (*glow_add)(uint32_t* dst, const uint32_t* src, const uint16_t* glow,
+                     const MaterialID* mat, int n);
+    
+    /* dst[i] = palette[(mat[i] << MATERIAL_PALETTE_SHIFT) | variant[i]] */
+    void (*palette_row)(uint32_t* dst, const MaterialID* mat, const uint8_t* variant,
+                        int n, const uint32_t* palette);
+
+    /* dst[i] = hash32(seed ^ ((first + i) * 0x9E3779B1)): per-cell random
+     * values, independent of how a row is split */
+    void (*rng_fill)(uint32_t* dst, int n, uint32_t seed, uint32_t first);
+    
+    /* dst[i] = opaque 50% blend of dst[i] and the lut entry covering
+     * temp[i] (clamped to the temperature range) */
+    void (*heat_blend)(uint32_t* dst, const float* temp, int n, const uint32_t* lut);
+} KernelTable;
+
+/* Active kernels (generic C until kernels_init runs) */
+extern KernelTable kernels;
+
+/* Select kernels for this CPU (honours PIXELSIM_ISA); safe to call again */
+void kernels_init(void);
+
+/* Best instruction set the CPU and OS support */
+KernelIsa kernels_detect_isa(void);
+
+/* Install the kernels for isa (must be supported); false if unavailable */
+bool kernels_select(KernelIsa isa);
+
+/* Name of an instruction set ("scalar", "sse2", "avx2", "avx512") */
+const char* kernels_isa_name(KernelIsa isa);
+
+#endif /* KERNELS_H */
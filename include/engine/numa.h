@@ -0,0 +1,32 @@
+/*
+ * numa.h - CPU and NUMA node topology (Linux sysfs)
+ *
+ * Lists the CPUs this process may run on, grouped by NUMA node, so the
+ * worker pool can pin each worker next to the memory its bands live in.
+ * Without sysfs node information every CPU is reported on node 0.
+ */
+#ifndef NUMA_H
+#define NUMA_H
+
+#include "core/types.h"
+
+#define NUMA_MAX_CPUS  1024
+#define NUMA_MAX_NODES 64
+
+typedef struct {
+    int cpu_count;                      /* Usable CPUs, grouped by node */
+    int cpu_id[NUMA_MAX_CPUS];
+    int node_count;                     /* Nodes with at least one usable CPU */
+    int node_id[NUMA_MAX_NODES];        /* System node number */
+    int node_first[NUMA_MAX_NODES];     /* First index into cpu_id */
+    int node_cpus[NUMA_MAX_NODES];      /* CPUs on the node */
+} NumaTopology;
+
+/* Fill topology for the current process affinity mask (never fails) */
+void numa_detect(NumaTopology* topo);
+
+/* Parse a sysfs cpulist ("0-3,8,10-11") into a bitmap of NUMA_MAX_CPUS
+ * bits; returns the number of CPUs listed */
+int numa_parse_cpulist(const char* list, uint64_t* bits);
+
+#endif /* NUMA_H */
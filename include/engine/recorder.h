@@ -0,0 +1,52 @@
+/*
+ * recorder.h - Asynchronous frame-sequence export
+ *
+ * Rendered frames are copied into a bounded queue of frame slots. A writer
+ * thread converts and writes them, so the render loop only pays for that
+ * copy and never touches the disk. Output is an uncompressed Y4M stream
+ * (.y4m, 4:4:4 BT.601 limited range) or a numbered image sequence (.png or
+ * .raw pattern with one %d, see image.h).
+ */
+#ifndef RECORDER_H
+#define RECORDER_H
+
+#include "core/types.h"
+
+/* Frames queued before the policy applies */
+#define RECORD_QUEUE_DEFAULT 16
+
+typedef enum {
+    RECORD_DROP = 0,          /* Full queue: drop the new frame, never wait */
+    RECORD_BLOCK,             /* Full queue: wait for the writer (backpressure) */
+} RecordPolicy;
+
+typedef struct {
+    uint64_t submitted;       /* Frames passed to recorder_submit */
+    uint64_t written;
+    uint64_t dropped;         /* Rejected by RECORD_DROP or after a write error */
+    int max_queued;           /* Peak frames waiting in the queue */
+    bool failed;              /* A write failed; later frames were discarded */
+} RecordStats;
+
+typedef struct Recorder Recorder;
+
+/* True if path names an output the recorder can write (.y4m file, or a
+ * .png/.raw pattern with one %d) */
+bool recorder_check_path(const char* path);
+
+/* Parse "drop" or "block"; false if unknown */
+bool recorder_parse_policy(const char* name, RecordPolicy* policy);
+
+/* Open the output and start the writer thread. The Y4M frame rate is
+ * rate_num / rate_den frames per second. */
+Recorder* recorder_create(const char* path, int width, int height, int rate_num, int rate_den,
+                          RecordPolicy policy, int queue_frames);
+
+/* Queue a copy of an ARGB frame (pitch in pixels); false if it was dropped */
+bool recorder_submit(Recorder* recorder, const uint32_t* argb, int pitch);
+
+/* Write the queued frames, stop the thread and close the output; stats
+ * may be NULL */
+void recorder_close(Recorder* recorder, RecordStats* stats);
+
+#endif /* RECORDER_H */
@@ -6,6 +6,8 @@
 
 #include "core/types.h"
 #include "world/world.h"
+#include "engine/workers.h"
+#include "engine/image.h"
 #include <SDL2/SDL.h>
 
 /* =============================================================================
@@ -27,15 +29,102 @@ typedef enum {
  * Renderer State
  * ============================================================================= */
 
+/* What a chunk held when it was last drawn */
+#define RENDER_CHUNK_FIRE      0x1    /* Glow reaches into neighbor chunks */
+#define RENDER_CHUNK_ANIMATED  0x2    /* Colors change with lifetime (fire, smoke) */
+
+/* Upload rectangles per frame before falling back to a full upload */
+#define RENDER_DIRTY_MAX 256
+
+/* Per-chunk view state (Renderer.chunk_state) */
+#define RENDER_STATE_STALE    0x1   /* Base colors must be redrawn when visible */
+#define RENDER_STATE_CANVAS   0x2   /* Composed into the view canvas */
+#define RENDER_STATE_MIP      0x4   /* Mip pyramid matches the base colors */
+
+/* Camera zoom is a power of two: zoom > 0 draws 2^zoom pixels per cell,
+ * zoom < 0 shows 2^-zoom cells per pixel from mip level -zoom. Camera
+ * positions are in 1/RENDER_SUBCELL cells, one pixel at the largest zoom. */
+#define RENDER_ZOOM_MIN (-7)         /* log2(CHUNK_SIZE_MAX): top of a chunk's pyramid */
+#define RENDER_ZOOM_MAX 4
+#define RENDER_SUBCELL_SHIFT 4
+#define RENDER_SUBCELL (1 << RENDER_SUBCELL_SHIFT)
+#define RENDER_MIP_LEVELS 7          /* Levels above the cells, up to one texel per chunk */
+
+typedef struct {
+    int x, y;                /* World position of the top-left pixel, in subcells */
+    int zoom;                /* RENDER_ZOOM_MIN..RENDER_ZOOM_MAX */
+} RenderCamera;
+
+/* One mip texel: the material covering most of its cells and their mean
+ * color */
+typedef struct {
+    uint32_t color;          /* ARGB mean of the dominant material's cells */
+    uint16_t count;          /* Cells of that material in the texel */
+    MaterialID mat;
+} RenderMip;
+
+/* Rows of the frame being drawn: a locked texture region, or the whole
+ * pixel buffer on the copy path */
+typedef struct {
+    uint32_t* pixels;        /* Row y0 (NULL: nothing to draw this frame) */
+    int pitch;               /* Pixels per row */
+    int y0, y1;              /* Frame rows covered */
+} RenderTarget;
+
+/* Pointer to frame row y (y0 <= y < y1) */
+static inline uint32_t* render_target_row(const RenderTarget* target, int y) {
+    return target->pixels + (size_t)(y - target->y0) * target->pitch;
+}
+
 typedef struct {
     SDL_Window* window;
     SDL_Renderer* renderer;
     SDL_Texture* texture;    /* Texture for pixel-level rendering */
     
-    uint32_t* pixels;        /* Pixel buffer (ARGB format) */
+    uint32_t* pixels;        /* Composed frame on the copy path (ARGB), kept across frames */
+    uint32_t* base;          /* Cell colors before glow and overlays (world-sized) */
+    int world_width;         /* Size of the world base is allocated for */
+    int world_height;
+    
+    /* Zero-copy path: frames are composed straight into the locked
+     * streaming texture and pixels is not allocated */
+    bool zero_copy;
+    bool headless;           /* No window or texture; frames stay in pixels */
+    RenderTarget target;     /* Where this frame is drawn */
+    uint16_t* glow_emit;     /* Fire emission of one chunk plus glow margin, per worker */
+    uint16_t* glow_rows;     /* Emission blurred along rows, per worker */
     int width;
+    
+    /* Bands of the frame are drawn in parallel on this pool (NULL: inline) */
+    WorkerPool* workers;
+    int glow_workers;        /* Workers with glow scratch buffers */
     int height;
     
+    /* Incremental rendering: a chunk is redrawn when its world chunk version
+     * moved, or when it is animated and a tick has passed */
+    uint32_t chunk_version[CHUNK_COUNT_MAX];
+    uint8_t chunk_flags[CHUNK_COUNT_MAX];   /* RENDER_CHUNK_* */
+    uint32_t generation;     /* World generation last drawn */
+    int chunk_size;          /* Chunk size last drawn with, 0 = none yet */
+    bool full_redraw;        /* Redraw and upload everything next frame */
+    uint8_t chunk_state[CHUNK_COUNT_MAX];   /* RENDER_STATE_* */
+    
+    /* Camera. Unless the frame shows the world 1:1, visible chunks are
+     * composed into a world-space canvas (or reduced into mip levels when
+     * zoomed out) and the frame is resampled from them. */
+    RenderCamera camera;
+    bool view_active;        /* Last frame went through the canvas */
+    bool view_dirty;         /* Frame must be resampled */
+    int view_level;          /* Source level: 0 = canvas, L = mip level L */
+    uint32_t* canvas;        /* Composed cell colors (world-sized, view only) */
+    RenderMip* mip[RENDER_MIP_LEVELS + 1];  /* Level L: cells in 2^L blocks (0 unused) */
+    int* view_cols;          /* Per frame column: source texel, -1 outside the world */
+    
+    /* Texture regions changed this frame (copy path) */
+    SDL_Rect dirty[RENDER_DIRTY_MAX];
+    int dirty_count;
+    bool upload_all;
+    
     /* Debug overlay */
     OverlayMode overlay_mode;
     bool show_fps;
@@ -51,16 +140,25 @@ typedef struct {
  * Renderer Functions
  * ============================================================================= */
 
-/* Create renderer and window */
+/* Create renderer and window. Frames are drawn into the locked texture
+ * unless PIXELSIM_RENDER=copy or the texture cannot be locked. */
 Renderer* render_create(int width, int height, const char* title);
 
+/* Create a renderer without a window or SDL video: frames are drawn into
+ * pixels and can be saved with render_save_frame */
+Renderer* render_create_headless(int width, int height);
+
 /* Destroy renderer */
 void render_destroy(Renderer* renderer);
 
-/* Begin frame (clear buffers) */
+/* Draw on the given pool (borrowed, may be NULL); false if the per-worker
+ * buffers could not be allocated, in which case the old pool is kept */
+bool render_set_workers(Renderer* renderer, WorkerPool* workers);
+
+/* Begin frame (reset the list of changed regions) */
 void render_begin_frame(Renderer* renderer);
 
-/* Render the world */
+/* Redraw the chunks that changed since the last frame */
 void render_world(Renderer* renderer, const World* world);
 
 /* Render debug overlay */
@@ -69,8 +167,31 @@ void render_overlay(Renderer* renderer, const World* world);
 /* Render UI/HUD elements */
 void render_ui(Renderer* renderer, const World* world, double tick_time_ms, uint64_t tick_count, bool paused);
 
-/* End frame (present to screen) */
-void render_end_frame(Renderer* renderer);
+/* Upload changed regions and present; false if nothing changed and the
+ * present was skipped. Headless: true if the frame changed. */
+bool render_end_frame(Renderer* renderer);
+
+/* Switch to the copy path so every composed frame stays readable in
+ * pixels (for recording); call outside a frame. False if out of memory. */
+bool render_keep_frame(Renderer* renderer);
+
+/* Write the composed frame (copy path and headless only); false on error */
+bool render_save_frame(const Renderer* renderer, const char* path, ImageFormat format);
+
+/* Redraw everything next frame (window exposed, buffers lost) */
+void render_invalidate(Renderer* renderer);
+
+/* Move the camera by a distance in window pixels */
+void render_pan(Renderer* renderer, int dx, int dy);
+
+/* Zoom by steps powers of two, keeping window pixel (sx, sy) in place */
+void render_zoom(Renderer* renderer, int steps, int sx, int sy);
+
+/* Show the world from the top-left corner at one pixel per cell */
+void render_reset_view(Renderer* renderer);
+
+/* World cell under window pixel (sx, sy); may lie outside the world */
+void render_screen_to_world(const Renderer* renderer, int sx, int sy, int* x, int* y);
 
 /* Cycle to next overlay mode */
 void render_cycle_overlay(Renderer* renderer);
@@ -0,0 +1,64 @@
+/*
+ * sim_thread.h - Simulation on its own thread, with snapshot hand-off
+ *
+ * The simulation thread owns the world: it applies queued commands (paint,
+ * clear, pause, step), ticks at the simulation's fixed rate and after each
+ * batch of ticks publishes a read-only copy of the planes the renderer
+ * reads. Snapshots are handed over through a triple buffer, so neither
+ * side ever waits for the other and the renderer always sees whole ticks.
+ */
+#ifndef SIM_THREAD_H
+#define SIM_THREAD_H
+
+#include "core/types.h"
+#include "world/world.h"
+#include "engine/simulation.h"
+#include "engine/stages.h"
+
+/* Commands queued before the simulation thread drains them */
+#define SIM_COMMAND_MAX 1024
+
+typedef enum {
+    SIM_CMD_PAINT = 0,        /* Paint a line of material */
+    SIM_CMD_CLEAR,            /* Clear the world */
+    SIM_CMD_TOGGLE_PAUSE,
+    SIM_CMD_STEP,             /* Step one tick while paused */
+} SimCommandType;
+
+typedef struct {
+    SimCommandType type;
+    int x0, y0, x1, y1;       /* Paint: line end points */
+    int radius;               /* Paint: brush radius */
+    MaterialID mat;           /* Paint: material */
+} SimCommand;
+
+/* A published tick. world holds only what rendering reads (mat, flags,
+ * color_variant, temp, lifetime, chunk tables and geometry); the other
+ * planes are NULL. */
+typedef struct {
+    World world;
+
+    /* Simulation state at publication */
+    uint64_t tick_count;
+    double tick_time_ms;
+    bool paused;
+    double stage_time_us[STAGE_MAX];
+    double profile_total_us;
+} WorldSnapshot;
+
+typedef struct SimThread SimThread;
+
+/* Publish the current world and start ticking it on a new thread. sim and
+ * world belong to that thread until sim_thread_stop. */
+SimThread* sim_thread_start(Simulation* sim, World* world);
+
+/* Stop and join the thread; sim and world return to the caller */
+void sim_thread_stop(SimThread* thread);
+
+/* Queue a command (waits while the queue is full) */
+void sim_thread_send(SimThread* thread, const SimCommand* command);
+
+/* Latest published snapshot; valid until the next call */
+const WorldSnapshot* sim_thread_acquire(SimThread* thread);
+
+#endif /* SIM_THREAD_H */
@@ -6,6 +6,23 @@
 
 #include "core/types.h"
 #include "world/world.h"
+#include "world/deferred.h"
+#include "engine/workers.h"
+
+/* =============================================================================
+ * Movement Update Modes (selectable per material state)
+ * ============================================================================= */
+
+typedef enum {
+    UPDATE_MODE_SWEEP = 0,    /* In-place scan-order sweep (grid_iterate) */
+    UPDATE_MODE_MARGOLUS,     /* 2x2 block CA with alternating offsets */
+    UPDATE_MODE_INTENT,       /* Parallel move intents + deterministic resolve */
+    UPDATE_MODE_TILED,        /* Scan-order sweep in parallel tiles (grid_parallel.h) */
+    UPDATE_MODE_COUNT
+} UpdateMode;
+
+/* Stage dependency graph (engine/stages.h) */
+typedef struct StageGraph StageGraph;
 
 /* =============================================================================
  * Simulation State
@@ -26,12 +43,16 @@ typedef struct {
     double tick_time_ms;      /* Last tick duration in ms */
     double avg_tick_time_ms;  /* Running average */
     
-    /* Profiling - subsystem times in microseconds */
-    double profile_powder_us;
-    double profile_fluid_us;
-    double profile_fire_us;
-    double profile_gas_us;
-    double profile_total_us;
+    /* Tick stages with per-stage timing (engine/stages.h) */
+    StageGraph* stages;
+    double profile_total_us;  /* Sum of stage times, last tick */
+    
+    /* Movement update mode per material state (powder, fluid, gas) */
+    UpdateMode update_mode[STATE_COUNT];
+    
+    /* Worker pool for data-parallel passes, one scratch per worker */
+    WorkerPool* workers;
+    ThreadScratch* scratch;
     
     /* Simulation state */
     bool paused;
@@ -64,7 +85,7 @@ void simulation_toggle_pause(Simulation* sim);
 /* Step one tick when paused */
 void simulation_step_once(Simulation* sim);
 
-/* Get RNG value for this tick (deterministic) */
+/* Get RNG value for this tick (deterministic, per band in parallel passes) */
 uint32_t simulation_rand(Simulation* sim);
 
 /* Get random float [0, 1) */
@@ -73,6 +94,19 @@ float simulation_randf(Simulation* sim);
 /* Get random int in range [min, max] inclusive */
 int simulation_rand_range(Simulation* sim, int min, int max);
 
+/* Replace the worker pool (thread_count <= 0: PIXELSIM_THREADS or CPU
+ * count); keeps the old pool and returns false on failure */
+bool simulation_set_threads(Simulation* sim, int thread_count);
+
+/* Select movement update mode for a material state */
+void simulation_set_update_mode(Simulation* sim, MaterialState state, UpdateMode mode);
+
+/* Parse update mode name ("sweep", "margolus", "intent"); false if unknown */
+bool simulation_parse_update_mode(const char* name, UpdateMode* mode);
+
+/* Name of an update mode */
+const char* simulation_update_mode_name(UpdateMode mode);
+
 /* Reset simulation state */
 void simulation_reset(Simulation* sim);
 
@@ -0,0 +1,113 @@
+/*
+ * stages.h - Simulation stage graph with declared world-plane dependencies
+ *
+ * Every stage of a tick declares which world planes it reads and writes,
+ * and optionally a rate divisor: a stage with rate N runs on one tick out
+ * of N (at its phase offset) and scales its per-tick probabilities by the
+ * ticks it covers, see stage_scale_chance().
+ *
+ * Each tick the enabled stages are ordered into a dependency graph: a stage
+ * waits for every earlier stage whose writes it touches, or which reads what
+ * it writes. Stages with no path between them run concurrently on the
+ * worker pool; inside such a concurrent group each stage runs its own
+ * parallel loops inline. A stage that runs alone owns the whole pool.
+ */
+#ifndef STAGES_H
+#define STAGES_H
+
+#include "core/types.h"
+#include "world/world.h"
+#include "engine/simulation.h"
+
+/* =============================================================================
+ * World Planes
+ * ============================================================================= */
+
+typedef uint32_t PlaneMask;
+
+#define PLANE_MAT         (1u << 0)   /* mat (and mat_next for double buffering) */
+#define PLANE_FLAGS       (1u << 1)   /* Per-cell flags */
+#define PLANE_COLOR       (1u << 2)   /* color_variant */
+#define PLANE_VEL         (1u << 3)   /* vel_x, vel_y */
+#define PLANE_LIFETIME    (1u << 4)   /* lifetime */
+#define PLANE_TEMP        (1u << 5)   /* temp (current temperature) */
+#define PLANE_TEMP_NEXT   (1u << 6)   /* temp_next (diffusion target), chunk_warm */
+#define PLANE_CHUNKS      (1u << 7)   /* chunk_active_next, chunk_cost_next */
+#define PLANE_STATS       (1u << 8)   /* cells_updated */
+#define PLANE_RNG         (1u << 9)   /* Shared simulation_rand stream */
+#define PLANE_HEAT_MAT    (1u << 10)  /* heat_mat (tick-start copy of mat) */
+
+/* Everything a cell-moving sweep may touch */
+#define PLANE_MOVERS (PLANE_MAT | PLANE_FLAGS | PLANE_COLOR | PLANE_VEL | \
+                      PLANE_LIFETIME | PLANE_CHUNKS | PLANE_STATS | PLANE_RNG)
+
+/* =============================================================================
+ * Stages
+ * ============================================================================= */
+
+#define STAGE_MAX 32
+#define STAGE_PHASE_AUTO (-1)         /* Pick the least crowded phase */
+
+typedef void (*StageFunc)(Simulation* sim, World* world);
+
+typedef struct {
+    const char* name;
+    StageFunc func;
+    PlaneMask reads;
+    PlaneMask writes;
+    int rate;                         /* Run every rate ticks (0 or 1: every tick) */
+    int phase;                        /* Tick offset in [0, rate), or STAGE_PHASE_AUTO */
+} StageDesc;
+
+struct StageGraph {
+    int count;
+    StageDesc desc[STAGE_MAX];      /* In program order */
+    uint32_t deps[STAGE_MAX];       /* Bit i: waits for stage i (this tick) */
+    double time_us[STAGE_MAX];      /* Last measured duration */
+    uint64_t last_tick[STAGE_MAX];  /* Tick of the last run + 1, 0 = never */
+    int elapsed[STAGE_MAX];         /* Ticks covered by the current run */
+    int groups;                     /* Sequential groups in the last tick */
+};
+
+/* Check if two stages touch a common plane with at least one writer */
+bool stage_conflicts(const StageDesc* a, const StageDesc* b);
+
+/* Create an empty graph */
+StageGraph* stage_graph_create(void);
+
+/* Destroy graph */
+void stage_graph_destroy(StageGraph* graph);
+
+/* Append a stage (resolving STAGE_PHASE_AUTO); returns its index or -1 */
+int stage_graph_add(StageGraph* graph, const StageDesc* desc);
+
+/* Find a stage by name, -1 if absent */
+int stage_graph_find(const StageGraph* graph, const char* name);
+
+/* Change a stage's rate divisor and phase (STAGE_PHASE_AUTO re-staggers) */
+void stage_graph_set_rate(StageGraph* graph, int stage, int rate, int phase);
+
+/* Bitmask of stages due on the given tick */
+uint32_t stage_graph_due(const StageGraph* graph, uint64_t tick);
+
+/* Rebuild dependencies among the stages in the enabled bitmask */
+void stage_graph_build(StageGraph* graph, uint32_t enabled);
+
+/* Build and run the enabled stages for one tick, recording per-stage times */
+void stage_graph_run(StageGraph* graph, Simulation* sim, World* world, uint32_t enabled);
+
+/* Ticks covered by the stage running on the calling thread (1 outside) */
+int stage_current_elapsed(void);
+
+/* Chance that a per-tick event with probability p fires at least once in
+ * k ticks: 1 - (1 - p)^k */
+float stage_scale_chance(float p, int k);
+
+/* =============================================================================
+ * Registry
+ * ============================================================================= */
+
+/* Register a tick stage after the built-in ones; returns index or -1 */
+int simulation_register_stage(Simulation* sim, const StageDesc* desc);
+
+#endif /* STAGES_H */
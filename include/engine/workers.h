@@ -0,0 +1,81 @@
+/*
+ * workers.h - Fixed-size worker thread pool for data-parallel passes
+ */
+#ifndef WORKERS_H
+#define WORKERS_H
+
+#include "core/types.h"
+
+/* =============================================================================
+ * Worker Pool
+ *
+ * The calling thread participates as worker 0, so a pool of N workers owns
+ * N - 1 background threads. A pool of one worker runs everything inline.
+ * Each job is dealt into per-worker deques; idle workers steal from others.
+ *
+ * Workers are spread over the NUMA nodes the process may run on and pinned
+ * to one CPU each when PIXELSIM_PIN=1 (default: only on multi-node hosts).
+ * The calling thread is bound to worker 0's CPU only while it runs a job,
+ * so its own affinity, and that of threads it creates, is left alone.
+ * ============================================================================= */
+
+#define WORKERS_MAX 64
+
+typedef struct WorkerPool WorkerPool;
+
+/* Task body: process one item on the given worker (0 .. count-1) */
+typedef void (*WorkerTaskFunc)(void* ctx, int item, int worker);
+
+/* Create pool; thread_count <= 0 uses PIXELSIM_THREADS or the CPU count */
+WorkerPool* workers_create(int thread_count);
+
+/* Create a pool that is never pinned, for work sharing the CPUs of a
+ * pinned pool (the renderer next to the simulation) */
+WorkerPool* workers_create_unpinned(int thread_count);
+
+/* Stop threads and free the pool */
+void workers_destroy(WorkerPool* pool);
+
+/* The thread issuing jobs on a pinned pool is bound to worker 0's CPU by its
+ * first job and stays bound; give it its own CPU mask back, e.g. before it
+ * spawns threads that must not inherit that CPU */
+void workers_release_caller(void);
+
+/* Number of workers (including the calling thread) */
+int workers_count(const WorkerPool* pool);
+
+/* Workers a parallel loop issued from this thread would use: 1 inside a
+ * running task (nested loops run inline), workers_count() otherwise */
+int workers_concurrency(const WorkerPool* pool);
+
+/* Run func for items [0, count) and wait for completion. Each worker starts
+ * on a contiguous range; idle workers steal the tail of busy ones. */
+void workers_parallel_for(WorkerPool* pool, int count, WorkerTaskFunc func, void* ctx);
+
+/* Same, with an estimated cost per item: items are dealt largest-first to
+ * the least-loaded worker, and thieves take the cheapest remaining items.
+ * Tasks must not depend on which worker runs which item. */
+void workers_parallel_for_costed(WorkerPool* pool, int count, const uint32_t* cost,
+                                 WorkerTaskFunc func, void* ctx);
+
+/* Run func(ctx, worker, worker) exactly once on every worker and wait; used
+ * to first-touch memory from the thread that will own it */
+void workers_run_each(WorkerPool* pool, WorkerTaskFunc func, void* ctx);
+
+/* Home worker of item (of count): proportional, item * workers / count.
+ * Costed loops keep items on their home worker's NUMA node. */
+int workers_home(const WorkerPool* pool, int item, int count);
+
+/* NUMA nodes spanned by the workers */
+int workers_node_count(const WorkerPool* pool);
+
+/* System NUMA node number of a worker */
+int workers_node(const WorkerPool* pool, int worker);
+
+/* CPU a worker is pinned to, -1 if unpinned */
+int workers_cpu(const WorkerPool* pool, int worker);
+
+/* Number of online CPUs (at least 1) */
+int workers_cpu_count(void);
+
+#endif /* WORKERS_H */
@@ -6,6 +6,10 @@
 
 #include "core/types.h"
 
+/* Baked color variants per material; cells store a variant index */
+#define MATERIAL_PALETTE_SHIFT 6
+#define MATERIAL_PALETTE_SIZE  (1 << MATERIAL_PALETTE_SHIFT)
+
 /* =============================================================================
  * Material Properties Structure (data-driven)
  * ============================================================================= */
@@ -63,6 +67,9 @@ void material_init(void);
 /* Get material properties by ID */
 const MaterialProps* material_get(MaterialID id);
 
+/* Material by name, case-insensitive ("sand", "Water"); false if unknown */
+bool material_find(const char* name, MaterialID* id);
+
 /* Get material state by ID (convenience) */
 MaterialState material_state(MaterialID id);
 
@@ -81,7 +88,11 @@ bool material_is_empty(MaterialID id);
 /* Check if material is a gas type */
 bool material_is_gas(MaterialID id);
 
-/* Get color for material (with optional variation) */
-Color material_color(MaterialID id, uint32_t seed);
+/* Get color for material (variant in [0, MATERIAL_PALETTE_SIZE)) */
+Color material_color(MaterialID id, uint8_t variant);
+
+/* ARGB8888 palette baked by material_init, indexed by
+ * (id << MATERIAL_PALETTE_SHIFT) | variant */
+const uint32_t* material_palette(void);
 
 #endif /* MATERIAL_H */
@@ -25,10 +25,17 @@
 #define MIN_TEMPERATURE -100.0f     /* Minimum allowed temperature */
 #define MAX_TEMPERATURE 2000.0f     /* Maximum allowed temperature */
 #define AMBIENT_COOLING_RATE 0.001f /* Rate of cooling to ambient */
+#define THERMAL_WAKE_DELTA 0.05f    /* Per-tick change that keeps a chunk awake */
 
-/* Main thermal update function */
+/* Main thermal update function (diffusion, phase changes, swap) */
 void thermal_update(Simulation* sim, World* world);
 
+/* Individual thermal stages, in the order thermal_update runs them */
+void thermal_copy_materials(Simulation* sim, World* world);    /* mat -> heat_mat */
+void thermal_diffusion_update(Simulation* sim, World* world);  /* temp -> temp_next */
+void thermal_phase_update(Simulation* sim, World* world);      /* uses temp_next */
+void thermal_swap(Simulation* sim, World* world);              /* temp <-> temp_next, wakes warm chunks */
+
 /* Check and apply phase changes for a cell */
 void thermal_check_phase_change(Simulation* sim, World* world, int x, int y);
 
@@ -9,6 +9,7 @@
 
 #include "core/types.h"
 #include "world/world.h"
+#include "world/deferred.h"
 #include "materials/material.h"
 
 /* =============================================================================
@@ -166,20 +167,51 @@ static inline bool cell_gas_can_enter(const World* world, int x, int y) {
     return cell_get_type(world, x, y) == CELL_EMPTY;
 }
 
+/* Check if a mover of the given state can enter the target cell index.
+ * Powders sink through lighter fluids/gases, fluids displace gases,
+ * gases only enter empty cells. Used by the block and intent update modes. */
+static inline bool cell_mover_can_enter(const World* world, MaterialState state,
+                                         MaterialID source_mat, int target_idx) {
+    MaterialID target_mat = world->mat[target_idx];
+    MaterialState target_state = material_state(target_mat);
+
+    if (target_state == STATE_EMPTY) return true;
+
+    switch (state) {
+        case STATE_POWDER:
+            if (target_state != STATE_FLUID && target_state != STATE_GAS) return false;
+            return material_get(source_mat)->density > material_get(target_mat)->density;
+        case STATE_FLUID:
+            return target_state == STATE_GAS;
+        default:
+            return false;
+    }
+}
+
 /* =============================================================================
  * Cell Movement Operations
  *
  * Execute cell movement with proper state updates.
  * ============================================================================= */
 
-/* Move cell and mark as updated */
+/* Count one cell update (per-thread during parallel passes) */
+static inline void cell_count_update(World* world) {
+    if (thread_scratch) {
+        thread_scratch->cells_updated++;
+    } else {
+        world->cells_updated++;
+    }
+}
+
+/* Move cell and mark as updated. During a parallel pass the target must lie
+ * within the calling tile or its margin (grid_parallel.h). */
 static inline bool cell_move(World* world, int from_x, int from_y, int to_x, int to_y) {
     if (!IN_BOUNDS(from_x, from_y) || !IN_BOUNDS(to_x, to_y)) return false;
 
     world_swap_cells(world, from_x, from_y, to_x, to_y);
     world_add_flag(world, to_x, to_y, FLAG_UPDATED);
     world_add_flag(world, from_x, from_y, FLAG_UPDATED);
-    world->cells_updated++;
+    cell_count_update(world);
 
     return true;
 }
@@ -0,0 +1,64 @@
+/*
+ * deferred.h - Per-thread deferred writes for parallel chunk passes
+ *
+ * While a worker runs one item of a parallel pass (a tile of a chunk row,
+ * see grid_parallel.h, or a band of rows), cells are written directly, but
+ * writes to shared state go into the worker's scratch instead:
+ *   - chunk activations set bits in a per-worker bitset
+ *   - the update counter is per worker and the RNG stream per item
+ * deferred_merge() then ORs the bitsets into chunk_active_next and adds up
+ * the counters. No locks are taken during a pass. Outside a parallel pass
+ * thread_scratch is NULL and all writes are direct, exactly as before.
+ */
+#ifndef DEFERRED_H
+#define DEFERRED_H
+
+#include "core/types.h"
+#include "world/world.h"
+
+/* =============================================================================
+ * Per-Thread Scratch
+ * ============================================================================= */
+
+#define DEFERRED_CHUNK_WORDS ((CHUNK_COUNT_MAX + 63) / 64)
+
+typedef struct {
+    uint32_t rng;             /* Random stream of the bound tile or band */
+
+    /* Accumulated over a pass, cleared by deferred_merge */
+    uint32_t cells_updated;
+    uint64_t chunk_bits[DEFERRED_CHUNK_WORDS];
+} ThreadScratch;
+
+/* Scratch bound to the calling thread, NULL outside parallel passes */
+extern _Thread_local ThreadScratch* thread_scratch;
+
+/* =============================================================================
+ * Scratch Functions
+ * ============================================================================= */
+
+/* Allocate one scratch per worker */
+ThreadScratch* deferred_create(int count);
+
+/* Free scratch set */
+void deferred_destroy(ThreadScratch* set, int count);
+
+/* Bind scratch to the calling thread for one work item */
+static inline void deferred_bind(ThreadScratch* scratch, uint32_t rng) {
+    scratch->rng = rng ? rng : 1;   /* xorshift state must be non-zero */
+    thread_scratch = scratch;
+}
+
+static inline void deferred_unbind(void) {
+    thread_scratch = NULL;
+}
+
+/* Record a chunk activation */
+static inline void deferred_mark_chunk(ThreadScratch* scratch, int chunk_idx) {
+    scratch->chunk_bits[chunk_idx >> 6] |= (uint64_t)1 << (chunk_idx & 63);
+}
+
+/* Apply everything collected by the set after a parallel pass (single thread) */
+void deferred_merge(World* world, ThreadScratch* set, int count);
+
+#endif /* DEFERRED_H */
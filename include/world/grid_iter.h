@@ -33,6 +33,56 @@ typedef enum {
 /* Return true to continue iteration, false to stop */
 typedef bool (*CellUpdateFunc)(Simulation* sim, World* world, int x, int y, void* userdata);
 
+/* =============================================================================
+ * Sweep Kernels
+ *
+ * A sweep visits the cells of active chunks row by row, testing activity
+ * once per chunk span. The body is instantiated with a compile-time chunk
+ * shift for the common chunk sizes (16, 32, 64) so span bounds and chunk
+ * indices fold to constant shifts and masks; grid_sweep() picks the
+ * instance once per sweep and other sizes use the runtime shift. Every
+ * instance visits cells in the same order.
+ * ============================================================================= */
+
+static inline __attribute__((always_inline))
+bool grid_sweep_body(Simulation* sim, World* world, int shift,
+                     int y_start, int y_end, int y_step, bool scan_left,
+                     CellUpdateFunc func, void* userdata) {
+    int size = 1 << shift;
+    int chunks_x = (GRID_WIDTH + size - 1) >> shift;
+
+    for (int y = y_start; y != y_end; y += y_step) {
+        const bool* active = &world->chunk_active[(y >> shift) * chunks_x];
+
+        for (int k = 0; k < chunks_x; k++) {
+            int cx = scan_left ? k : chunks_x - 1 - k;
+            if (!active[cx]) continue;
+
+            int x_start = cx << shift;
+            int x_end = MIN(x_start + size, GRID_WIDTH);
+            for (int i = x_start; i < x_end; i++) {
+                int x = scan_left ? i : x_start + x_end - 1 - i;
+                if (!func(sim, world, x, y, userdata)) return false;
+            }
+        }
+    }
+    return true;
+}
+
+/* Sweep rows y_start, y_start + y_step, ... (excluding y_end); false if the
+ * callback stopped it */
+static inline bool grid_sweep(Simulation* sim, World* world,
+                              int y_start, int y_end, int y_step, bool scan_left,
+                              CellUpdateFunc func, void* userdata) {
+    switch (world->chunk_shift) {
+        case 4:  return grid_sweep_body(sim, world, 4, y_start, y_end, y_step, scan_left, func, userdata);
+        case 5:  return grid_sweep_body(sim, world, 5, y_start, y_end, y_step, scan_left, func, userdata);
+        case 6:  return grid_sweep_body(sim, world, 6, y_start, y_end, y_step, scan_left, func, userdata);
+        default: return grid_sweep_body(sim, world, world->chunk_shift, y_start, y_end, y_step,
+                                        scan_left, func, userdata);
+    }
+}
+
 /* =============================================================================
  * Grid Iteration Functions
  * ============================================================================= */
@@ -45,37 +95,10 @@ static inline void grid_iterate(Simulation* sim, World* world,
     bool scan_left = (horiz == ITER_LEFT_RIGHT) ||
                      (horiz == ITER_RANDOM && (simulation_rand(sim) & 1));
 
-    /* Determine vertical bounds */
-    int y_start, y_end, y_step;
     if (dir == ITER_TOP_DOWN) {
-        y_start = 0;
-        y_end = GRID_HEIGHT;
-        y_step = 1;
+        grid_sweep(sim, world, 0, GRID_HEIGHT, 1, scan_left, func, userdata);
     } else {
-        y_start = GRID_HEIGHT - 1;
-        y_end = -1;
-        y_step = -1;
-    }
-
-    /* Iterate */
-    for (int y = y_start; y != y_end; y += y_step) {
-        int chunk_y = y / CHUNK_SIZE;
-
-        if (scan_left) {
-            for (int x = 0; x < GRID_WIDTH; x++) {
-                int chunk_x = x / CHUNK_SIZE;
-                if (world_is_chunk_active(world, chunk_x, chunk_y)) {
-                    if (!func(sim, world, x, y, userdata)) return;
-                }
-            }
-        } else {
-            for (int x = GRID_WIDTH - 1; x >= 0; x--) {
-                int chunk_x = x / CHUNK_SIZE;
-                if (world_is_chunk_active(world, chunk_x, chunk_y)) {
-                    if (!func(sim, world, x, y, userdata)) return;
-                }
-            }
-        }
+        grid_sweep(sim, world, GRID_HEIGHT - 1, -1, -1, scan_left, func, userdata);
     }
 }
 
@@ -101,6 +124,14 @@ typedef struct {
     int total_passes;   /* Total number of passes */
 } PassInfo;
 
+static inline bool _clear_updated_callback(Simulation* sim, World* world,
+                                           int x, int y, void* userdata) {
+    (void)sim;
+    (void)userdata;
+    world_remove_flag(world, x, y, FLAG_UPDATED);
+    return true;
+}
+
 static inline void grid_iterate_multipass(Simulation* sim, World* world,
                                            IterDirection dir, IterHorizontal horiz,
                                            int passes, bool clear_flags_between,
@@ -112,27 +143,11 @@ static inline void grid_iterate_multipass(Simulation* sim, World* world,
             bool scan_left = (horiz == ITER_LEFT_RIGHT) ||
                              (horiz == ITER_RANDOM && (simulation_rand(sim) & 1));
 
-            int y_start = (dir == ITER_TOP_DOWN) ? 0 : GRID_HEIGHT - 1;
-            int y_end = (dir == ITER_TOP_DOWN) ? GRID_HEIGHT : -1;
-            int y_step = (dir == ITER_TOP_DOWN) ? 1 : -1;
-
-            for (int y = y_start; y != y_end; y += y_step) {
-                int chunk_y = y / CHUNK_SIZE;
-                if (scan_left) {
-                    for (int x = 0; x < GRID_WIDTH; x++) {
-                        int chunk_x = x / CHUNK_SIZE;
-                        if (world_is_chunk_active(world, chunk_x, chunk_y)) {
-                            world_remove_flag(world, x, y, FLAG_UPDATED);
-                        }
-                    }
-                } else {
-                    for (int x = GRID_WIDTH - 1; x >= 0; x--) {
-                        int chunk_x = x / CHUNK_SIZE;
-                        if (world_is_chunk_active(world, chunk_x, chunk_y)) {
-                            world_remove_flag(world, x, y, FLAG_UPDATED);
-                        }
-                    }
-                }
+            if (dir == ITER_TOP_DOWN) {
+                grid_sweep(sim, world, 0, GRID_HEIGHT, 1, scan_left, _clear_updated_callback, NULL);
+            } else {
+                grid_sweep(sim, world, GRID_HEIGHT - 1, -1, -1, scan_left,
+                           _clear_updated_callback, NULL);
             }
         }
 
@@ -155,14 +170,14 @@ typedef void (*ChunkUpdateFunc)(Simulation* sim, World* world,
 
 static inline void grid_iterate_chunks(Simulation* sim, World* world,
                                         ChunkUpdateFunc func, void* userdata) {
-    for (int cy = 0; cy < CHUNKS_Y; cy++) {
-        for (int cx = 0; cx < CHUNKS_X; cx++) {
+    for (int cy = 0; cy < world->chunks_y; cy++) {
+        for (int cx = 0; cx < world->chunks_x; cx++) {
             if (!world_is_chunk_active(world, cx, cy)) continue;
 
-            int x_start = cx * CHUNK_SIZE;
-            int y_start = cy * CHUNK_SIZE;
-            int x_end = MIN(x_start + CHUNK_SIZE, GRID_WIDTH);
-            int y_end = MIN(y_start + CHUNK_SIZE, GRID_HEIGHT);
+            int x_start = cx * world->chunk_size;
+            int y_start = cy * world->chunk_size;
+            int x_end = MIN(x_start + world->chunk_size, GRID_WIDTH);
+            int y_end = MIN(y_start + world->chunk_size, GRID_HEIGHT);
 
             func(sim, world, cx, cy, x_start, y_start, x_end, y_end, userdata);
         }
@@ -0,0 +1,42 @@
+/*
+ * grid_parallel.h - Tiled Parallel Grid Sweeps
+ *
+ * Runs a grid_iter.h style cell callback across the worker pool, for the
+ * tiled update mode. Chunk rows
+ * are swept one after another in the given vertical order, like the serial
+ * sweep. Each chunk row is cut into sheared tiles that narrow by one column
+ * per row; the narrowing tiles run concurrently, then the tiles filling the
+ * gaps between them. Every tile keeps 8 columns (GRID_TILE_MARGIN) between
+ * itself and any concurrent tile, and reads and writes cells there
+ * directly. Shared state (chunk activations, counters) goes through the
+ * per-thread scratch (deferred.h) and is merged after each phase.
+ *
+ * Every tile draws from its own random stream, so the result does not
+ * depend on the number of workers; one worker runs the same tiles in turn.
+ * Rows are not scanned in one pass, so results differ from grid_iterate.
+ * Callbacks must stay within 3 columns and 3 rows of the visited cell; they
+ * may read whole columns inside that range.
+ */
+#ifndef GRID_PARALLEL_H
+#define GRID_PARALLEL_H
+
+#include "core/types.h"
+#include "world/world.h"
+#include "world/grid_iter.h"
+#include "engine/simulation.h"
+
+/* Sweep active chunks in parallel tiles, chunk row by chunk row */
+void grid_iterate_parallel(Simulation* sim, World* world, IterDirection dir,
+                           CellUpdateFunc func, void* userdata);
+
+static inline void grid_iterate_falling_parallel(Simulation* sim, World* world,
+                                                  CellUpdateFunc func, void* userdata) {
+    grid_iterate_parallel(sim, world, ITER_BOTTOM_UP, func, userdata);
+}
+
+static inline void grid_iterate_rising_parallel(Simulation* sim, World* world,
+                                                 CellUpdateFunc func, void* userdata) {
+    grid_iterate_parallel(sim, world, ITER_TOP_DOWN, func, userdata);
+}
+
+#endif /* GRID_PARALLEL_H */
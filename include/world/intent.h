@@ -0,0 +1,26 @@
+/*
+ * intent.h - Intent/Resolve Double-Buffered Movement
+ *
+ * Two-phase alternative to the in-place sweeps in grid_iter.h:
+ *   1. Intent:  every movable cell picks one target neighbor and a hashed
+ *               priority, reading only the current material buffer.
+ *   2. Resolve: every target picks the highest-priority claimant and writes
+ *               the swapped materials into mat_next.
+ * The buffers are then swapped and per-cell payload (color seed, velocity,
+ * lifetime) follows the granted swaps. Every phase writes disjoint cells, so
+ * all three run across the worker pool and the outcome does not depend on
+ * scan order or thread count.
+ */
+#ifndef INTENT_H
+#define INTENT_H
+
+#include "core/types.h"
+#include "world/world.h"
+#include "engine/simulation.h"
+
+/* Run one intent/resolve step for cells of the given state (fire excluded).
+ * Like the fluid sweep, passes after the first ignore FLAG_UPDATED so cells
+ * can keep moving within one tick. */
+void intent_update(Simulation* sim, World* world, MaterialState state, int pass);
+
+#endif /* INTENT_H */
@@ -0,0 +1,41 @@
+/*
+ * margolus.h - Margolus Block Cellular Automaton Update
+ *
+ * Alternative movement rule to the in-place scan-order sweeps in grid_iter.h.
+ * The grid is partitioned into 2x2 blocks whose origin alternates between
+ * (0,0) and (1,1) every tick. Each block transition only reads and writes its
+ * own four cells and draws randomness from a per-block hash, so the result
+ * does not depend on processing order and block rows can be updated in any
+ * order (or concurrently).
+ */
+#ifndef MARGOLUS_H
+#define MARGOLUS_H
+
+#include "core/types.h"
+#include "world/world.h"
+#include "engine/simulation.h"
+
+/* =============================================================================
+ * Margolus Update
+ * ============================================================================= */
+
+/* Run one Margolus step over all active chunks for cells of the given state.
+ * Supported states: STATE_POWDER, STATE_FLUID, STATE_GAS (fire excluded).
+ * The block offset alternates with tick_count + pass, so multi-pass callers
+ * see both partitions within a tick. Passes after the first clear
+ * FLAG_UPDATED on the cells they visit, so cells moved by an earlier pass
+ * can move again, as in the multi-pass sweep. */
+void margolus_update(Simulation* sim, World* world, MaterialState state, int pass);
+
+/* Update block rows [block_row_start, block_row_end) with the given block
+ * offset (0 or 1) and per-tick seed, first clearing FLAG_UPDATED in each
+ * visited block when clear_updated is set. Block rows are independent.
+ * Returns the number of swaps; the caller accumulates cells_updated. */
+uint32_t margolus_update_rows(World* world, MaterialState state,
+                              int offset, uint32_t seed, bool clear_updated,
+                              int block_row_start, int block_row_end);
+
+/* Number of block rows for a given offset */
+int margolus_block_rows(const World* world, int offset);
+
+#endif /* MARGOLUS_H */
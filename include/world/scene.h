@@ -0,0 +1,54 @@
+/*
+ * scene.h - Named starting scenes and scene files
+ *
+ * Each scene clears the world, resets it to room temperature, fills it with
+ * a layout scaled to the grid and activates every chunk. Fills are sparse
+ * where noted, using a fixed hash of the cell index, so a scene is the same
+ * on every run.
+ *
+ * A scene file is text, one command per line, applied in order over an
+ * empty world ('#' starts a comment). Coordinates are cells, or a
+ * percentage of the grid width (x, radius) or height (y) such as "50%";
+ * rectangles are [X0, X1) x [Y0, Y1). MAT is a material name (sand, water..).
+ *
+ *   fill MAT                                 every cell
+ *   rect MAT X0 Y0 X1 Y1
+ *   circle MAT CX CY R
+ *   noise MAT X0 Y0 X1 Y1 DENSITY [SCALE [SEED]]
+ *       cells where value noise with features SCALE cells apart (default 1:
+ *       per-cell) is below DENSITY in [0, 1]
+ *   temp T X0 Y0 X1 Y1 [MAT]                 temperature, only MAT cells if given
+ *   color RRGGBB MAT                         map an image colour to a material
+ *   image PATH X Y [SCALE]                   binary PPM (P6) placed at X Y, each
+ *       pixel SCALE x SCALE cells; mapped colours set material, others are
+ *       skipped. PATH is relative to the scene file.
+ */
+#ifndef SCENE_H
+#define SCENE_H
+
+#include "world/world.h"
+
+typedef struct {
+    const char* name;
+    const char* description;
+    void (*build)(World* world);
+} SceneDesc;
+
+/* Number of built-in scenes, and scene i in [0, scene_count()) */
+int scene_count(void);
+const SceneDesc* scene_get(int index);
+
+/* Scene by name, NULL if unknown */
+const SceneDesc* scene_find(const char* name);
+
+/* Build a scene by name; false if unknown (world untouched) */
+bool scene_build(World* world, const char* name);
+
+/* Load a scene file; false with a message on stderr on error, which can
+ * leave the world partly built */
+bool scene_load(World* world, const char* path);
+
+/* Built-in scene name, else a scene file path */
+bool scene_apply(World* world, const char* spec);
+
+#endif /* SCENE_H */
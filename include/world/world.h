@@ -6,6 +6,7 @@
 
 #include "core/types.h"
 #include "materials/material.h"
+#include "engine/workers.h"
 
 /* =============================================================================
  * World State Structure (SoA layout for performance)
@@ -18,11 +19,15 @@ typedef struct {
     /* Double buffer for material (next frame) */
     MaterialID* mat_next;
     
+    /* Material as of the tick start, read by heat diffusion so it can run
+     * while the movers rewrite mat */
+    MaterialID* heat_mat;
+    
     /* Per-cell flags */
     CellFlags* flags;
     
-    /* Color seed per cell (for consistent visual variation) */
-    uint32_t* color_seed;
+    /* Palette variant per cell (for consistent visual variation) */
+    uint8_t* color_variant;
     
     /* Temperature field (for future thermal simulation) */
     float* temp;
@@ -41,20 +46,50 @@ typedef struct {
     /* Particle lifetime (for fire animation, smoke fading) */
     uint8_t* lifetime;
     
+    /* Intent/resolve movement scratch (zero outside an intent step) */
+    uint32_t* intent;         /* (priority << 4) | direction, 0 = stay */
+    uint8_t* intent_grant;    /* Winning neighbor + 1 per target, 0 = none */
+    bool* intent_region;      /* Per chunk: active or next to an active chunk */
+    
+    /* Margolus scheduling scratch: cost per block row (height / 2 entries) */
+    uint32_t* margolus_cost;
+    
     /* Chunk activation tracking */
     bool* chunk_active;
     bool* chunk_active_next;
     
+    /* Per-chunk work estimate: last tick's cost, and this tick's running sum */
+    uint32_t* chunk_cost;
+    uint32_t* chunk_cost_next;
+    
+    /* Per chunk: temperature still changed in the last diffusion pass */
+    bool* chunk_warm;
+    
+    /* Per-chunk change counter, bumped whenever a chunk is activated or
+     * rewritten; caches of derived data (the renderer) compare against it */
+    uint32_t* chunk_version;
+    uint32_t generation;      /* Ticks completed, for per-tick animation */
+    
     /* Grid dimensions (stored for convenience) */
     int width;
     int height;
     
+    /* Chunk geometry (chunk tables hold CHUNK_COUNT_MAX entries) */
+    int chunk_size;           /* Power of two in [CHUNK_SIZE_MIN, CHUNK_SIZE_MAX] */
+    int chunk_shift;          /* log2(chunk_size) */
+    int chunks_x;
+    int chunks_y;
+    int chunk_count;
+    
     /* Statistics */
     uint32_t cells_updated;
     uint32_t active_chunks;
     
 } World;
 
+/* Cost of scanning one active chunk, in units of one cell update */
+#define WORLD_CHUNK_BASE_COST 64
+
 /* =============================================================================
  * World Functions
  * ============================================================================= */
@@ -62,10 +97,23 @@ typedef struct {
 /* Create and initialize a new world */
 World* world_create(int width, int height);
 
+/* Same, with every chunk row initialized (first-touched) by the worker that
+ * owns it, so its pages live on that worker's NUMA node */
+World* world_create_placed(int width, int height, WorkerPool* pool);
+
+/* Change the chunk size (power of two in [CHUNK_SIZE_MIN, CHUNK_SIZE_MAX]);
+ * every chunk becomes active and cost estimates restart. False if invalid. */
+bool world_set_chunk_size(World* world, int chunk_size);
+
+/* Chunk index of a cell */
+static inline int world_chunk_idx(const World* world, int x, int y) {
+    return (y >> world->chunk_shift) * world->chunks_x + (x >> world->chunk_shift);
+}
+
 /* Destroy and free world resources */
 void world_destroy(World* world);
 
-/* Clear the entire world to empty */
+/* Clear the entire world to empty cells at ambient temperature */
 void world_clear(World* world);
 
 /* Get material at position (returns MAT_EMPTY if out of bounds) */
@@ -110,7 +158,7 @@ void world_activate_chunk_at(World* world, int x, int y);
 /* Check if chunk is active */
 bool world_is_chunk_active(const World* world, int chunk_x, int chunk_y);
 
-/* Swap buffers at end of tick */
+/* Swap material buffers (mat <-> mat_next) after a double-buffered step */
 void world_swap_buffers(World* world);
 
 /* Clear per-tick flags (UPDATED, etc.) */
@@ -119,9 +167,17 @@ void world_clear_tick_flags(World* world);
 /* Clear chunk activation for next tick */
 void world_clear_chunk_activation(World* world);
 
-/* Update chunk activation (swap active/next) */
+/* Keep the chunk holding (x, y) active next tick, for cells that change in
+ * place without moving (lifetimes) */
+void world_keep_chunk_awake(World* world, int x, int y);
+
+/* Update chunk activation (swap active/next, publish chunk costs, clear the
+ * new next set so chunks nothing touches this tick go to sleep) */
 void world_update_chunk_activation(World* world);
 
+/* Estimated cost per chunk row from last tick (world->chunks_y entries) */
+void world_chunk_row_costs(const World* world, uint32_t* row_cost);
+
 /* Paint a brush of material (circle) */
 void world_paint_circle(World* world, int cx, int cy, int radius, MaterialID mat);
 
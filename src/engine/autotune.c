@@ -0,0 +1,288 @@
+/*
+ * autotune.c - Startup tuning implementation
+ */
+#include "engine/autotune.h"
+#include "engine/kernels.h"
+#include "world/scene.h"
+#include "core/utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define AUTOTUNE_WARMUP_TICKS  8
+#define AUTOTUNE_MEASURE_TICKS 24
+#define AUTOTUNE_LINE_MAX      512
+
+static const int AUTOTUNE_CHUNK_SIZES[] = { 16, 32, 64 };
+
+/* =============================================================================
+ * Cache File
+ * ============================================================================= */
+
+const char* autotune_cache_path(void) {
+    const char* env = getenv("PIXELSIM_TUNE_FILE");
+    return (env && *env) ? env : AUTOTUNE_DEFAULT_FILE;
+}
+
+/* CPU model name from /proc/cpuinfo, "unknown" elsewhere */
+static void autotune_cpu_model(char* buf, size_t size) {
+    char line[AUTOTUNE_LINE_MAX];
+    snprintf(buf, size, "unknown");
+
+    FILE* file = fopen("/proc/cpuinfo", "r");
+    if (!file) return;
+    while (fgets(line, sizeof(line), file)) {
+        if (strncmp(line, "model name", 10) != 0) continue;
+        const char* value = strchr(line, ':');
+        if (!value) continue;
+        value++;
+        while (*value == ' ' || *value == '\t') value++;
+        snprintf(buf, size, "%s", value);
+        buf[strcspn(buf, "\n")] = '\0';
+        break;
+    }
+    fclose(file);
+}
+
+void autotune_host_key(const Simulation* sim, char* buf, size_t size) {
+    char model[128];
+    autotune_cpu_model(model, sizeof(model));
+
+    /* The key is the first tab-separated field of a cache line */
+    for (char* c = model; *c; c++) {
+        if (*c == '\t') *c = ' ';
+    }
+    snprintf(buf, size, "%s/%d/%dx%d/%s,%s,%s", model, workers_cpu_count(), GRID_WIDTH, GRID_HEIGHT,
+             simulation_update_mode_name(sim->update_mode[STATE_POWDER]),
+             simulation_update_mode_name(sim->update_mode[STATE_FLUID]),
+             simulation_update_mode_name(sim->update_mode[STATE_GAS]));
+}
+
+/* Parse "key\tthreads chunk mode isa tick_us", mode "-" when not tuned;
+ * returns false if malformed */
+static bool autotune_parse_line(const char* line, const char* key, TuneConfig* config) {
+    size_t key_len = strlen(key);
+    if (strncmp(line, key, key_len) != 0 || line[key_len] != '\t') return false;
+
+    char mode_name[32], isa_name[32];
+    TuneConfig parsed;
+    if (sscanf(line + key_len + 1, "%d %d %31s %31s %lf", &parsed.threads,
+               &parsed.chunk_size, mode_name, isa_name, &parsed.tick_us) != 5) {
+        return false;
+    }
+    parsed.mode_tuned = strcmp(mode_name, "-") != 0;
+    parsed.mode = UPDATE_MODE_SWEEP;
+    if (parsed.mode_tuned && !simulation_parse_update_mode(mode_name, &parsed.mode)) return false;
+
+    parsed.isa = KERNEL_ISA_COUNT;
+    for (int i = 0; i < KERNEL_ISA_COUNT; i++) {
+        if (strcmp(isa_name, kernels_isa_name((KernelIsa)i)) == 0) parsed.isa = (KernelIsa)i;
+    }
+    if (parsed.isa == KERNEL_ISA_COUNT) return false;
+
+    *config = parsed;
+    return true;
+}
+
+bool autotune_load(const Simulation* sim, const char* path, TuneConfig* config) {
+    char key[256];
+    char line[AUTOTUNE_LINE_MAX];
+    bool found = false;
+
+    autotune_host_key(sim, key, sizeof(key));
+    FILE* file = fopen(path, "r");
+    if (!file) return false;
+    while (!found && fgets(line, sizeof(line), file)) {
+        found = autotune_parse_line(line, key, config);
+    }
+    fclose(file);
+    return found;
+}
+
+bool autotune_save(const Simulation* sim, const char* path, const TuneConfig* config) {
+    char key[256];
+    char line[AUTOTUNE_LINE_MAX];
+    char* kept = NULL;
+    size_t kept_len = 0;
+
+    autotune_host_key(sim, key, sizeof(key));
+
+    /* Keep the lines of other hosts */
+    FILE* file = fopen(path, "r");
+    if (file) {
+        size_t key_len = strlen(key);
+        while (fgets(line, sizeof(line), file)) {
+            if (strncmp(line, key, key_len) == 0 && line[key_len] == '\t') continue;
+            size_t len = strlen(line);
+            char* grown = realloc(kept, kept_len + len + 1);
+            if (!grown) break;
+            kept = grown;
+            memcpy(kept + kept_len, line, len + 1);
+            kept_len += len;
+        }
+        fclose(file);
+    }
+
+    file = fopen(path, "w");
+    if (!file) {
+        free(kept);
+        return false;
+    }
+    if (kept) fputs(kept, file);
+    fprintf(file, "%s\t%d %d %s %s %.1f\n", key, config->threads, config->chunk_size,
+            config->mode_tuned ? simulation_update_mode_name(config->mode) : "-",
+            kernels_isa_name(config->isa), config->tick_us);
+    free(kept);
+    return fclose(file) == 0;
+}
+
+/* =============================================================================
+ * Measurement
+ * ============================================================================= */
+
+static double autotune_time_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1000000.0 + (double)ts.tv_nsec / 1000.0;
+}
+
+static int double_compare(const void* a, const void* b) {
+    double da = *(const double*)a, db = *(const double*)b;
+    return (da > db) - (da < db);
+}
+
+/* Median tick time of one configuration on a freshly filled scene */
+static double autotune_measure(Simulation* sim, World* world) {
+    double times[AUTOTUNE_MEASURE_TICKS];
+
+    sim->rng_state = 12345;
+    scene_build(world, "mixed");
+    for (int t = 0; t < AUTOTUNE_WARMUP_TICKS; t++) {
+        simulation_tick(sim, world);
+    }
+    for (int t = 0; t < AUTOTUNE_MEASURE_TICKS; t++) {
+        double t0 = autotune_time_us();
+        simulation_tick(sim, world);
+        times[t] = autotune_time_us() - t0;
+    }
+
+    qsort(times, AUTOTUNE_MEASURE_TICKS, sizeof(double), double_compare);
+    return times[AUTOTUNE_MEASURE_TICKS / 2];
+}
+
+/* =============================================================================
+ * Tuning
+ * ============================================================================= */
+
+static void autotune_set_modes(Simulation* sim, UpdateMode mode) {
+    simulation_set_update_mode(sim, STATE_POWDER, mode);
+    simulation_set_update_mode(sim, STATE_FLUID, mode);
+    simulation_set_update_mode(sim, STATE_GAS, mode);
+}
+
+/* PIXELSIM_ISA fixes the kernels, so the ISA is not tuned */
+static bool autotune_isa_fixed(void) {
+    const char* env = getenv("PIXELSIM_ISA");
+    return env && *env;
+}
+
+/* Measure every other supported ISA on the best config and keep the
+ * fastest. Kernel variants give identical results and only change the
+ * per-cell cost, so one pass at the chosen threads and chunk size does. */
+static void autotune_isas(Simulation* sim, TuneConfig* best, bool verbose) {
+    KernelIsa start = best->isa;
+    if (!simulation_set_threads(sim, best->threads)) return;
+    World* world = world_create_placed(GRID_WIDTH, GRID_HEIGHT, sim->workers);
+    if (!world) return;
+    world_set_chunk_size(world, best->chunk_size);
+    if (best->mode_tuned) autotune_set_modes(sim, best->mode);
+
+    for (int i = 0; i <= (int)kernels_detect_isa(); i++) {
+        if (i == (int)start || !kernels_select((KernelIsa)i)) continue;
+        double tick_us = autotune_measure(sim, world);
+        if (verbose) {
+            printf("  tune: isa=%s -> %.0fus\n", kernels_isa_name((KernelIsa)i), tick_us);
+        }
+        if (tick_us < best->tick_us) {
+            best->isa = (KernelIsa)i;
+            best->tick_us = tick_us;
+        }
+    }
+    kernels_select(start);
+    world_destroy(world);
+}
+
+bool autotune_run(Simulation* sim, TuneConfig* best, bool tune_modes, bool verbose) {
+    uint32_t rng_state = sim->rng_state;
+    UpdateMode modes[STATE_COUNT];
+    memcpy(modes, sim->update_mode, sizeof(modes));
+    int cpus = MIN(workers_cpu_count(), WORKERS_MAX);
+    bool found = false;
+
+    /* Thread counts: powers of two below the CPU count, then the CPU count */
+    int thread_counts[WORKERS_MAX];
+    int thread_options = 0;
+    for (int threads = 1; threads < cpus; threads *= 2) {
+        thread_counts[thread_options++] = threads;
+    }
+    thread_counts[thread_options++] = cpus;
+
+    for (int t = 0; t < thread_options; t++) {
+        if (!simulation_set_threads(sim, thread_counts[t])) continue;
+        World* world = world_create_placed(GRID_WIDTH, GRID_HEIGHT, sim->workers);
+        if (!world) continue;
+
+        for (size_t c = 0; c < sizeof(AUTOTUNE_CHUNK_SIZES) / sizeof(AUTOTUNE_CHUNK_SIZES[0]); c++) {
+            if (!world_set_chunk_size(world, AUTOTUNE_CHUNK_SIZES[c])) continue;
+
+            /* Without tune_modes one pass runs with the configured modes */
+            for (int m = 0; m < (tune_modes ? UPDATE_MODE_COUNT : 1); m++) {
+                if (tune_modes) autotune_set_modes(sim, (UpdateMode)m);
+                TuneConfig candidate = {
+                    .threads = workers_count(sim->workers),
+                    .chunk_size = AUTOTUNE_CHUNK_SIZES[c],
+                    .mode_tuned = tune_modes,
+                    .mode = tune_modes ? (UpdateMode)m : UPDATE_MODE_SWEEP,
+                    .isa = kernels.isa,
+                    .tick_us = autotune_measure(sim, world),
+                };
+                if (verbose) {
+                    printf("  tune: threads=%d chunk=%d mode=%s -> %.0fus\n",
+                           candidate.threads, candidate.chunk_size,
+                           tune_modes ? simulation_update_mode_name(candidate.mode)
+                                      : "configured", candidate.tick_us);
+                }
+                if (!found || candidate.tick_us < best->tick_us) {
+                    *best = candidate;
+                    found = true;
+                }
+            }
+        }
+        world_destroy(world);
+    }
+    if (found && !autotune_isa_fixed()) {
+        autotune_isas(sim, best, verbose);
+    }
+
+    /* Leave the simulation as if it had never ticked, with its own modes */
+    memcpy(sim->update_mode, modes, sizeof(modes));
+    simulation_reset(sim);
+    sim->rng_state = rng_state;
+    sim->tick_seed = xorshift32(&sim->rng_state);
+    return found;
+}
+
+bool autotune_apply(Simulation* sim, const TuneConfig* config, bool apply_mode) {
+    if (workers_count(sim->workers) != config->threads &&
+        !simulation_set_threads(sim, config->threads)) {
+        return false;
+    }
+    if (apply_mode && config->mode_tuned) {
+        autotune_set_modes(sim, config->mode);
+    }
+    if (!autotune_isa_fixed() && !kernels_select(config->isa)) {
+        return false;
+    }
+    return true;
+}
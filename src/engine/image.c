@@ -0,0 +1,331 @@
+/*
+ * image.c - PNG and raw frame writers
+ *
+ * The PNG encoder emits one fixed-Huffman deflate block with greedy LZ77
+ * matching (one candidate per 3-byte hash). Frames are mostly runs of a
+ * few palette colors, which this compresses well without a zlib
+ * dependency.
+ */
+#include "engine/image.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#define DEFLATE_WINDOW    32768
+#define DEFLATE_HASH_BITS 15
+#define DEFLATE_MIN_MATCH 3
+#define DEFLATE_MAX_MATCH 258
+
+/* =============================================================================
+ * Byte Buffer and Bit Writer
+ * ============================================================================= */
+
+typedef struct {
+    uint8_t* data;
+    size_t len;
+    size_t cap;
+    bool failed;              /* An allocation failed; contents are incomplete */
+} ByteBuf;
+
+static void buf_put(ByteBuf* buf, const void* data, size_t len) {
+    if (buf->failed) return;
+    if (buf->len + len > buf->cap) {
+        size_t cap = MAX(buf->cap * 2, buf->len + len + 4096);
+        uint8_t* grown = realloc(buf->data, cap);
+        if (!grown) {
+            buf->failed = true;
+            return;
+        }
+        buf->data = grown;
+        buf->cap = cap;
+    }
+    memcpy(buf->data + buf->len, data, len);
+    buf->len += len;
+}
+
+static void buf_byte(ByteBuf* buf, uint8_t value) {
+    buf_put(buf, &value, 1);
+}
+
+static void buf_u32be(ByteBuf* buf, uint32_t value) {
+    uint8_t bytes[4] = { value >> 24, value >> 16, value >> 8, value };
+    buf_put(buf, bytes, 4);
+}
+
+/* Deflate bit stream: values are packed least significant bit first */
+typedef struct {
+    ByteBuf* out;
+    uint64_t bits;
+    int count;
+} BitWriter;
+
+static void bits_put(BitWriter* w, uint32_t value, int n) {
+    w->bits |= (uint64_t)value << w->count;
+    w->count += n;
+    while (w->count >= 8) {
+        buf_byte(w->out, (uint8_t)w->bits);
+        w->bits >>= 8;
+        w->count -= 8;
+    }
+}
+
+/* Huffman codes are stored most significant bit first */
+static void bits_put_code(BitWriter* w, uint32_t code, int n) {
+    uint32_t reversed = 0;
+    for (int i = 0; i < n; i++) {
+        reversed |= ((code >> i) & 1) << (n - 1 - i);
+    }
+    bits_put(w, reversed, n);
+}
+
+static void bits_flush(BitWriter* w) {
+    if (w->count > 0) buf_byte(w->out, (uint8_t)w->bits);
+    w->bits = 0;
+    w->count = 0;
+}
+
+/* =============================================================================
+ * Deflate (RFC 1951, fixed Huffman codes)
+ * ============================================================================= */
+
+static const uint16_t LEN_BASE[29] = {
+    3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+    35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+static const uint8_t LEN_EXTRA[29] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+    3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+static const uint16_t DIST_BASE[30] = {
+    1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+    257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577
+};
+static const uint8_t DIST_EXTRA[30] = {
+    0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+    7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+};
+
+/* Literal/length symbol with the fixed code lengths (8, 9, 7, 8 bits) */
+static void deflate_symbol(BitWriter* w, int sym) {
+    if (sym < 144) {
+        bits_put_code(w, 0x30 + sym, 8);
+    } else if (sym < 256) {
+        bits_put_code(w, 0x190 + (sym - 144), 9);
+    } else if (sym < 280) {
+        bits_put_code(w, sym - 256, 7);
+    } else {
+        bits_put_code(w, 0xC0 + (sym - 280), 8);
+    }
+}
+
+static void deflate_match(BitWriter* w, int length, int distance) {
+    int l = 0;
+    while (l < 28 && LEN_BASE[l + 1] <= length) l++;
+    deflate_symbol(w, 257 + l);
+    if (LEN_EXTRA[l]) bits_put(w, (uint32_t)(length - LEN_BASE[l]), LEN_EXTRA[l]);
+
+    int d = 0;
+    while (d < 29 && DIST_BASE[d + 1] <= distance) d++;
+    bits_put_code(w, (uint32_t)d, 5);
+    if (DIST_EXTRA[d]) bits_put(w, (uint32_t)(distance - DIST_BASE[d]), DIST_EXTRA[d]);
+}
+
+static inline uint32_t deflate_hash(const uint8_t* p) {
+    uint32_t key = ((uint32_t)p[0] << 16) | ((uint32_t)p[1] << 8) | p[2];
+    return (key * 2654435761u) >> (32 - DEFLATE_HASH_BITS);
+}
+
+/* Compress data as a single final fixed-Huffman block */
+static bool deflate_fixed(ByteBuf* out, const uint8_t* data, size_t n) {
+    long* head = malloc(sizeof(long) << DEFLATE_HASH_BITS);
+    if (!head) return false;
+    for (size_t i = 0; i < ((size_t)1 << DEFLATE_HASH_BITS); i++) head[i] = -1;
+
+    BitWriter w = { out, 0, 0 };
+    bits_put(&w, 1, 1);       /* BFINAL */
+    bits_put(&w, 1, 2);       /* BTYPE = fixed Huffman */
+
+    size_t i = 0;
+    while (i < n) {
+        size_t best = 0, distance = 0;
+        if (i + DEFLATE_MIN_MATCH <= n) {
+            uint32_t h = deflate_hash(&data[i]);
+            long candidate = head[h];
+            head[h] = (long)i;
+            if (candidate >= 0 && i - (size_t)candidate <= DEFLATE_WINDOW) {
+                size_t max = MIN((size_t)DEFLATE_MAX_MATCH, n - i);
+                size_t len = 0;
+                while (len < max && data[(size_t)candidate + len] == data[i + len]) len++;
+                if (len >= DEFLATE_MIN_MATCH) {
+                    best = len;
+                    distance = i - (size_t)candidate;
+                }
+            }
+        }
+
+        if (best) {
+            deflate_match(&w, (int)best, (int)distance);
+            for (size_t k = i + 1; k < i + best && k + DEFLATE_MIN_MATCH <= n; k++) {
+                head[deflate_hash(&data[k])] = (long)k;
+            }
+            i += best;
+        } else {
+            deflate_symbol(&w, data[i]);
+            i++;
+        }
+    }
+    deflate_symbol(&w, 256);  /* End of block */
+    bits_flush(&w);
+
+    free(head);
+    return !out->failed;
+}
+
+static uint32_t adler32(const uint8_t* data, size_t n) {
+    uint32_t a = 1, b = 0;
+    while (n > 0) {
+        size_t block = MIN(n, (size_t)5552);
+        for (size_t i = 0; i < block; i++) {
+            a += data[i];
+            b += a;
+        }
+        a %= 65521;
+        b %= 65521;
+        data += block;
+        n -= block;
+    }
+    return (b << 16) | a;
+}
+
+/* =============================================================================
+ * PNG
+ * ============================================================================= */
+
+static void crc32_table(uint32_t* table) {
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t c = i;
+        for (int k = 0; k < 8; k++) {
+            c = (c >> 1) ^ (0xEDB88320u & (0u - (c & 1)));
+        }
+        table[i] = c;
+    }
+}
+
+static uint32_t crc32_update(const uint32_t* table, uint32_t crc, const uint8_t* data, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return crc;
+}
+
+/* Length, type, data and CRC of one chunk */
+static void png_chunk(ByteBuf* file, const uint32_t* table, const char* type,
+                      const uint8_t* data, size_t len) {
+    buf_u32be(file, (uint32_t)len);
+    size_t start = file->len;
+    buf_put(file, type, 4);
+    if (len) buf_put(file, data, len);
+    if (file->failed) return;
+    uint32_t crc = crc32_update(table, 0xFFFFFFFFu, file->data + start, len + 4);
+    buf_u32be(file, crc ^ 0xFFFFFFFFu);
+}
+
+/* Encode an ARGB frame as an RGB PNG, alpha composited over black */
+static bool png_encode(ByteBuf* file, const uint32_t* argb, int width, int height, int pitch) {
+    static const uint8_t SIGNATURE[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    size_t row_bytes = 1 + (size_t)width * 3;
+    uint8_t* raw = malloc(row_bytes * height);
+    if (!raw) return false;
+
+    /* Scanlines with filter type 0 (none) */
+    for (int y = 0; y < height; y++) {
+        uint8_t* out = &raw[y * row_bytes];
+        const uint32_t* row = &argb[(size_t)y * pitch];
+        *out++ = 0;
+        for (int x = 0; x < width; x++) {
+            uint32_t p = row[x], a = p >> 24;
+            *out++ = (uint8_t)((((p >> 16) & 0xFF) * a + 127) / 255);
+            *out++ = (uint8_t)((((p >> 8) & 0xFF) * a + 127) / 255);
+            *out++ = (uint8_t)(((p & 0xFF) * a + 127) / 255);
+        }
+    }
+
+    /* zlib stream: header, deflate data, Adler-32 */
+    ByteBuf z = {0};
+    buf_byte(&z, 0x78);
+    buf_byte(&z, 0x01);
+    bool ok = deflate_fixed(&z, raw, row_bytes * height);
+    buf_u32be(&z, adler32(raw, row_bytes * height));
+    free(raw);
+    ok = ok && !z.failed;
+
+    uint32_t table[256];
+    uint8_t ihdr[13] = {
+        width >> 24, width >> 16, width >> 8, width,
+        height >> 24, height >> 16, height >> 8, height,
+        8, 2, 0, 0, 0         /* 8-bit RGB, deflate, adaptive filters, no interlace */
+    };
+    crc32_table(table);
+    buf_put(file, SIGNATURE, sizeof(SIGNATURE));
+    png_chunk(file, table, "IHDR", ihdr, sizeof(ihdr));
+    if (ok) png_chunk(file, table, "IDAT", z.data, z.len);
+    png_chunk(file, table, "IEND", NULL, 0);
+    free(z.data);
+    return ok && !file->failed;
+}
+
+/* =============================================================================
+ * Public API
+ * ============================================================================= */
+
+bool image_format_from_path(const char* path, ImageFormat* format) {
+    const char* ext = strrchr(path, '.');
+    if (!ext) return false;
+    if (strcasecmp(ext, ".png") == 0) {
+        *format = IMAGE_PNG;
+        return true;
+    }
+    if (strcasecmp(ext, ".raw") == 0) {
+        *format = IMAGE_RAW;
+        return true;
+    }
+    return false;
+}
+
+bool image_write(const char* path, ImageFormat format, const uint32_t* argb,
+                 int width, int height, int pitch) {
+    FILE* file = fopen(path, "wb");
+    if (!file) return false;
+
+    bool ok = true;
+    if (format == IMAGE_PNG) {
+        ByteBuf png = {0};
+        ok = png_encode(&png, argb, width, height, pitch) &&
+             fwrite(png.data, 1, png.len, file) == png.len;
+        free(png.data);
+    } else {
+        for (int y = 0; y < height && ok; y++) {
+            ok = fwrite(&argb[(size_t)y * pitch], sizeof(uint32_t), (size_t)width, file) ==
+                 (size_t)width;
+        }
+    }
+    return (fclose(file) == 0) && ok;
+}
+
+bool image_sequence_path(char* buf, size_t size, const char* pattern, int index) {
+    /* Exactly one %d / %0Nd conversion; %% is allowed elsewhere */
+    int conversions = 0;
+    for (const char* p = pattern; *p; p++) {
+        if (*p != '%') continue;
+        p++;
+        if (*p == '%') continue;
+        while (*p >= '0' && *p <= '9') p++;
+        if (*p != 'd') return false;
+        conversions++;
+    }
+    if (conversions != 1) return false;
+
+    int len = snprintf(buf, size, pattern, index);
+    return len >= 0 && (size_t)len < size;
+}
@@ -6,6 +6,9 @@
 #include <stdlib.h>
 #include <stdio.h>
 
+/* Window pixels panned per arrow key press */
+#define INPUT_PAN_STEP 64
+
 /* =============================================================================
  * Input Lifecycle
  * ============================================================================= */
@@ -50,6 +53,10 @@ void input_update(Input* input) {
     input->key_1 = input->key_2 = input->key_3 = input->key_4 = input->key_5 = false;
     input->key_6 = input->key_7 = input->key_8 = input->key_9 = input->key_0 = false;
     input->key_minus = input->key_equals = false;
+    input->window_exposed = false;
+    input->pan_x = input->pan_y = 0;
+    input->zoom_steps = 0;
+    input->key_home = false;
     
     /* Store previous mouse position */
     input->prev_mouse_x = input->mouse_x;
@@ -63,9 +70,22 @@ void input_update(Input* input) {
                 input->quit_requested = true;
                 break;
                 
+            case SDL_WINDOWEVENT:
+                if (event.window.event == SDL_WINDOWEVENT_EXPOSED ||
+                    event.window.event == SDL_WINDOWEVENT_SIZE_CHANGED ||
+                    event.window.event == SDL_WINDOWEVENT_RESTORED) {
+                    input->window_exposed = true;
+                }
+                break;
+                
             case SDL_MOUSEMOTION:
                 input->mouse_x = event.motion.x;
                 input->mouse_y = event.motion.y;
+                if (input->mouse_middle) {
+                    /* Drag the world along with the pointer */
+                    input->pan_x -= event.motion.xrel;
+                    input->pan_y -= event.motion.yrel;
+                }
                 break;
                 
             case SDL_MOUSEBUTTONDOWN:
@@ -98,8 +118,10 @@ void input_update(Input* input) {
                 break;
                 
             case SDL_MOUSEWHEEL:
-                /* Mouse wheel changes brush size */
-                if (event.wheel.y > 0) {
+                /* Ctrl + wheel zooms, the wheel alone changes brush size */
+                if (SDL_GetModState() & KMOD_CTRL) {
+                    input->zoom_steps += (event.wheel.y > 0) - (event.wheel.y < 0);
+                } else if (event.wheel.y > 0) {
                     input_increase_brush(input);
                 } else if (event.wheel.y < 0) {
                     input_decrease_brush(input);
@@ -130,6 +152,13 @@ void input_update(Input* input) {
                     case SDLK_MINUS: input->key_minus = true; break;
                     case SDLK_EQUALS: input->key_equals = true; break;
                     
+                    /* Camera */
+                    case SDLK_LEFT:  input->pan_x -= INPUT_PAN_STEP; break;
+                    case SDLK_RIGHT: input->pan_x += INPUT_PAN_STEP; break;
+                    case SDLK_UP:    input->pan_y -= INPUT_PAN_STEP; break;
+                    case SDLK_DOWN:  input->pan_y += INPUT_PAN_STEP; break;
+                    case SDLK_HOME:  input->key_home = true; break;
+                    
                     /* Bracket keys for brush size */
                     case SDLK_LEFTBRACKET:  input_decrease_brush(input); break;
                     case SDLK_RIGHTBRACKET: input_increase_brush(input); break;
@@ -148,7 +177,18 @@ void input_update(Input* input) {
  * Input Application
  * ============================================================================= */
 
-void input_apply(Input* input, World* world, Simulation* sim, Renderer* renderer) {
+/* Queue a brush stroke from the previous to the current pointer position,
+ * in the world cells under the pointer */
+static void input_paint(const Input* input, SimThread* sim, const Renderer* renderer,
+                        MaterialID mat) {
+    SimCommand paint = { .type = SIM_CMD_PAINT, .radius = input->brush_size, .mat = mat };
+    render_screen_to_world(renderer, input->prev_mouse_x, input->prev_mouse_y,
+                           &paint.x0, &paint.y0);
+    render_screen_to_world(renderer, input->mouse_x, input->mouse_y, &paint.x1, &paint.y1);
+    sim_thread_send(sim, &paint);
+}
+
+void input_apply(Input* input, SimThread* sim, Renderer* renderer) {
     /* Handle quit request */
     if (input->key_escape) {
         input->quit_requested = true;
@@ -156,17 +196,33 @@ void input_apply(Input* input, World* world, Simulation* sim, Renderer* renderer
     
     /* Handle pause toggle */
     if (input->key_space) {
-        simulation_toggle_pause(sim);
+        sim_thread_send(sim, &(SimCommand){ .type = SIM_CMD_TOGGLE_PAUSE });
     }
     
     /* Handle single step */
     if (input->key_period) {
-        simulation_step_once(sim);
+        sim_thread_send(sim, &(SimCommand){ .type = SIM_CMD_STEP });
     }
     
     /* Handle clear */
     if (input->key_c) {
-        world_clear(world);
+        sim_thread_send(sim, &(SimCommand){ .type = SIM_CMD_CLEAR });
+    }
+    
+    /* Redraw after the window was covered or resized */
+    if (input->window_exposed) {
+        render_invalidate(renderer);
+    }
+    
+    /* Camera */
+    if (input->key_home) {
+        render_reset_view(renderer);
+    }
+    if (input->pan_x || input->pan_y) {
+        render_pan(renderer, input->pan_x, input->pan_y);
+    }
+    if (input->zoom_steps) {
+        render_zoom(renderer, input->zoom_steps, input->mouse_x, input->mouse_y);
     }
     
     /* Handle overlay toggle */
@@ -201,24 +257,12 @@ void input_apply(Input* input, World* world, Simulation* sim, Renderer* renderer
     /* Handle painting */
     if (input->mouse_left) {
         /* Paint current material */
-        world_paint_line(
-            world,
-            input->prev_mouse_x, input->prev_mouse_y,
-            input->mouse_x, input->mouse_y,
-            input->brush_size,
-            input->current_material
-        );
+        input_paint(input, sim, renderer, input->current_material);
     }
     
     if (input->mouse_right) {
         /* Erase (paint empty) */
-        world_paint_line(
-            world,
-            input->prev_mouse_x, input->prev_mouse_y,
-            input->mouse_x, input->mouse_y,
-            input->brush_size,
-            MAT_EMPTY
-        );
+        input_paint(input, sim, renderer, MAT_EMPTY);
     }
 }
 
@@ -0,0 +1,318 @@
+/*
+ * kernels.c - Hot loop kernels with runtime CPU dispatch
+ *
+ * Kernel bodies are written once as always-inline C and instantiated in
+ * functions carrying a target attribute, so the compiler vectorizes each
+ * copy for its instruction set. Row classification additionally has
+ * hand-written byte shuffles. This file is built with KERNEL_CFLAGS (see
+ * Makefile): no FMA contraction, so float results match the scalar path
+ * exactly, and no errno/trap side effects, so selects can be vectorized.
+ */
+#include "engine/kernels.h"
+#include "physics/thermal.h"
+#include "materials/material.h"
+#include "core/utils.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define KERNELS_X86 1
+#include <immintrin.h>
+#endif
+
+_Static_assert(MAT_COUNT <= KERNEL_LUT_SIZE, "material classification tables hold 16 entries");
+
+#define KERNEL_INLINE static inline __attribute__((always_inline))
+
+/* =============================================================================
+ * Kernel Bodies
+ * ============================================================================= */
+
+KERNEL_INLINE uint64_t row_classify_body(const MaterialID* mat, int n, const uint8_t* lut) {
+    uint64_t bits = 0;
+    for (int i = 0; i < n; i++) {
+        bits |= (uint64_t)(lut[mat[i]] != 0) << i;
+    }
+    return bits;
+}
+
+/* Cells per thermal block; per-material values are unpacked into flat
+ * arrays first so the arithmetic loop has no table lookups */
+#define THERMAL_BLOCK 64
+
+/* Same arithmetic, in the same order, as thermal_diffuse_cell() */
+KERNEL_INLINE void thermal_block_body(const ThermalRow* row, int x0, int n) {
+    const MaterialID* mat = row->mat + x0;
+    const float* temp = row->temp + x0;
+    const float* cond = row->conductivity;
+    int s = row->stride;
+
+    float c_mid[THERMAL_BLOCK + 2], c_up[THERMAL_BLOCK], c_down[THERMAL_BLOCK];
+    float mass[THERMAL_BLOCK];
+    int32_t kind[THERMAL_BLOCK];    /* 0 = conducting, 1 = empty, 2 = fire */
+
+    for (int i = -1; i <= n; i++) {
+        c_mid[i + 1] = cond[mat[i]];
+    }
+    for (int i = 0; i < n; i++) {
+        c_up[i] = cond[mat[i - s]];
+        c_down[i] = cond[mat[i + s]];
+        mass[i] = row->thermal_mass[mat[i]];
+        kind[i] = (mat[i] == MAT_FIRE) ? 2 : (mat[i] == MAT_EMPTY) ? 1 : 0;
+    }
+
+    for (int i = 0; i < n; i++) {
+        float t = temp[i];
+        float c = c_mid[i + 1];
+
+        /* Neighbors in NEIGHBOR4 order: left, right, up, down.
+         * sqrtf(MAX(p, 0)) equals (p > 0 ? sqrtf(p) : 0) without a branch */
+        float heat = 0.0f;
+        heat += (temp[i - 1] - t) * sqrtf(MAX(c * c_mid[i], 0.0f));
+        heat += (temp[i + 1] - t) * sqrtf(MAX(c * c_mid[i + 2], 0.0f));
+        heat += (temp[i - s] - t) * sqrtf(MAX(c * c_up[i], 0.0f));
+        heat += (temp[i + s] - t) * sqrtf(MAX(c * c_down[i], 0.0f));
+
+        float delta = heat * HEAT_DIFFUSION_RATE / 4;
+        float next = t + delta / mass[i];
+        next += (AMBIENT_TEMP - next) * AMBIENT_COOLING_RATE;
+        next = CLAMP(next, MIN_TEMPERATURE, MAX_TEMPERATURE);
+
+        float result = (c <= 0.001f) ? t : next;
+        result = (kind[i] == 1) ? t + (AMBIENT_TEMP - t) * 0.1f : result;
+        result = (kind[i] == 2) ? FIRE_TEMPERATURE : result;
+        row->out[x0 + i] = result;
+    }
+}
+
+KERNEL_INLINE void thermal_row_body(const ThermalRow* row, int x0, int x1) {
+    for (int x = x0; x < x1; x += THERMAL_BLOCK) {
+        thermal_block_body(row, x, MIN(THERMAL_BLOCK, x1 - x));
+    }
+}
+
+KERNEL_INLINE void fill_u32_body(uint32_t* dst, size_t n, uint32_t value) {
+    for (size_t i = 0; i < n; i++) {
+        dst[i] = value;
+    }
+}
+
+KERNEL_INLINE void glow_blur_body(uint16_t* restrict dst, const uint16_t* restrict src,
+                                  int n, int step) {
+    for (int i = 0; i < n; i++) {
+        const uint16_t* s = src + i;
+        dst[i] = (uint16_t)(4 * s[0] + 3 * (s[-step] + s[step]) + 2 * (s[-2 * step] + s[2 * step]) +
+                            (s[-3 * step] + s[3 * step]));
+    }
+}
+
+/* Saturating per-channel adds, written as MIN so each ISA gets packed ops */
+KERNEL_INLINE void glow_add_body(uint32_t* restrict dst, const uint32_t* restrict src,
+                                 const uint16_t* restrict glow,
+                                 const MaterialID* restrict mat, int n) {
+    for (int i = 0; i < n; i++) {
+        uint32_t v = MIN((uint32_t)glow[i] >> 4, 255u);
+        v = (mat[i] == MAT_FIRE) ? 0 : v;
+        
+        uint32_t p = src[i];
+        uint32_t r = MIN(((p >> 16) & 0xFF) + v, 255u);
+        uint32_t g = MIN(((p >> 8) & 0xFF) + (v >> 1), 255u);
+        uint32_t a = v ? 0xFF000000u : (p & 0xFF000000u);
+        dst[i] = a | (r << 16) | (g << 8) | (p & 0xFF);
+    }
+}
+
+/* A gather on AVX2 and AVX-512; restrict rules out dst aliasing the table */
+KERNEL_INLINE void palette_row_body(uint32_t* restrict dst, const MaterialID* restrict mat,
+                                    const uint8_t* restrict variant, int n,
+                                    const uint32_t* restrict palette) {
+    for (int i = 0; i < n; i++) {
+        dst[i] = palette[((uint32_t)mat[i] << MATERIAL_PALETTE_SHIFT) | variant[i]];
+    }
+}
+
+/* Per-byte floor((a + b) / 2) is (a & b) + ((a ^ b) >> 1) with the bits
+ * shifted across bytes masked off */
+KERNEL_INLINE void heat_blend_body(uint32_t* restrict dst, const float* restrict temp, int n,
+                                   const uint32_t* restrict lut) {
+    const float scale = (KERNEL_HEAT_LUT_SIZE - 1) / (MAX_TEMPERATURE - MIN_TEMPERATURE);
+    for (int i = 0; i < n; i++) {
+        float t = CLAMP(temp[i], MIN_TEMPERATURE, MAX_TEMPERATURE);
+        uint32_t heat = lut[(int32_t)((t - MIN_TEMPERATURE) * scale)];
+        uint32_t p = dst[i];
+        dst[i] = 0xFF000000u | ((p & heat) + (((p ^ heat) & 0xFEFEFEFEu) >> 1));
+    }
+}
+
+KERNEL_INLINE void rng_fill_body(uint32_t* dst, int n, uint32_t seed, uint32_t first) {
+    for (int i = 0; i < n; i++) {
+        dst[i] = hash32(seed ^ ((first + (uint32_t)i) * 0x9E3779B1u));
+    }
+}
+
+/* =============================================================================
+ * Variants
+ * ============================================================================= */
+
+/* Auto-vectorized kernels; row classification has its own SIMD versions */
+#define KERNEL_VARIANTS(SUFFIX, ATTR)                                                   \
+    ATTR static void thermal_row_##SUFFIX(const ThermalRow* row, int x0, int x1) {     \
+        thermal_row_body(row, x0, x1);                                                  \
+    }                                                                                   \
+    ATTR static void fill_u32_##SUFFIX(uint32_t* dst, size_t n, uint32_t value) {      \
+        fill_u32_body(dst, n, value);                                                   \
+    }                                                                                   \
+    ATTR static void rng_fill_##SUFFIX(uint32_t* dst, int n, uint32_t seed,            \
+                                       uint32_t first) {                                \
+        rng_fill_body(dst, n, seed, first);                                             \
+    }                                                                                   \
+    ATTR static void glow_blur_##SUFFIX(uint16_t* dst, const uint16_t* src, int n,     \
+                                        int step) {                                     \
+        glow_blur_body(dst, src, n, step);                                              \
+    }                                                                                   \
+    ATTR static void glow_add_##SUFFIX(uint32_t* dst, const uint32_t* src,             \
+                                       const uint16_t* glow, const MaterialID* mat,     \
+                                       int n) {                                         \
+        glow_add_body(dst, src, glow, mat, n);                                          \
+    }                                                                                   \
+    ATTR static void palette_row_##SUFFIX(uint32_t* dst, const MaterialID* mat,         \
+                                          const uint8_t* variant, int n,                \
+                                          const uint32_t* palette) {                    \
+        palette_row_body(dst, mat, variant, n, palette);                                \
+    }                                                                                   \
+    ATTR static void heat_blend_##SUFFIX(uint32_t* dst, const float* temp, int n,      \
+                                         const uint32_t* lut) {                         \
+        heat_blend_body(dst, temp, n, lut);                                             \
+    }
+
+KERNEL_VARIANTS(scalar, )
+
+static uint64_t row_classify_scalar(const MaterialID* mat, int n, const uint8_t* lut) {
+    return row_classify_body(mat, n, lut);
+}
+
+#ifdef KERNELS_X86
+KERNEL_VARIANTS(sse2, __attribute__((target("sse2"))))
+KERNEL_VARIANTS(avx2, __attribute__((target("avx2"))))
+KERNEL_VARIANTS(avx512, __attribute__((target("avx512f,avx512bw"))))
+
+/* 16 cells per step: OR of one compare per material in the table */
+__attribute__((target("sse2")))
+static uint64_t row_classify_sse2(const MaterialID* mat, int n, const uint8_t* lut) {
+    uint64_t bits = 0;
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(mat + i));
+        __m128i hit = _mm_setzero_si128();
+        for (int m = 0; m < MAT_COUNT; m++) {
+            if (lut[m]) hit = _mm_or_si128(hit, _mm_cmpeq_epi8(v, _mm_set1_epi8((char)m)));
+        }
+        bits |= (uint64_t)(uint32_t)_mm_movemask_epi8(hit) << i;
+    }
+    return (i < n) ? bits | (row_classify_body(mat + i, n - i, lut) << i) : bits;
+}
+
+/* 32 cells per step: the table is a byte shuffle */
+__attribute__((target("avx2")))
+static uint64_t row_classify_avx2(const MaterialID* mat, int n, const uint8_t* lut) {
+    __m256i table = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)lut));
+    __m256i zero = _mm256_setzero_si256();
+    uint64_t bits = 0;
+    int i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(mat + i));
+        __m256i class = _mm256_shuffle_epi8(table, v);
+        uint32_t empty = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(class, zero));
+        bits |= (uint64_t)~empty << i;
+    }
+    return (i < n) ? bits | (row_classify_body(mat + i, n - i, lut) << i) : bits;
+}
+
+/* Whole row in one masked step */
+__attribute__((target("avx512f,avx512bw")))
+static uint64_t row_classify_avx512(const MaterialID* mat, int n, const uint8_t* lut) {
+    __m512i table = _mm512_broadcast_i32x4(_mm_loadu_si128((const __m128i*)lut));
+    __mmask64 live = (n >= 64) ? ~(__mmask64)0 : (((__mmask64)1 << n) - 1);
+    __m512i v = _mm512_maskz_loadu_epi8(live, mat);
+    __m512i class = _mm512_shuffle_epi8(table, v);
+    return _mm512_mask_test_epi8_mask(live, class, class);
+}
+#endif
+
+/* =============================================================================
+ * Dispatch
+ * ============================================================================= */
+
+static const KernelTable KERNEL_TABLES[KERNEL_ISA_COUNT] = {
+    [KERNEL_ISA_SCALAR] = { KERNEL_ISA_SCALAR, row_classify_scalar, thermal_row_scalar,
+                            fill_u32_scalar, glow_blur_scalar, glow_add_scalar,
+                            palette_row_scalar, rng_fill_scalar, heat_blend_scalar },
+#ifdef KERNELS_X86
+    [KERNEL_ISA_SSE2]   = { KERNEL_ISA_SSE2, row_classify_sse2, thermal_row_sse2,
+                            fill_u32_sse2, glow_blur_sse2, glow_add_sse2,
+                            palette_row_sse2, rng_fill_sse2, heat_blend_sse2 },
+    [KERNEL_ISA_AVX2]   = { KERNEL_ISA_AVX2, row_classify_avx2, thermal_row_avx2,
+                            fill_u32_avx2, glow_blur_avx2, glow_add_avx2,
+                            palette_row_avx2, rng_fill_avx2, heat_blend_avx2 },
+    [KERNEL_ISA_AVX512] = { KERNEL_ISA_AVX512, row_classify_avx512, thermal_row_avx512,
+                            fill_u32_avx512, glow_blur_avx512, glow_add_avx512,
+                            palette_row_avx512, rng_fill_avx512, heat_blend_avx512 },
+#endif
+};
+
+static const char* const KERNEL_ISA_NAMES[KERNEL_ISA_COUNT] = {
+    [KERNEL_ISA_SCALAR] = "scalar",
+    [KERNEL_ISA_SSE2] = "sse2",
+    [KERNEL_ISA_AVX2] = "avx2",
+    [KERNEL_ISA_AVX512] = "avx512",
+};
+
+KernelTable kernels = {
+    KERNEL_ISA_SCALAR, row_classify_scalar, thermal_row_scalar, fill_u32_scalar,
+    glow_blur_scalar, glow_add_scalar, palette_row_scalar, rng_fill_scalar, heat_blend_scalar
+};
+
+const char* kernels_isa_name(KernelIsa isa) {
+    return (isa < KERNEL_ISA_COUNT) ? KERNEL_ISA_NAMES[isa] : "unknown";
+}
+
+KernelIsa kernels_detect_isa(void) {
+#ifdef KERNELS_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")) {
+        return KERNEL_ISA_AVX512;
+    }
+    if (__builtin_cpu_supports("avx2")) return KERNEL_ISA_AVX2;
+    if (__builtin_cpu_supports("sse2")) return KERNEL_ISA_SSE2;
+#endif
+    return KERNEL_ISA_SCALAR;
+}
+
+bool kernels_select(KernelIsa isa) {
+    if (isa >= KERNEL_ISA_COUNT || isa > kernels_detect_isa()) return false;
+    if (!KERNEL_TABLES[isa].row_classify) return false;
+    kernels = KERNEL_TABLES[isa];
+    return true;
+}
+
+void kernels_init(void) {
+    KernelIsa isa = kernels_detect_isa();
+
+    const char* env = getenv("PIXELSIM_ISA");
+    if (env && *env) {
+        KernelIsa wanted = KERNEL_ISA_COUNT;
+        for (int i = 0; i < KERNEL_ISA_COUNT; i++) {
+            if (strcmp(env, KERNEL_ISA_NAMES[i]) == 0) wanted = (KernelIsa)i;
+        }
+        if (wanted == KERNEL_ISA_COUNT || wanted > isa) {
+            fprintf(stderr, "PIXELSIM_ISA=%s not available, using %s\n",
+                    env, kernels_isa_name(isa));
+        } else {
+            isa = wanted;
+        }
+    }
+
+    kernels_select(isa);
+}
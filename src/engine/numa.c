@@ -0,0 +1,107 @@
+/*
+ * numa.c - CPU and NUMA node topology implementation
+ */
+#define _GNU_SOURCE
+#include "engine/numa.h"
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define NUMA_CPU_WORDS (NUMA_MAX_CPUS / 64)
+
+static inline bool cpu_bit(const uint64_t* bits, int cpu) {
+    return (bits[cpu >> 6] >> (cpu & 63)) & 1;
+}
+
+int numa_parse_cpulist(const char* list, uint64_t* bits) {
+    int count = 0;
+    memset(bits, 0, NUMA_CPU_WORDS * sizeof(uint64_t));
+
+    const char* p = list;
+    while (*p) {
+        char* end;
+        long first = strtol(p, &end, 10);
+        if (end == p) break;
+        long last = first;
+        p = end;
+        if (*p == '-') {
+            last = strtol(p + 1, &end, 10);
+            p = end;
+        }
+        for (long cpu = first; cpu <= last && cpu < NUMA_MAX_CPUS; cpu++) {
+            if (cpu < 0 || cpu_bit(bits, (int)cpu)) continue;
+            bits[cpu >> 6] |= (uint64_t)1 << (cpu & 63);
+            count++;
+        }
+        if (*p != ',') break;
+        p++;
+    }
+    return count;
+}
+
+/* CPUs in the process affinity mask (taskset, cgroup cpusets) */
+static void numa_allowed_cpus(uint64_t* bits) {
+    cpu_set_t set;
+    memset(bits, 0, NUMA_CPU_WORDS * sizeof(uint64_t));
+
+    if (sched_getaffinity(0, sizeof(set), &set) != 0) {
+        bits[0] = 1;    /* Unknown: assume CPU 0 only */
+        return;
+    }
+    for (int cpu = 0; cpu < NUMA_MAX_CPUS && cpu < CPU_SETSIZE; cpu++) {
+        if (CPU_ISSET(cpu, &set)) bits[cpu >> 6] |= (uint64_t)1 << (cpu & 63);
+    }
+}
+
+/* Append the allowed CPUs of one node; false if none were usable */
+static bool numa_add_node(NumaTopology* topo, int node, const uint64_t* node_bits,
+                          const uint64_t* allowed) {
+    if (topo->node_count >= NUMA_MAX_NODES) return false;
+
+    int first = topo->cpu_count;
+    for (int cpu = 0; cpu < NUMA_MAX_CPUS; cpu++) {
+        if (cpu_bit(node_bits, cpu) && cpu_bit(allowed, cpu)) {
+            topo->cpu_id[topo->cpu_count++] = cpu;
+        }
+    }
+    if (topo->cpu_count == first) return false;
+
+    int n = topo->node_count++;
+    topo->node_id[n] = node;
+    topo->node_first[n] = first;
+    topo->node_cpus[n] = topo->cpu_count - first;
+    return true;
+}
+
+void numa_detect(NumaTopology* topo) {
+    uint64_t allowed[NUMA_CPU_WORDS];
+    uint64_t node_bits[NUMA_CPU_WORDS];
+    char path[64];
+    char list[4096];
+
+    memset(topo, 0, sizeof(*topo));
+    numa_allowed_cpus(allowed);
+
+    /* Node numbers may be sparse, so probe the whole range */
+    for (int node = 0; node < NUMA_MAX_NODES; node++) {
+        snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", node);
+        FILE* file = fopen(path, "r");
+        if (!file) continue;
+        bool ok = fgets(list, sizeof(list), file) != NULL;
+        fclose(file);
+        if (ok && numa_parse_cpulist(list, node_bits) > 0) {
+            numa_add_node(topo, node, node_bits, allowed);
+        }
+    }
+
+    /* No node information (or none matching our mask): one flat node */
+    if (topo->node_count == 0) {
+        topo->cpu_count = 0;
+        if (!numa_add_node(topo, 0, allowed, allowed)) {
+            topo->cpu_count = 1;
+            topo->node_count = 1;
+            topo->node_cpus[0] = 1;
+        }
+    }
+}
@@ -0,0 +1,270 @@
+/*
+ * recorder.c - Asynchronous frame-sequence export
+ *
+ * The queue is a ring of frame slots. The render thread copies a frame into
+ * the slot after the queued ones and publishes it; the writer thread owns a
+ * slot from the moment it is queued until it has been written, so the copy
+ * and the write run without the lock held.
+ */
+#include "engine/recorder.h"
+#include "engine/image.h"
+#include "core/utils.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#define RECORD_PATH_MAX 1024
+
+typedef enum {
+    RECORD_Y4M = 0,           /* One uncompressed YUV 4:4:4 stream */
+    RECORD_SEQUENCE,          /* One image file per frame */
+} RecordOutput;
+
+struct Recorder {
+    RecordOutput output;
+    ImageFormat image_format;     /* Sequence: file format */
+    char path[RECORD_PATH_MAX];   /* Y4M file, or sequence pattern */
+    FILE* file;                   /* Y4M stream */
+    uint8_t* planes;              /* Y4M: Y, U and V planes of one frame */
+    int width, height;
+    int rate_num, rate_den;       /* Y4M frames per second, as a fraction */
+    RecordPolicy policy;
+    pthread_t thread;
+
+    /* Frame ring (guarded by lock) */
+    pthread_mutex_t lock;
+    pthread_cond_t ready;         /* Frame queued or stop requested */
+    pthread_cond_t space;         /* Slot freed */
+    uint32_t* frames;             /* slot_count frames of width * height */
+    int slot_count;
+    int head;                     /* Oldest queued frame (being written) */
+    int count;                    /* Queued frames, including the one being written */
+    bool stop;
+    RecordStats stats;
+};
+
+/* =============================================================================
+ * Output Formats
+ * ============================================================================= */
+
+static bool recorder_is_y4m(const char* path) {
+    const char* ext = strrchr(path, '.');
+    return ext && strcasecmp(ext, ".y4m") == 0;
+}
+
+/* ARGB composited over black to 8-bit BT.601 limited-range Y'CbCr */
+static void recorder_to_yuv(const uint32_t* argb, int count, uint8_t* y, uint8_t* u, uint8_t* v) {
+    for (int i = 0; i < count; i++) {
+        uint32_t p = argb[i], a = p >> 24;
+        int r = (int)((((p >> 16) & 0xFF) * a + 127) / 255);
+        int g = (int)((((p >> 8) & 0xFF) * a + 127) / 255);
+        int b = (int)(((p & 0xFF) * a + 127) / 255);
+        y[i] = (uint8_t)(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+        u[i] = (uint8_t)(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+        v[i] = (uint8_t)(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+    }
+}
+
+/* Writer thread: write one frame; index counts written frames */
+static bool recorder_write_frame(Recorder* recorder, const uint32_t* frame, uint64_t index) {
+    size_t plane = (size_t)recorder->width * recorder->height;
+
+    if (recorder->output == RECORD_SEQUENCE) {
+        char path[RECORD_PATH_MAX];
+        return image_sequence_path(path, sizeof(path), recorder->path, (int)index) &&
+               image_write(path, recorder->image_format, frame, recorder->width,
+                           recorder->height, recorder->width);
+    }
+
+    if (index == 0 &&
+        fprintf(recorder->file, "YUV4MPEG2 W%d H%d F%d:%d Ip A1:1 C444\n", recorder->width,
+                recorder->height, recorder->rate_num, recorder->rate_den) < 0) {
+        return false;
+    }
+    recorder_to_yuv(frame, (int)plane, recorder->planes, recorder->planes + plane,
+                    recorder->planes + 2 * plane);
+    return fputs("FRAME\n", recorder->file) >= 0 &&
+           fwrite(recorder->planes, 1, 3 * plane, recorder->file) == 3 * plane;
+}
+
+/* =============================================================================
+ * Writer Thread
+ * ============================================================================= */
+
+static void* recorder_main(void* arg) {
+    Recorder* recorder = arg;
+    size_t frame_size = (size_t)recorder->width * recorder->height;
+
+    pthread_mutex_lock(&recorder->lock);
+    for (;;) {
+        while (recorder->count == 0 && !recorder->stop) {
+            pthread_cond_wait(&recorder->ready, &recorder->lock);
+        }
+        if (recorder->count == 0) break;   /* Stopped and drained */
+
+        const uint32_t* frame = &recorder->frames[(size_t)recorder->head * frame_size];
+        uint64_t index = recorder->stats.written;
+        bool failed = recorder->stats.failed;
+        pthread_mutex_unlock(&recorder->lock);
+
+        /* After an error the queue is still drained, so a blocked render
+         * thread is released */
+        bool ok = !failed && recorder_write_frame(recorder, frame, index);
+
+        pthread_mutex_lock(&recorder->lock);
+        if (ok) {
+            recorder->stats.written++;
+        } else {
+            if (!failed) fprintf(stderr, "Recording: failed to write frame %llu (%s)\n",
+                                 (unsigned long long)index, recorder->path);
+            recorder->stats.failed = true;
+            recorder->stats.dropped++;
+        }
+        recorder->head = (recorder->head + 1) % recorder->slot_count;
+        recorder->count--;
+        pthread_cond_signal(&recorder->space);
+    }
+    pthread_mutex_unlock(&recorder->lock);
+    return NULL;
+}
+
+/* =============================================================================
+ * Public API
+ * ============================================================================= */
+
+bool recorder_check_path(const char* path) {
+    char probe[RECORD_PATH_MAX];
+    ImageFormat format;
+
+    if (strlen(path) >= RECORD_PATH_MAX) return false;
+    if (recorder_is_y4m(path)) return true;
+    return image_sequence_path(probe, sizeof(probe), path, 0) &&
+           image_format_from_path(path, &format);
+}
+
+bool recorder_parse_policy(const char* name, RecordPolicy* policy) {
+    if (strcmp(name, "drop") == 0) {
+        *policy = RECORD_DROP;
+        return true;
+    }
+    if (strcmp(name, "block") == 0) {
+        *policy = RECORD_BLOCK;
+        return true;
+    }
+    return false;
+}
+
+static void recorder_free(Recorder* recorder) {
+    if (recorder->file) fclose(recorder->file);
+    free(recorder->planes);
+    free(recorder->frames);
+    free(recorder);
+}
+
+Recorder* recorder_create(const char* path, int width, int height, int rate_num, int rate_den,
+                          RecordPolicy policy, int queue_frames) {
+    if (!recorder_check_path(path) || width < 1 || height < 1) return NULL;
+
+    Recorder* recorder = calloc(1, sizeof(Recorder));
+    if (!recorder) return NULL;
+
+    size_t frame_size = (size_t)width * height;
+    strcpy(recorder->path, path);
+    recorder->width = width;
+    recorder->height = height;
+    recorder->rate_num = MAX(rate_num, 1);
+    recorder->rate_den = MAX(rate_den, 1);
+    recorder->policy = policy;
+    recorder->slot_count = MAX(queue_frames, 1);
+    recorder->frames = malloc((size_t)recorder->slot_count * frame_size * sizeof(uint32_t));
+    if (!recorder->frames) {
+        recorder_free(recorder);
+        return NULL;
+    }
+
+    if (recorder_is_y4m(path)) {
+        /* The stream is opened up front so a bad path fails here, not on
+         * the writer thread */
+        recorder->output = RECORD_Y4M;
+        recorder->planes = malloc(3 * frame_size);
+        recorder->file = fopen(path, "wb");
+        if (!recorder->planes || !recorder->file) {
+            fprintf(stderr, "Recording: cannot open %s\n", path);
+            recorder_free(recorder);
+            return NULL;
+        }
+    } else {
+        recorder->output = RECORD_SEQUENCE;
+        image_format_from_path(path, &recorder->image_format);
+    }
+
+    pthread_mutex_init(&recorder->lock, NULL);
+    pthread_cond_init(&recorder->ready, NULL);
+    pthread_cond_init(&recorder->space, NULL);
+    if (pthread_create(&recorder->thread, NULL, recorder_main, recorder) != 0) {
+        fprintf(stderr, "Failed to start recording thread\n");
+        pthread_cond_destroy(&recorder->space);
+        pthread_cond_destroy(&recorder->ready);
+        pthread_mutex_destroy(&recorder->lock);
+        recorder_free(recorder);
+        return NULL;
+    }
+    return recorder;
+}
+
+bool recorder_submit(Recorder* recorder, const uint32_t* argb, int pitch) {
+    size_t frame_size = (size_t)recorder->width * recorder->height;
+
+    pthread_mutex_lock(&recorder->lock);
+    recorder->stats.submitted++;
+    while (recorder->count == recorder->slot_count && !recorder->stats.failed &&
+           recorder->policy == RECORD_BLOCK) {
+        pthread_cond_wait(&recorder->space, &recorder->lock);
+    }
+    if (recorder->count == recorder->slot_count || recorder->stats.failed) {
+        recorder->stats.dropped++;
+        pthread_mutex_unlock(&recorder->lock);
+        return false;
+    }
+    int tail = (recorder->head + recorder->count) % recorder->slot_count;
+    pthread_mutex_unlock(&recorder->lock);
+
+    /* The writer never reads past the queued frames, so the tail slot is
+     * ours until it is published */
+    uint32_t* dst = &recorder->frames[(size_t)tail * frame_size];
+    for (int y = 0; y < recorder->height; y++) {
+        memcpy(&dst[(size_t)y * recorder->width], &argb[(size_t)y * pitch],
+               (size_t)recorder->width * sizeof(uint32_t));
+    }
+
+    pthread_mutex_lock(&recorder->lock);
+    recorder->count++;
+    recorder->stats.max_queued = MAX(recorder->stats.max_queued, recorder->count);
+    pthread_cond_signal(&recorder->ready);
+    pthread_mutex_unlock(&recorder->lock);
+    return true;
+}
+
+void recorder_close(Recorder* recorder, RecordStats* stats) {
+    if (!recorder) return;
+
+    pthread_mutex_lock(&recorder->lock);
+    recorder->stop = true;
+    pthread_cond_signal(&recorder->ready);
+    pthread_mutex_unlock(&recorder->lock);
+    pthread_join(recorder->thread, NULL);
+
+    if (recorder->file && fclose(recorder->file) != 0) {
+        fprintf(stderr, "Recording: failed to close %s\n", recorder->path);
+        recorder->stats.failed = true;
+    }
+    recorder->file = NULL;
+    if (stats) *stats = recorder->stats;
+
+    pthread_cond_destroy(&recorder->space);
+    pthread_cond_destroy(&recorder->ready);
+    pthread_mutex_destroy(&recorder->lock);
+    recorder_free(recorder);
+}
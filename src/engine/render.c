@@ -2,20 +2,91 @@
  * render.c - SDL2-based rendering implementation
  */
 #include "engine/render.h"
+#include "engine/kernels.h"
 #include "materials/material.h"
 #include "subsystems/fire.h"
+#include "physics/thermal.h"
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include <math.h>
 
-/* Glow settings */
-#define GLOW_RADIUS 3
+/* Glow settings (the blur radius is fixed by the glow kernels) */
+#define GLOW_RADIUS KERNEL_GLOW_RADIUS
 #define GLOW_INTENSITY 40
+#define GLOW_SPAN (CHUNK_SIZE_MAX + 2 * GLOW_RADIUS)
+
+/* Per-worker glow scratch, in uint16_t */
+#define GLOW_EMIT_SIZE ((size_t)GLOW_SPAN * GLOW_SPAN)
+#define GLOW_ROWS_SIZE ((size_t)GLOW_SPAN * CHUNK_SIZE_MAX)
+
+/* Pixel rows per band of the full-frame overlays */
+#define RENDER_BAND_ROWS 16
 
 /* =============================================================================
  * Helper Functions
  * ============================================================================= */
 
+/* Heatmap color of a temperature */
+static uint32_t render_heat_color(float temp) {
+    /* Map temperature to color:
+     * < 0: Blue (cold)
+     * 0-20: Green-ish (ambient)
+     * 20-100: Yellow (warm)
+     * > 100: Red-Orange (hot)
+     * > 500: White (very hot)
+     */
+    uint8_t r, g, b;
+    
+    if (temp < 0) {
+        /* Cold: blue */
+        float cold = CLAMP(-temp / 50.0f, 0.0f, 1.0f);
+        r = 0;
+        g = (uint8_t)(100 * (1 - cold));
+        b = (uint8_t)(150 + 105 * cold);
+    } else if (temp < 20) {
+        /* Ambient: dark green */
+        r = 0;
+        g = (uint8_t)(50 + temp * 2);
+        b = 0;
+    } else if (temp < 100) {
+        /* Warm: yellow */
+        float warm = (temp - 20) / 80.0f;
+        r = (uint8_t)(255 * warm);
+        g = (uint8_t)(100 + 155 * warm);
+        b = 0;
+    } else if (temp < 500) {
+        /* Hot: orange to red */
+        float hot = (temp - 100) / 400.0f;
+        r = 255;
+        g = (uint8_t)(200 * (1 - hot));
+        b = 0;
+    } else {
+        /* Very hot: white */
+        float vhot = CLAMP((temp - 500) / 500.0f, 0.0f, 1.0f);
+        r = 255;
+        g = (uint8_t)(200 + 55 * vhot);
+        b = (uint8_t)(200 * vhot);
+    }
+    
+    return 0xFF000000 | ((uint32_t)r << 16) | ((uint32_t)g << 8) | b;
+}
+
+/* Temperature overlay colors over [MIN_TEMPERATURE, MAX_TEMPERATURE], one
+ * per degree, baked once; the overlay blends them with kernels.heat_blend */
+static uint32_t heat_lut[KERNEL_HEAT_LUT_SIZE];
+static bool heat_lut_ready;
+
+static void render_heat_lut_init(void) {
+    if (heat_lut_ready) return;
+    for (int i = 0; i < KERNEL_HEAT_LUT_SIZE; i++) {
+        float temp = MIN_TEMPERATURE +
+                     (float)i * (MAX_TEMPERATURE - MIN_TEMPERATURE) / (KERNEL_HEAT_LUT_SIZE - 1);
+        heat_lut[i] = render_heat_color(temp);
+    }
+    heat_lut_ready = true;
+}
+
 uint32_t color_to_argb(Color c) {
     return ((uint32_t)c.a << 24) | ((uint32_t)c.r << 16) | ((uint32_t)c.g << 8) | (uint32_t)c.b;
 }
@@ -24,7 +95,64 @@ uint32_t color_to_argb(Color c) {
  * Renderer Lifecycle
  * ============================================================================= */
 
-Renderer* render_create(int width, int height, const char* title) {
+/* True if the streaming texture can be locked for drawing */
+static bool render_probe_lock(Renderer* renderer) {
+    void* pixels;
+    int pitch;
+    if (SDL_LockTexture(renderer->texture, NULL, &pixels, &pitch) != 0) return false;
+    SDL_UnlockTexture(renderer->texture);
+    return pitch % (int)sizeof(uint32_t) == 0;
+}
+
+/* Allocate the frame buffer (copy path only) and glow scratch, starting
+ * from opaque black; false on failure. World-sized buffers follow the
+ * first world drawn (render_bind_world). */
+static bool render_alloc_buffers(Renderer* renderer) {
+    size_t count = (size_t)renderer->width * renderer->height;
+    
+    if (!renderer->zero_copy) {
+        renderer->pixels = calloc(count, sizeof(uint32_t));
+    }
+    renderer->glow_emit = calloc(GLOW_EMIT_SIZE, sizeof(uint16_t));
+    renderer->glow_rows = calloc(GLOW_ROWS_SIZE, sizeof(uint16_t));
+    renderer->glow_workers = 1;
+    if ((!renderer->zero_copy && !renderer->pixels) || !renderer->glow_emit ||
+        !renderer->glow_rows) {
+        return false;
+    }
+    
+    /* The first frame draws every chunk */
+    if (renderer->pixels) {
+        kernels.fill_u32(renderer->pixels, count, 0xFF000000);
+    }
+    renderer->full_redraw = true;
+    return true;
+}
+
+/* Free the base colors, canvas and mip levels */
+static void render_free_world_buffers(Renderer* renderer) {
+    free(renderer->base);
+    free(renderer->canvas);
+    free(renderer->view_cols);
+    renderer->base = NULL;
+    renderer->canvas = NULL;
+    renderer->view_cols = NULL;
+    for (int level = 1; level <= RENDER_MIP_LEVELS; level++) {
+        free(renderer->mip[level]);
+        renderer->mip[level] = NULL;
+    }
+    renderer->world_width = 0;
+    renderer->world_height = 0;
+}
+
+static void render_free_buffers(Renderer* renderer) {
+    free(renderer->pixels);
+    free(renderer->glow_emit);
+    free(renderer->glow_rows);
+    render_free_world_buffers(renderer);
+}
+
+static Renderer* render_alloc(int width, int height) {
     Renderer* renderer = calloc(1, sizeof(Renderer));
     if (!renderer) return NULL;
     
@@ -33,6 +161,26 @@ Renderer* render_create(int width, int height, const char* title) {
     renderer->overlay_mode = OVERLAY_NONE;
     renderer->show_fps = true;
     renderer->show_stats = true;
+    render_heat_lut_init();
+    return renderer;
+}
+
+Renderer* render_create_headless(int width, int height) {
+    Renderer* renderer = render_alloc(width, height);
+    if (!renderer) return NULL;
+    
+    renderer->headless = true;
+    if (!render_alloc_buffers(renderer)) {
+        render_free_buffers(renderer);
+        free(renderer);
+        return NULL;
+    }
+    return renderer;
+}
+
+Renderer* render_create(int width, int height, const char* title) {
+    Renderer* renderer = render_alloc(width, height);
+    if (!renderer) return NULL;
     
     /* Initialize SDL */
     if (SDL_Init(SDL_INIT_VIDEO) < 0) {
@@ -84,9 +232,14 @@ Renderer* render_create(int width, int height, const char* title) {
         return NULL;
     }
     
-    /* Allocate pixel buffer */
-    renderer->pixels = calloc((size_t)width * height, sizeof(uint32_t));
-    if (!renderer->pixels) {
+    /* Draw into the texture when it can be locked; the copy path keeps its
+     * own frame buffer and uploads it with SDL_UpdateTexture */
+    const char* mode = getenv("PIXELSIM_RENDER");
+    renderer->zero_copy = !(mode && strcmp(mode, "copy") == 0) && render_probe_lock(renderer);
+    
+    /* Allocate pixel buffers */
+    if (!render_alloc_buffers(renderer)) {
+        render_free_buffers(renderer);
         SDL_DestroyTexture(renderer->texture);
         SDL_DestroyRenderer(renderer->renderer);
         SDL_DestroyWindow(renderer->window);
@@ -101,159 +254,800 @@ Renderer* render_create(int width, int height, const char* title) {
 void render_destroy(Renderer* renderer) {
     if (!renderer) return;
     
-    free(renderer->pixels);
-    if (renderer->texture) SDL_DestroyTexture(renderer->texture);
-    if (renderer->renderer) SDL_DestroyRenderer(renderer->renderer);
-    if (renderer->window) SDL_DestroyWindow(renderer->window);
-    SDL_Quit();
+    render_free_buffers(renderer);
+    if (!renderer->headless) {
+        if (renderer->texture) SDL_DestroyTexture(renderer->texture);
+        if (renderer->renderer) SDL_DestroyRenderer(renderer->renderer);
+        if (renderer->window) SDL_DestroyWindow(renderer->window);
+        SDL_Quit();
+    }
     free(renderer);
 }
 
+/* =============================================================================
+ * Camera
+ * ============================================================================= */
+
+/* Subcells per frame pixel at a zoom level */
+static inline int render_zoom_step(int zoom) {
+    return zoom >= 0 ? RENDER_SUBCELL >> zoom : RENDER_SUBCELL << -zoom;
+}
+
+/* Cells along one side of mip level L */
+static inline int render_mip_size(int cells, int level) {
+    return (cells + (1 << level) - 1) >> level;
+}
+
+/* Keep the view on the world; along an axis where the world is smaller
+ * than the view, it is centered */
+static void render_clamp_camera(Renderer* renderer) {
+    RenderCamera* cam = &renderer->camera;
+    int step = render_zoom_step(cam->zoom);
+    int view_w = renderer->width * step, view_h = renderer->height * step;
+    int world_w = renderer->world_width << RENDER_SUBCELL_SHIFT;
+    int world_h = renderer->world_height << RENDER_SUBCELL_SHIFT;
+    
+    if (renderer->world_width == 0) return;
+    cam->x = view_w >= world_w ? (world_w - view_w) / 2 : CLAMP(cam->x, 0, world_w - view_w);
+    cam->y = view_h >= world_h ? (world_h - view_h) / 2 : CLAMP(cam->y, 0, world_h - view_h);
+}
+
+void render_pan(Renderer* renderer, int dx, int dy) {
+    int step = render_zoom_step(renderer->camera.zoom);
+    renderer->camera.x += dx * step;
+    renderer->camera.y += dy * step;
+    render_clamp_camera(renderer);
+    renderer->view_dirty = true;
+}
+
+void render_zoom(Renderer* renderer, int steps, int sx, int sy) {
+    RenderCamera* cam = &renderer->camera;
+    int zoom = CLAMP(cam->zoom + steps, RENDER_ZOOM_MIN, RENDER_ZOOM_MAX);
+    if (zoom == cam->zoom) return;
+    
+    /* The subcell under (sx, sy) stays under it */
+    int old_step = render_zoom_step(cam->zoom), new_step = render_zoom_step(zoom);
+    cam->x += sx * (old_step - new_step);
+    cam->y += sy * (old_step - new_step);
+    cam->zoom = zoom;
+    render_clamp_camera(renderer);
+    renderer->view_dirty = true;
+}
+
+void render_reset_view(Renderer* renderer) {
+    renderer->camera = (RenderCamera){ 0, 0, 0 };
+    render_clamp_camera(renderer);
+    renderer->view_dirty = true;
+}
+
+void render_screen_to_world(const Renderer* renderer, int sx, int sy, int* x, int* y) {
+    const RenderCamera* cam = &renderer->camera;
+    int step = render_zoom_step(cam->zoom);
+    *x = (cam->x + sx * step) >> RENDER_SUBCELL_SHIFT;
+    *y = (cam->y + sy * step) >> RENDER_SUBCELL_SHIFT;
+}
+
+/* True if the frame shows the world 1:1 from its corner, so chunks are
+ * composed straight into the frame */
+static inline bool render_view_is_identity(const Renderer* renderer, const World* world) {
+    const RenderCamera* cam = &renderer->camera;
+    return cam->zoom == 0 && cam->x == 0 && cam->y == 0 &&
+           world->width == renderer->width && world->height == renderer->height;
+}
+
+/* Size the base colors for world (opaque black, everything stale); false
+ * if out of memory */
+static bool render_bind_world(Renderer* renderer, const World* world) {
+    if (renderer->world_width == world->width && renderer->world_height == world->height) {
+        return true;
+    }
+    
+    size_t count = (size_t)world->width * world->height;
+    render_free_world_buffers(renderer);
+    renderer->base = malloc(count * sizeof(uint32_t));
+    if (!renderer->base) {
+        fprintf(stderr, "Out of memory for %dx%d render buffers\n", world->width, world->height);
+        return false;
+    }
+    kernels.fill_u32(renderer->base, count, 0xFF000000);
+    renderer->world_width = world->width;
+    renderer->world_height = world->height;
+    renderer->full_redraw = true;
+    render_clamp_camera(renderer);
+    return true;
+}
+
+/* Canvas, mip levels and resampling table, allocated the first time the
+ * view is not 1:1; false if out of memory */
+static bool render_alloc_view(Renderer* renderer) {
+    if (renderer->canvas) return true;
+    
+    size_t count = (size_t)renderer->world_width * renderer->world_height;
+    bool ok = true;
+    renderer->canvas = malloc(count * sizeof(uint32_t));
+    renderer->view_cols = malloc((size_t)renderer->width * sizeof(int));
+    ok = renderer->canvas && renderer->view_cols;
+    for (int level = 1; level <= RENDER_MIP_LEVELS && ok; level++) {
+        size_t texels = (size_t)render_mip_size(renderer->world_width, level) *
+                        render_mip_size(renderer->world_height, level);
+        renderer->mip[level] = malloc(texels * sizeof(RenderMip));
+        ok = renderer->mip[level] != NULL;
+    }
+    if (!ok) {
+        fprintf(stderr, "Out of memory for the view canvas\n");
+        free(renderer->canvas);
+        free(renderer->view_cols);
+        renderer->canvas = NULL;
+        renderer->view_cols = NULL;
+        for (int level = 1; level <= RENDER_MIP_LEVELS; level++) {
+            free(renderer->mip[level]);
+            renderer->mip[level] = NULL;
+        }
+        return false;
+    }
+    
+    /* Nothing has been composed or reduced yet */
+    kernels.fill_u32(renderer->canvas, count, 0xFF000000);
+    for (int i = 0; i < CHUNK_COUNT_MAX; i++) {
+        renderer->chunk_state[i] &= (uint8_t)~(RENDER_STATE_CANVAS | RENDER_STATE_MIP);
+    }
+    return true;
+}
+
+bool render_set_workers(Renderer* renderer, WorkerPool* workers) {
+    int count = workers ? workers_count(workers) : 1;
+    
+    if (count != renderer->glow_workers) {
+        uint16_t* emit = calloc(GLOW_EMIT_SIZE * count, sizeof(uint16_t));
+        uint16_t* rows = calloc(GLOW_ROWS_SIZE * count, sizeof(uint16_t));
+        if (!emit || !rows) {
+            free(emit);
+            free(rows);
+            return false;
+        }
+        free(renderer->glow_emit);
+        free(renderer->glow_rows);
+        renderer->glow_emit = emit;
+        renderer->glow_rows = rows;
+        renderer->glow_workers = count;
+    }
+    renderer->workers = workers;
+    return true;
+}
+
 /* =============================================================================
  * Frame Rendering
+ *
+ * Work is split into horizontal bands (a chunk row, or RENDER_BAND_ROWS
+ * pixel rows for overlays) run on the worker pool. Bands write disjoint
+ * rows of the base and pixel buffers, so the frame does not depend on the
+ * thread count.
  * ============================================================================= */
 
+/* Run func for bands [0, count) on the pool, or inline without one */
+static void render_parallel_for(Renderer* renderer, int count, WorkerTaskFunc func, void* ctx) {
+    if (renderer->workers) {
+        workers_parallel_for(renderer->workers, count, func, ctx);
+        return;
+    }
+    for (int i = 0; i < count; i++) {
+        func(ctx, i, 0);
+    }
+}
+
 void render_begin_frame(Renderer* renderer) {
-    /* Clear pixel buffer to opaque black using memset
-     * Note: 0xFF000000 in ARGB is fully opaque black, but memset(0) gives
-     * transparent black. We use a fast fill pattern instead. */
-    size_t pixel_count = (size_t)renderer->width * renderer->height;
-    /* Fill with opaque black (0xFF000000) - ARGB format */
-    uint32_t* pixels = renderer->pixels;
-    for (size_t i = 0; i < pixel_count; i += 4) {
-        pixels[i] = 0xFF000000;
-        pixels[i + 1] = 0xFF000000;
-        pixels[i + 2] = 0xFF000000;
-        pixels[i + 3] = 0xFF000000;
+    /* The frame buffer persists; only regions redrawn below are uploaded */
+    renderer->dirty_count = 0;
+    renderer->upload_all = false;
+    renderer->target.pixels = NULL;
+}
+
+/* Debug overlays that draw over the whole frame */
+static inline bool render_overlay_covers_frame(OverlayMode mode) {
+    return mode == OVERLAY_CHUNKS || mode == OVERLAY_UPDATED || mode == OVERLAY_TEMPERATURE;
+}
+
+/* Lock frame rows [y0, y1) of the texture as this frame's target */
+static bool render_lock_rows(Renderer* renderer, int y0, int y1) {
+    SDL_Rect rect = { 0, y0, renderer->width, y1 - y0 };
+    void* pixels;
+    int pitch;
+    if (SDL_LockTexture(renderer->texture, &rect, &pixels, &pitch) != 0) {
+        fprintf(stderr, "SDL_LockTexture failed: %s\n", SDL_GetError());
+        return false;
+    }
+    renderer->target = (RenderTarget){ pixels, pitch / (int)sizeof(uint32_t), y0, y1 };
+    return true;
+}
+
+/* ARGB color of an animated (fire or smoke) cell */
+static inline uint32_t render_animated_argb(const World* world, int world_idx) {
+    MaterialID mat = world->mat[world_idx];
+    
+    if (mat == MAT_FIRE) {
+        /* Fire uses lifetime-based color animation */
+        return color_to_argb(fire_get_color(world->lifetime[world_idx]));
+    }
+    
+    /* Smoke fades with age: reduce alpha as it ages */
+    uint32_t argb = material_palette()[(mat << MATERIAL_PALETTE_SHIFT) | world->color_variant[world_idx]];
+    int alpha = 150 - (world->lifetime[world_idx] / 2);
+    if (alpha < 20) alpha = 20;
+    return (argb & 0x00FFFFFFu) | ((uint32_t)alpha << 24);
+}
+
+/* Draw the cell colors of one chunk into the base buffer; returns what the
+ * chunk holds (RENDER_CHUNK_*) */
+static uint8_t render_chunk_base(Renderer* renderer, const World* world,
+                                 int x0, int y0, int x1, int y1) {
+    static const uint8_t ANIMATED_LUT[KERNEL_LUT_SIZE] = { [MAT_FIRE] = 1, [MAT_SMOKE] = 1 };
+    const uint32_t* palette = material_palette();
+    uint8_t flags = 0;
+    
+    for (int y = y0; y < y1; y++) {
+        uint32_t* row = &renderer->base[(size_t)y * world->width];
+        int first = IDX(x0, y);
+        
+        /* Baked palette colors for the whole span, then animated cells */
+        kernels.palette_row(&row[x0], &world->mat[first], &world->color_variant[first],
+                            x1 - x0, palette);
+        
+        for (int px = x0; px < x1; px += 64) {
+            uint64_t animated = kernels.row_classify(&world->mat[IDX(px, y)],
+                                                     MIN(64, x1 - px), ANIMATED_LUT);
+            while (animated) {
+                int x = px + __builtin_ctzll(animated);
+                animated &= animated - 1;
+                
+                int world_idx = IDX(x, y);
+                flags |= RENDER_CHUNK_ANIMATED;
+                if (world->mat[world_idx] == MAT_FIRE) flags |= RENDER_CHUNK_FIRE;
+                row[x] = render_animated_argb(world, world_idx);
+            }
+        }
+    }
+    return flags;
+}
+
+/* Glow emission of a fire cell; younger fire is brighter. Scaled by 4/3 so
+ * a direct neighbor receives the full intensity (center tap 16, neighbor 12) */
+static inline uint16_t render_glow_emission(uint8_t lifetime) {
+    int intensity = GLOW_INTENSITY - (lifetime / 4);
+    if (intensity < 10) intensity = 10;
+    return (uint16_t)(intensity * 4 / 3);
+}
+
+/* Compose [x0, x1) x [y0, y1) as base colors plus fire glow: fire emission
+ * from the rectangle widened by GLOW_RADIUS is blurred along rows, then down
+ * columns, and the result added with saturation. Each output pixel gathers from its
+ * neighborhood, so the cost is per pixel, not per fire cell, and the image
+ * does not depend on how the frame is split into rectangles. */
+static void render_glow_rect(Renderer* renderer, const World* world, int worker,
+                             int x0, int y0, int x1, int y1) {
+    static const uint8_t FIRE_LUT[KERNEL_LUT_SIZE] = { [MAT_FIRE] = 1 };
+    int w = x1 - x0;
+    int span = w + 2 * GLOW_RADIUS;
+    int rows = (y1 - y0) + 2 * GLOW_RADIUS;
+    uint16_t* emit = &renderer->glow_emit[GLOW_EMIT_SIZE * worker];
+    uint16_t* blurred = &renderer->glow_rows[GLOW_ROWS_SIZE * worker];
+    uint16_t out[CHUNK_SIZE_MAX];
+    
+    /* 1. Emission buffer (zero outside the grid) */
+    int ex0 = x0 - GLOW_RADIUS, ey0 = y0 - GLOW_RADIUS;
+    int fx0 = MAX(ex0, 0), fx1 = MIN(x1 + GLOW_RADIUS, world->width);
+    for (int j = 0; j < rows; j++) {
+        uint16_t* row = &emit[j * span];
+        int y = ey0 + j;
+        memset(row, 0, (size_t)span * sizeof(uint16_t));
+        if (y < 0 || y >= world->height) continue;
+        
+        for (int px = fx0; px < fx1; px += 64) {
+            uint64_t fire = kernels.row_classify(&world->mat[IDX(px, y)],
+                                                 MIN(64, fx1 - px), FIRE_LUT);
+            while (fire) {
+                int x = px + __builtin_ctzll(fire);
+                fire &= fire - 1;
+                row[x - ex0] = render_glow_emission(world->lifetime[IDX(x, y)]);
+            }
+        }
+    }
+    
+    /* 2. Horizontal pass over every emission row */
+    for (int j = 0; j < rows; j++) {
+        kernels.glow_blur(&blurred[j * w], &emit[j * span + GLOW_RADIUS], w, 1);
+    }
+    
+    /* 3. Vertical pass per output row, added to the frame */
+    for (int y = y0; y < y1; y++) {
+        kernels.glow_blur(out, &blurred[(y - y0 + GLOW_RADIUS) * w], w, w);
+        kernels.glow_add(&render_target_row(&renderer->target, y)[x0],
+                         &renderer->base[(size_t)y * world->width + x0], out,
+                         &world->mat[IDX(x0, y)], w);
+    }
+}
+
+/* True if chunk (cx, cy) or a neighbor held fire when last drawn */
+static bool render_near_fire(const Renderer* renderer, const World* world, int cx, int cy) {
+    for (int ny = MAX(cy - 1, 0); ny <= MIN(cy + 1, world->chunks_y - 1); ny++) {
+        for (int nx = MAX(cx - 1, 0); nx <= MIN(cx + 1, world->chunks_x - 1); nx++) {
+            if (renderer->chunk_flags[ny * world->chunks_x + nx] & RENDER_CHUNK_FIRE) return true;
+        }
+    }
+    return false;
+}
+
+/* Queue a texture region for upload */
+static void render_mark_dirty(Renderer* renderer, int x0, int y0, int x1, int y1) {
+    if (renderer->upload_all) return;
+    if (renderer->dirty_count == RENDER_DIRTY_MAX) {
+        renderer->upload_all = true;
+        return;
+    }
+    renderer->dirty[renderer->dirty_count++] = (SDL_Rect){ x0, y0, x1 - x0, y1 - y0 };
+}
+
+/* Shared state of the render_world passes */
+typedef struct {
+    Renderer* renderer;
+    const World* world;
+    bool full;                /* Redraw every chunk */
+    bool view;                /* Composing into the canvas, not the frame */
+    uint8_t redraw[CHUNK_COUNT_MAX];    /* Bit 0: redrawn, bit 1: glow changed */
+    uint8_t compose[CHUNK_COUNT_MAX];   /* Composed (or reduced to mips) this frame */
+    int first_row;            /* Chunk row of band 0 */
+} RenderPass;
+
+/* True if chunk i must be redrawn before it is shown */
+static inline bool render_chunk_stale(const Renderer* renderer, const World* world, int i,
+                                      bool full, bool ticked) {
+    return full || (renderer->chunk_state[i] & RENDER_STATE_STALE) ||
+           renderer->chunk_version[i] != world->chunk_version[i] ||
+           (ticked && (renderer->chunk_flags[i] & RENDER_CHUNK_ANIMATED));
+}
+
+/* Band = chunk row first_row + band: redraw the base colors of stale
+ * chunks (redraw bit 0). Bit 1 is added for chunks whose glow (before or
+ * after) reaches their neighbors. */
+static void render_base_band(void* ctx, int band, int worker) {
+    RenderPass* pass = ctx;
+    int cy = pass->first_row + band;
+    Renderer* renderer = pass->renderer;
+    const World* world = pass->world;
+    int size = world->chunk_size;
+    (void)worker;
+    
+    for (int cx = 0; cx < world->chunks_x; cx++) {
+        int i = cy * world->chunks_x + cx;
+        if (!pass->redraw[i]) continue;
+        
+        uint8_t before = pass->full ? 0 : renderer->chunk_flags[i];
+        int x0 = cx * size, y0 = cy * size;
+        uint8_t flags = render_chunk_base(renderer, world, x0, y0,
+                                          MIN(x0 + size, world->width),
+                                          MIN(y0 + size, world->height));
+        renderer->chunk_version[i] = world->chunk_version[i];
+        renderer->chunk_flags[i] = flags;
+        renderer->chunk_state[i] = 0;     /* Canvas and mips are now behind */
+        pass->redraw[i] = 1 | (((before | flags) & RENDER_CHUNK_FIRE) ? 2 : 0);
+    }
+}
+
+/* Band = chunk row first_row + band: compose the chunks marked in compose
+ * from the base colors, adding fire glow near fire sources */
+static void render_compose_band(void* ctx, int band, int worker) {
+    RenderPass* pass = ctx;
+    int cy = pass->first_row + band;
+    Renderer* renderer = pass->renderer;
+    const World* world = pass->world;
+    int size = world->chunk_size;
+    int y0 = cy * size, y1 = MIN(y0 + size, world->height);
+    
+    for (int cx = 0; cx < world->chunks_x; cx++) {
+        int i = cy * world->chunks_x + cx;
+        if (!pass->compose[i]) continue;
+        
+        int x0 = cx * size, x1 = MIN(x0 + size, world->width);
+        if (pass->view) renderer->chunk_state[i] |= RENDER_STATE_CANVAS;
+        if (render_near_fire(renderer, world, cx, cy)) {
+            render_glow_rect(renderer, world, worker, x0, y0, x1, y1);
+            continue;
+        }
+        for (int y = y0; y < y1; y++) {
+            memcpy(&render_target_row(&renderer->target, y)[x0],
+                   &renderer->base[(size_t)y * world->width + x0],
+                   (size_t)(x1 - x0) * sizeof(uint32_t));
+        }
+    }
+}
+
+/* Chunk rows [cy0, cy1) of the frame as this frame's target; false if
+ * nothing can be drawn */
+static bool render_open_target(Renderer* renderer, const World* world, int cy0, int cy1) {
+    if (!renderer->zero_copy) {
+        renderer->target = (RenderTarget){ renderer->pixels, renderer->width, 0, renderer->height };
+        return true;
+    }
+    
+    /* A locked region holds undefined pixels, so the whole band of rows is
+     * locked and drawn; chunks outside it keep their uploaded texels */
+    int y1 = MIN(cy1 * world->chunk_size, world->height);
+    if (render_lock_rows(renderer, cy0 * world->chunk_size, y1)) return true;
+    
+    /* Retry from scratch next frame */
+    renderer->full_redraw = true;
+    return false;
+}
+
+/* Texel (tx, ty) of mip level L from its (up to) four children: cells for
+ * level 1, texels of level L - 1 above that */
+static inline RenderMip render_mip_texel(const Renderer* renderer, const World* world,
+                                         int level, int tx, int ty) {
+    RenderMip kids[4];
+    int n = 0;
+    
+    if (level == 1) {
+        for (int y = 2 * ty; y < MIN(2 * ty + 2, world->height); y++) {
+            for (int x = 2 * tx; x < MIN(2 * tx + 2, world->width); x++) {
+                kids[n++] = (RenderMip){ renderer->base[(size_t)y * world->width + x], 1,
+                                         world->mat[IDX(x, y)] };
+            }
+        }
+    } else {
+        int cw = render_mip_size(world->width, level - 1);
+        int ch = render_mip_size(world->height, level - 1);
+        const RenderMip* child = renderer->mip[level - 1];
+        for (int y = 2 * ty; y < MIN(2 * ty + 2, ch); y++) {
+            for (int x = 2 * tx; x < MIN(2 * tx + 2, cw); x++) {
+                kids[n++] = child[(size_t)y * cw + x];
+            }
+        }
+    }
+    
+    if (n == 0) return (RenderMip){ 0xFF000000, 0, MAT_EMPTY };
+    
+    /* Dominant material: most cells over the children that hold it */
+    int best = 0, best_count = 0;
+    for (int k = 0; k < n; k++) {
+        int count = 0;
+        for (int j = 0; j < n; j++) {
+            if (kids[j].mat == kids[k].mat) count += kids[j].count;
+        }
+        if (count > best_count) {
+            best = k;
+            best_count = count;
+        }
+    }
+    
+    /* Its color: the mean over its cells, per channel */
+    uint32_t sum[4] = {0, 0, 0, 0};
+    for (int j = 0; j < n; j++) {
+        if (kids[j].mat != kids[best].mat) continue;
+        for (int c = 0; c < 4; c++) {
+            sum[c] += ((kids[j].color >> (8 * c)) & 0xFF) * kids[j].count;
+        }
+    }
+    uint32_t color = 0;
+    for (int c = 0; c < 4; c++) {
+        color |= ((sum[c] + (uint32_t)best_count / 2) / (uint32_t)best_count) << (8 * c);
+    }
+    return (RenderMip){ color, (uint16_t)best_count, kids[best].mat };
+}
+
+/* Rebuild the mip pyramid of one chunk from its base colors, up to one
+ * texel per chunk */
+static void render_chunk_mips(Renderer* renderer, const World* world, int cx, int cy) {
+    int x0 = cx * world->chunk_size, y0 = cy * world->chunk_size;
+    int x1 = MIN(x0 + world->chunk_size, world->width);
+    int y1 = MIN(y0 + world->chunk_size, world->height);
+    
+    for (int level = 1; level <= world->chunk_shift; level++) {
+        int lw = render_mip_size(world->width, level);
+        int tx1 = render_mip_size(x1, level), ty1 = render_mip_size(y1, level);
+        for (int ty = y0 >> level; ty < ty1; ty++) {
+            for (int tx = x0 >> level; tx < tx1; tx++) {
+                renderer->mip[level][(size_t)ty * lw + tx] =
+                    render_mip_texel(renderer, world, level, tx, ty);
+            }
+        }
+    }
+}
+
+/* Band = chunk row first_row + band: rebuild the mips of the chunks marked
+ * in compose */
+static void render_mip_band(void* ctx, int band, int worker) {
+    RenderPass* pass = ctx;
+    int cy = pass->first_row + band;
+    const World* world = pass->world;
+    (void)worker;
+    
+    for (int cx = 0; cx < world->chunks_x; cx++) {
+        int i = cy * world->chunks_x + cx;
+        if (!pass->compose[i]) continue;
+        render_chunk_mips(pass->renderer, world, cx, cy);
+        pass->renderer->chunk_state[i] |= RENDER_STATE_MIP;
     }
-    /* Handle remaining pixels */
-    for (size_t i = (pixel_count / 4) * 4; i < pixel_count; i++) {
-        pixels[i] = 0xFF000000;
+}
+
+/* True if a chunk next to (cx, cy), or the chunk itself, changed its glow */
+static bool render_glow_changed(const RenderPass* pass, int cx, int cy) {
+    const World* world = pass->world;
+    for (int ny = MAX(cy - 1, 0); ny <= MIN(cy + 1, world->chunks_y - 1); ny++) {
+        for (int nx = MAX(cx - 1, 0); nx <= MIN(cx + 1, world->chunks_x - 1); nx++) {
+            if (pass->redraw[ny * world->chunks_x + nx] & 2) return true;
+        }
     }
+    return false;
+}
+
+/* Camera path: chunks in and next to the view (whose fire glows into it)
+ * are redrawn when stale; the rest are only marked. Visible chunks are then
+ * brought up to date in the canvas, or in the mip levels when zoomed out,
+ * and the frame is resampled from those in render_end_frame. Work follows
+ * what the window shows, not the size of the world. */
+static void render_world_view(Renderer* renderer, const World* world) {
+    const RenderCamera* cam = &renderer->camera;
+    int size = world->chunk_size, shift = world->chunk_shift;
+    int step = render_zoom_step(cam->zoom);
+    RenderPass pass;
+    pass.renderer = renderer;
+    pass.world = world;
+    pass.view = true;
+    renderer->view_level = cam->zoom < 0 ? MIN(-cam->zoom, shift) : 0;
+    pass.full = renderer->full_redraw || renderer->chunk_size != size ||
+                (render_overlay_covers_frame(renderer->overlay_mode) && renderer->view_level == 0);
+    
+    /* Visible cells, chunks and the ring around them */
+    int x0 = MAX(cam->x >> RENDER_SUBCELL_SHIFT, 0);
+    int y0 = MAX(cam->y >> RENDER_SUBCELL_SHIFT, 0);
+    int x1 = MIN((cam->x + renderer->width * step + RENDER_SUBCELL - 1) >> RENDER_SUBCELL_SHIFT,
+                 world->width);
+    int y1 = MIN((cam->y + renderer->height * step + RENDER_SUBCELL - 1) >> RENDER_SUBCELL_SHIFT,
+                 world->height);
+    int cx0 = x0 >> shift, cy0 = y0 >> shift;
+    int cx1 = (x1 + size - 1) >> shift, cy1 = (y1 + size - 1) >> shift;
+    int ax0 = MAX(cx0 - 1, 0), ay0 = MAX(cy0 - 1, 0);
+    int ax1 = MIN(cx1 + 1, world->chunks_x), ay1 = MIN(cy1 + 1, world->chunks_y);
+    
+    bool ticked = renderer->generation != world->generation;
+    int stale = 0;
+    for (int cy = 0; cy < world->chunks_y; cy++) {
+        for (int cx = 0; cx < world->chunks_x; cx++) {
+            int i = cy * world->chunks_x + cx;
+            bool near = cx >= ax0 && cx < ax1 && cy >= ay0 && cy < ay1;
+            bool redraw = render_chunk_stale(renderer, world, i, pass.full, ticked);
+            if (redraw && !near) renderer->chunk_state[i] |= RENDER_STATE_STALE;
+            pass.redraw[i] = redraw && near;
+            stale += pass.redraw[i];
+        }
+    }
+    renderer->full_redraw = false;
+    renderer->chunk_size = size;
+    renderer->generation = world->generation;
+    if (x0 >= x1 || y0 >= y1) return;
+    
+    if (stale > 0) {
+        pass.first_row = ay0;
+        render_parallel_for(renderer, ay1 - ay0, render_base_band, &pass);
+    }
+    
+    /* Visible chunks whose canvas or mips are behind; chunks out of view
+     * whose glow changed recompose when they come into view */
+    uint8_t need = renderer->view_level > 0 ? RENDER_STATE_MIP : RENDER_STATE_CANVAS;
+    int pending = 0;
+    for (int cy = 0; cy < world->chunks_y; cy++) {
+        for (int cx = 0; cx < world->chunks_x; cx++) {
+            int i = cy * world->chunks_x + cx;
+            bool visible = cx >= cx0 && cx < cx1 && cy >= cy0 && cy < cy1;
+            bool glow = renderer->view_level == 0 && render_glow_changed(&pass, cx, cy);
+            if (glow && !visible) renderer->chunk_state[i] &= (uint8_t)~RENDER_STATE_CANVAS;
+            pass.compose[i] = visible && (glow || !(renderer->chunk_state[i] & need));
+            pending += pass.compose[i];
+        }
+    }
+    if (pending == 0) return;
+    renderer->view_dirty = true;
+    pass.first_row = cy0;
+    
+    if (renderer->view_level > 0) {
+        render_parallel_for(renderer, cy1 - cy0, render_mip_band, &pass);
+        return;
+    }
+    
+    /* The visible chunk rows of the canvas are the target (overlays draw
+     * there too) */
+    int ty0 = cy0 * size, ty1 = MIN(cy1 * size, world->height);
+    renderer->target = (RenderTarget){ &renderer->canvas[(size_t)ty0 * world->width],
+                                       world->width, ty0, ty1 };
+    render_parallel_for(renderer, cy1 - cy0, render_compose_band, &pass);
 }
 
 void render_world(Renderer* renderer, const World* world) {
-    /* Render each cell */
-    for (int y = 0; y < world->height; y++) {
-        for (int x = 0; x < world->width; x++) {
-            int idx = y * renderer->width + x;
-            int world_idx = IDX(x, y);
-            MaterialID mat = world->mat[world_idx];
-            
-            Color c;
-            
-            /* Special handling for animated materials */
-            if (mat == MAT_FIRE) {
-                /* Fire uses lifetime-based color animation */
-                c = fire_get_color(world->lifetime[world_idx]);
-            } else if (mat == MAT_SMOKE) {
-                /* Smoke fades with age */
-                c = material_color(mat, world->color_seed[world_idx]);
-                int age = world->lifetime[world_idx];
-                /* Reduce alpha as smoke ages */
-                int alpha = 150 - (age / 2);
-                if (alpha < 20) alpha = 20;
-                c.a = (uint8_t)alpha;
-            } else {
-                c = world_get_cell_color(world, x, y);
+    if (!render_bind_world(renderer, world)) return;
+    render_clamp_camera(renderer);
+    
+    bool view = !render_view_is_identity(renderer, world);
+    if (view && !render_alloc_view(renderer)) return;
+    if (view != renderer->view_active) {
+        /* The frame was last drawn by the other path */
+        renderer->view_active = view;
+        renderer->view_dirty = view;
+        renderer->full_redraw = true;
+    }
+    if (view) {
+        render_world_view(renderer, world);
+        return;
+    }
+    
+    int size = world->chunk_size;
+    RenderPass pass;
+    pass.renderer = renderer;
+    pass.world = world;
+    pass.view = false;
+    pass.full = renderer->full_redraw || renderer->chunk_size != size ||
+                render_overlay_covers_frame(renderer->overlay_mode);
+    
+    /* Find stale chunks first, so idle frames do not wake the pool */
+    bool ticked = renderer->generation != world->generation;
+    int stale = 0;
+    for (int i = 0; i < world->chunk_count; i++) {
+        pass.redraw[i] = render_chunk_stale(renderer, world, i, pass.full, ticked);
+        stale += pass.redraw[i];
+    }
+    renderer->full_redraw = false;
+    renderer->chunk_size = size;
+    renderer->generation = world->generation;
+    if (stale == 0) return;
+    
+    pass.first_row = 0;
+    render_parallel_for(renderer, world->chunks_y, render_base_band, &pass);
+    
+    /* Compose redrawn chunks, and neighbors of changed glow sources */
+    int cy0 = world->chunks_y, cy1 = 0;
+    for (int cy = 0; cy < world->chunks_y; cy++) {
+        for (int cx = 0; cx < world->chunks_x; cx++) {
+            bool compose = pass.redraw[cy * world->chunks_x + cx] != 0 ||
+                           render_glow_changed(&pass, cx, cy);
+            pass.compose[cy * world->chunks_x + cx] = compose;
+            if (compose) {
+                cy0 = MIN(cy0, cy);
+                cy1 = MAX(cy1, cy + 1);
             }
-            
-            renderer->pixels[idx] = color_to_argb(c);
         }
     }
+    if (cy0 >= cy1 || !render_open_target(renderer, world, cy0, cy1)) return;
+    
+    if (renderer->zero_copy) {
+        /* Every chunk of the locked rows is drawn */
+        memset(&pass.compose[cy0 * world->chunks_x], 1,
+               (size_t)(cy1 - cy0) * world->chunks_x);
+    }
+    pass.first_row = cy0;
+    render_parallel_for(renderer, cy1 - cy0, render_compose_band, &pass);
+    if (renderer->zero_copy) return;
+    
+    /* Copy path: runs of composed chunks in a chunk row become one upload
+     * rectangle */
+    for (int cy = cy0; cy < cy1; cy++) {
+        int y0 = cy * size, y1 = MIN(y0 + size, world->height);
+        int run_start = -1;
+        
+        for (int cx = 0; cx <= world->chunks_x; cx++) {
+            if (cx < world->chunks_x && pass.compose[cy * world->chunks_x + cx]) {
+                if (run_start < 0) run_start = cx;
+            } else if (run_start >= 0) {
+                render_mark_dirty(renderer, run_start * size, y0,
+                                  MIN(cx * size, world->width), y1);
+                run_start = -1;
+            }
+        }
+    }
+    if (pass.full) renderer->upload_all = true;
 }
 
-/* Apply glow effect around fire cells */
-static void render_apply_glow(Renderer* renderer, const World* world) {
-    /* First pass: find all fire cells and add glow */
-    for (int y = 0; y < world->height; y++) {
+/* Shared state of the overlay bands */
+typedef struct {
+    Renderer* renderer;
+    const World* world;
+} RenderBand;
+
+/* Last frame row of the target that shows the world */
+static inline int render_target_end(const Renderer* renderer, const World* world) {
+    return MIN(renderer->target.y1, world->height);
+}
+
+/* Bands covering the target rows that show the world */
+static int render_band_count(const Renderer* renderer, const World* world) {
+    int rows = render_target_end(renderer, world) - renderer->target.y0;
+    return (rows + RENDER_BAND_ROWS - 1) / RENDER_BAND_ROWS;
+}
+
+/* Band: tint cells updated this tick yellow */
+static void render_updated_band(void* ctx, int band_index, int worker) {
+    RenderBand* band = ctx;
+    Renderer* renderer = band->renderer;
+    const World* world = band->world;
+    int y0 = renderer->target.y0 + band_index * RENDER_BAND_ROWS;
+    int y1 = MIN(y0 + RENDER_BAND_ROWS, render_target_end(renderer, world));
+    (void)worker;
+    
+    for (int y = y0; y < y1; y++) {
         for (int x = 0; x < world->width; x++) {
-            MaterialID mat = world_get_mat(world, x, y);
-            if (mat != MAT_FIRE) continue;
-            
-            /* Get fire intensity based on lifetime (younger = brighter) */
-            int lifetime = world->lifetime[IDX(x, y)];
-            int intensity = GLOW_INTENSITY - (lifetime / 4);
-            if (intensity < 10) intensity = 10;
-            
-            /* Apply glow to surrounding pixels */
-            for (int dy = -GLOW_RADIUS; dy <= GLOW_RADIUS; dy++) {
-                for (int dx = -GLOW_RADIUS; dx <= GLOW_RADIUS; dx++) {
-                    if (dx == 0 && dy == 0) continue;
-                    
-                    int nx = x + dx;
-                    int ny = y + dy;
-                    if (!IN_BOUNDS(nx, ny)) continue;
-                    
-                    /* Skip if target is also fire */
-                    if (world_get_mat(world, nx, ny) == MAT_FIRE) continue;
-                    
-                    int dist = abs(dx) + abs(dy);  /* Manhattan distance */
-                    int glow_amount = intensity / dist;
-                    
-                    int pix_idx = ny * renderer->width + nx;
-                    uint32_t pixel = renderer->pixels[pix_idx];
-                    
-                    /* Extract RGB */
-                    uint8_t r = (pixel >> 16) & 0xFF;
-                    uint8_t g = (pixel >> 8) & 0xFF;
-                    uint8_t b = pixel & 0xFF;
-                    
-                    /* Add orange/yellow glow */
-                    r = (uint8_t)MIN(255, r + glow_amount);
-                    g = (uint8_t)MIN(255, g + glow_amount / 2);
-                    /* b stays same for orange tint */
-                    
-                    renderer->pixels[pix_idx] = 0xFF000000 | ((uint32_t)r << 16) | ((uint32_t)g << 8) | b;
-                }
+            if (world_has_flag(world, x, y, FLAG_UPDATED)) {
+                render_target_row(&renderer->target, y)[x] = 0xFFFFFF00;
             }
         }
     }
 }
 
+/* Band: blend the temperature heatmap over the frame */
+static void render_temperature_band(void* ctx, int band_index, int worker) {
+    RenderBand* band = ctx;
+    Renderer* renderer = band->renderer;
+    const World* world = band->world;
+    int y0 = renderer->target.y0 + band_index * RENDER_BAND_ROWS;
+    int y1 = MIN(y0 + RENDER_BAND_ROWS, render_target_end(renderer, world));
+    (void)worker;
+    
+    for (int y = y0; y < y1; y++) {
+        kernels.heat_blend(render_target_row(&renderer->target, y), &world->temp[IDX(0, y)],
+                           world->width, heat_lut);
+    }
+}
+
 void render_overlay(Renderer* renderer, const World* world) {
-    /* Always apply glow effect for fire (subtle, not debug) */
-    render_apply_glow(renderer, world);
+    /* Debug overlays draw over the whole composed frame: render_world
+     * redraws all of it while one is shown, and once more after it is
+     * hidden */
+    if (!render_overlay_covers_frame(renderer->overlay_mode)) return;
     
+    /* Per-cell overlays are not shown when zoomed out to mip levels */
+    if (renderer->view_active && renderer->view_level > 0) return;
+    renderer->full_redraw = true;
+    if (!renderer->target.pixels) return;
+    
+    const RenderTarget* target = &renderer->target;
+    RenderBand band = { renderer, world };
     switch (renderer->overlay_mode) {
         case OVERLAY_CHUNKS:
             /* Draw chunk boundaries and highlight active chunks */
-            for (int cy = 0; cy < CHUNKS_Y; cy++) {
-                for (int cx = 0; cx < CHUNKS_X; cx++) {
+            for (int cy = 0; cy < world->chunks_y; cy++) {
+                for (int cx = 0; cx < world->chunks_x; cx++) {
                     bool active = world_is_chunk_active(world, cx, cy);
                     
-                    /* Draw chunk boundary */
-                    int x0 = cx * CHUNK_SIZE;
-                    int y0 = cy * CHUNK_SIZE;
-                    int x1 = MIN(x0 + CHUNK_SIZE, renderer->width);
-                    int y1 = MIN(y0 + CHUNK_SIZE, renderer->height);
+                    /* Draw chunk boundary (within the target rows) */
+                    int x0 = cx * world->chunk_size;
+                    int top = cy * world->chunk_size;
+                    int y0 = MAX(top, target->y0);
+                    int x1 = MIN(x0 + world->chunk_size, world->width);
+                    int y1 = MIN(top + world->chunk_size, render_target_end(renderer, world));
+                    if (y0 >= y1) continue;
                     
                     /* Tint active chunks green */
                     if (active) {
                         for (int y = y0; y < y1; y++) {
+                            uint32_t* row = render_target_row(target, y);
                             for (int x = x0; x < x1; x++) {
-                                int idx = y * renderer->width + x;
-                                uint32_t pixel = renderer->pixels[idx];
+                                uint32_t pixel = row[x];
                                 uint8_t r = (pixel >> 16) & 0xFF;
                                 uint8_t g = (pixel >> 8) & 0xFF;
                                 uint8_t b = pixel & 0xFF;
                                 
                                 /* Add green tint */
                                 g = (uint8_t)MIN(255, g + 40);
-                                renderer->pixels[idx] = 0xFF000000 | (r << 16) | (g << 8) | b;
+                                row[x] = 0xFF000000 | (r << 16) | (g << 8) | b;
                             }
                         }
                     }
                     
                     /* Draw boundary lines (red) */
                     for (int x = x0; x < x1; x++) {
-                        if (y0 < renderer->height) {
-                            renderer->pixels[y0 * renderer->width + x] = 0xFFFF0000;
+                        if (top == y0) {
+                            render_target_row(target, y0)[x] = 0xFFFF0000;
                         }
                     }
                     for (int y = y0; y < y1; y++) {
-                        if (x0 < renderer->width) {
-                            renderer->pixels[y * renderer->width + x0] = 0xFFFF0000;
+                        if (x0 < world->width) {
+                            render_target_row(target, y)[x0] = 0xFFFF0000;
                         }
                     }
                 }
@@ -262,77 +1056,14 @@ void render_overlay(Renderer* renderer, const World* world) {
             
         case OVERLAY_UPDATED:
             /* Highlight cells updated this tick */
-            for (int y = 0; y < world->height; y++) {
-                for (int x = 0; x < world->width; x++) {
-                    if (world_has_flag(world, x, y, FLAG_UPDATED)) {
-                        int idx = y * renderer->width + x;
-                        /* Tint yellow */
-                        renderer->pixels[idx] = 0xFFFFFF00;
-                    }
-                }
-            }
+            render_parallel_for(renderer, render_band_count(renderer, world),
+                                render_updated_band, &band);
             break;
             
         case OVERLAY_TEMPERATURE:
             /* Temperature heatmap overlay */
-            for (int y = 0; y < world->height; y++) {
-                for (int x = 0; x < world->width; x++) {
-                    int idx = y * renderer->width + x;
-                    float temp = world->temp[IDX(x, y)];
-                    
-                    /* Map temperature to color:
-                     * < 0: Blue (cold)
-                     * 0-20: Green-ish (ambient)
-                     * 20-100: Yellow (warm)
-                     * > 100: Red-Orange (hot)
-                     * > 500: White (very hot)
-                     */
-                    uint8_t r, g, b;
-                    
-                    if (temp < 0) {
-                        /* Cold: blue */
-                        float cold = CLAMP(-temp / 50.0f, 0.0f, 1.0f);
-                        r = 0;
-                        g = (uint8_t)(100 * (1 - cold));
-                        b = (uint8_t)(150 + 105 * cold);
-                    } else if (temp < 20) {
-                        /* Ambient: dark green */
-                        r = 0;
-                        g = (uint8_t)(50 + temp * 2);
-                        b = 0;
-                    } else if (temp < 100) {
-                        /* Warm: yellow */
-                        float warm = (temp - 20) / 80.0f;
-                        r = (uint8_t)(255 * warm);
-                        g = (uint8_t)(100 + 155 * warm);
-                        b = 0;
-                    } else if (temp < 500) {
-                        /* Hot: orange to red */
-                        float hot = (temp - 100) / 400.0f;
-                        r = 255;
-                        g = (uint8_t)(200 * (1 - hot));
-                        b = 0;
-                    } else {
-                        /* Very hot: white */
-                        float vhot = CLAMP((temp - 500) / 500.0f, 0.0f, 1.0f);
-                        r = 255;
-                        g = (uint8_t)(200 + 55 * vhot);
-                        b = (uint8_t)(200 * vhot);
-                    }
-                    
-                    /* Blend with existing pixel (50% overlay) */
-                    uint32_t pixel = renderer->pixels[idx];
-                    uint8_t orig_r = (pixel >> 16) & 0xFF;
-                    uint8_t orig_g = (pixel >> 8) & 0xFF;
-                    uint8_t orig_b = pixel & 0xFF;
-                    
-                    r = (uint8_t)((r + orig_r) / 2);
-                    g = (uint8_t)((g + orig_g) / 2);
-                    b = (uint8_t)((b + orig_b) / 2);
-                    
-                    renderer->pixels[idx] = 0xFF000000 | ((uint32_t)r << 16) | ((uint32_t)g << 8) | b;
-                }
-            }
+            render_parallel_for(renderer, render_band_count(renderer, world),
+                                render_temperature_band, &band);
             break;
             
         default:
@@ -360,18 +1091,125 @@ void render_ui(Renderer* renderer, const World* world, double tick_time_ms, uint
      */
 }
 
-void render_end_frame(Renderer* renderer) {
-    /* Update texture from pixel buffer */
-    SDL_UpdateTexture(
-        renderer->texture, NULL,
-        renderer->pixels,
-        renderer->width * sizeof(uint32_t)
-    );
+/* Band: resample RENDER_BAND_ROWS frame rows from the canvas or the mip
+ * level of the view (view_cols maps columns) */
+static void render_view_band(void* ctx, int band_index, int worker) {
+    Renderer* renderer = ctx;
+    const RenderCamera* cam = &renderer->camera;
+    int level = renderer->view_level;
+    int step = render_zoom_step(cam->zoom);
+    int lw = render_mip_size(renderer->world_width, level);
+    int lh = render_mip_size(renderer->world_height, level);
+    int y0 = band_index * RENDER_BAND_ROWS;
+    int y1 = MIN(y0 + RENDER_BAND_ROWS, renderer->height);
+    const int* cols = renderer->view_cols;
+    (void)worker;
+    
+    for (int y = y0; y < y1; y++) {
+        uint32_t* row = render_target_row(&renderer->target, y);
+        int ty = ((cam->y + y * step) >> RENDER_SUBCELL_SHIFT) >> level;
+        if (ty < 0 || ty >= lh) {
+            kernels.fill_u32(row, (size_t)renderer->width, 0xFF000000);
+            continue;
+        }
+        if (level == 0) {
+            const uint32_t* src = &renderer->canvas[(size_t)ty * lw];
+            for (int x = 0; x < renderer->width; x++) {
+                row[x] = cols[x] >= 0 ? src[cols[x]] : 0xFF000000;
+            }
+        } else {
+            const RenderMip* src = &renderer->mip[level][(size_t)ty * lw];
+            for (int x = 0; x < renderer->width; x++) {
+                row[x] = cols[x] >= 0 ? src[cols[x]].color : 0xFF000000;
+            }
+        }
+    }
+}
+
+/* Resample the whole frame from the view; cost is per frame pixel */
+static void render_draw_view(Renderer* renderer) {
+    const RenderCamera* cam = &renderer->camera;
+    int level = renderer->view_level;
+    int step = render_zoom_step(cam->zoom);
+    int lw = render_mip_size(renderer->world_width, level);
+    
+    if (!renderer->zero_copy) {
+        renderer->target = (RenderTarget){ renderer->pixels, renderer->width, 0, renderer->height };
+    } else if (!render_lock_rows(renderer, 0, renderer->height)) {
+        return;
+    }
+    
+    for (int x = 0; x < renderer->width; x++) {
+        int tx = ((cam->x + x * step) >> RENDER_SUBCELL_SHIFT) >> level;
+        renderer->view_cols[x] = (tx >= 0 && tx < lw) ? tx : -1;
+    }
+    render_parallel_for(renderer, (renderer->height + RENDER_BAND_ROWS - 1) / RENDER_BAND_ROWS,
+                        render_view_band, renderer);
+    renderer->view_dirty = false;
+    renderer->upload_all = true;
+}
+
+bool render_end_frame(Renderer* renderer) {
+    int pitch = renderer->width * (int)sizeof(uint32_t);
+    
+    if (renderer->view_active) {
+        /* The canvas was the target so far; the frame is resampled here */
+        renderer->target.pixels = NULL;
+        if (renderer->view_dirty && renderer->canvas) render_draw_view(renderer);
+    }
+    if (renderer->headless) {
+        /* The frame stays in pixels for the caller to read or save */
+        return renderer->upload_all || renderer->dirty_count > 0;
+    }
+    if (renderer->zero_copy) {
+        /* The frame was drawn into the texture; unlocking uploads it */
+        if (!renderer->target.pixels) return false;
+        SDL_UnlockTexture(renderer->texture);
+        renderer->target.pixels = NULL;
+    } else if (renderer->upload_all) {
+        /* Update texture from the changed parts of the pixel buffer */
+        SDL_UpdateTexture(renderer->texture, NULL, renderer->pixels, pitch);
+    } else if (renderer->dirty_count > 0) {
+        for (int i = 0; i < renderer->dirty_count; i++) {
+            const SDL_Rect* r = &renderer->dirty[i];
+            SDL_UpdateTexture(renderer->texture, r,
+                              &renderer->pixels[r->y * renderer->width + r->x], pitch);
+        }
+    } else {
+        /* Nothing changed: keep the last presented frame */
+        return false;
+    }
     
     /* Clear and draw */
     SDL_RenderClear(renderer->renderer);
     SDL_RenderCopy(renderer->renderer, renderer->texture, NULL, NULL);
     SDL_RenderPresent(renderer->renderer);
+    return true;
+}
+
+bool render_keep_frame(Renderer* renderer) {
+    if (!renderer->zero_copy) return true;
+    
+    size_t count = (size_t)renderer->width * renderer->height;
+    renderer->pixels = malloc(count * sizeof(uint32_t));
+    if (!renderer->pixels) return false;
+    
+    /* The locked texture was never readable, so start from a full redraw */
+    kernels.fill_u32(renderer->pixels, count, 0xFF000000);
+    renderer->zero_copy = false;
+    renderer->full_redraw = true;
+    return true;
+}
+
+bool render_save_frame(const Renderer* renderer, const char* path, ImageFormat format) {
+    if (!renderer->pixels) return false;
+    return image_write(path, format, renderer->pixels, renderer->width, renderer->height,
+                       renderer->width);
+}
+
+void render_invalidate(Renderer* renderer) {
+    renderer->full_redraw = true;
+    renderer->view_dirty = true;
 }
 
 /* =============================================================================
@@ -0,0 +1,281 @@
+/*
+ * sim_thread.c - Simulation thread implementation
+ *
+ * Triple buffer: the simulation thread fills its back slot, then swaps it
+ * with the shared slot and marks it fresh; the render thread swaps its
+ * front slot with the shared one only when it is fresh. Each side owns one
+ * slot at any time, so publishing and acquiring never block.
+ */
+#include "engine/sim_thread.h"
+#include "core/utils.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define SNAPSHOT_FRESH 4          /* Shared slot holds an unread snapshot */
+#define SIM_IDLE_WAIT_S 0.1       /* Wake-up period while paused */
+#define SIM_MAX_DELTA_S 0.1       /* Cap on real time per update */
+
+struct SimThread {
+    Simulation* sim;
+    World* world;
+    pthread_t thread;
+
+    /* Triple buffer */
+    WorldSnapshot slots[3];
+    _Atomic int shared;       /* Slot index | SNAPSHOT_FRESH */
+    int back;                 /* Simulation thread's slot */
+    int front;                /* Render thread's slot */
+
+    /* Command queue (guarded by lock) */
+    pthread_mutex_t lock;
+    pthread_cond_t wake;      /* Commands queued or stop requested */
+    pthread_cond_t space;     /* Commands drained */
+    SimCommand queue[SIM_COMMAND_MAX];
+    int queue_head;
+    int queue_count;
+    bool stop;
+};
+
+/* =============================================================================
+ * Snapshots
+ * ============================================================================= */
+
+static void snapshot_free(WorldSnapshot* snap) {
+    free(snap->world.mat);
+    free(snap->world.flags);
+    free(snap->world.color_variant);
+    free(snap->world.temp);
+    free(snap->world.lifetime);
+    free(snap->world.chunk_active);
+    free(snap->world.chunk_version);
+}
+
+static bool snapshot_alloc(WorldSnapshot* snap, const World* world) {
+    size_t grid_size = (size_t)world->width * world->height;
+
+    memset(snap, 0, sizeof(*snap));
+    snap->world.mat = calloc(grid_size, sizeof(MaterialID));
+    snap->world.flags = calloc(grid_size, sizeof(CellFlags));
+    snap->world.color_variant = calloc(grid_size, sizeof(uint8_t));
+    snap->world.temp = calloc(grid_size, sizeof(float));
+    snap->world.lifetime = calloc(grid_size, sizeof(uint8_t));
+    snap->world.chunk_active = calloc(CHUNK_COUNT_MAX, sizeof(bool));
+    snap->world.chunk_version = calloc(CHUNK_COUNT_MAX, sizeof(uint32_t));
+    if (!snap->world.mat || !snap->world.flags || !snap->world.color_variant ||
+        !snap->world.temp || !snap->world.lifetime || !snap->world.chunk_active ||
+        !snap->world.chunk_version) {
+        snapshot_free(snap);
+        return false;
+    }
+    return true;
+}
+
+/* Copy the rendered planes, chunk tables and statistics of a whole tick */
+static void snapshot_fill(WorldSnapshot* snap, const World* world, const Simulation* sim) {
+    size_t grid_size = (size_t)world->width * world->height;
+    World* dst = &snap->world;
+
+    memcpy(dst->mat, world->mat, grid_size * sizeof(MaterialID));
+    memcpy(dst->flags, world->flags, grid_size * sizeof(CellFlags));
+    memcpy(dst->color_variant, world->color_variant, grid_size * sizeof(uint8_t));
+    memcpy(dst->temp, world->temp, grid_size * sizeof(float));
+    memcpy(dst->lifetime, world->lifetime, grid_size * sizeof(uint8_t));
+    memcpy(dst->chunk_active, world->chunk_active, (size_t)world->chunk_count * sizeof(bool));
+    memcpy(dst->chunk_version, world->chunk_version, (size_t)world->chunk_count * sizeof(uint32_t));
+
+    dst->generation = world->generation;
+    dst->width = world->width;
+    dst->height = world->height;
+    dst->chunk_size = world->chunk_size;
+    dst->chunk_shift = world->chunk_shift;
+    dst->chunks_x = world->chunks_x;
+    dst->chunks_y = world->chunks_y;
+    dst->chunk_count = world->chunk_count;
+    dst->cells_updated = world->cells_updated;
+    dst->active_chunks = world->active_chunks;
+
+    snap->tick_count = sim->tick_count;
+    snap->tick_time_ms = sim->tick_time_ms;
+    snap->paused = sim->paused;
+    memcpy(snap->stage_time_us, sim->stages->time_us, sizeof(snap->stage_time_us));
+    snap->profile_total_us = sim->profile_total_us;
+}
+
+/* Simulation thread: fill the back slot and hand it over */
+static void snapshot_publish(SimThread* thread) {
+    snapshot_fill(&thread->slots[thread->back], thread->world, thread->sim);
+    int prev = atomic_exchange_explicit(&thread->shared, thread->back | SNAPSHOT_FRESH,
+                                        memory_order_acq_rel);
+    thread->back = prev & ~SNAPSHOT_FRESH;
+}
+
+const WorldSnapshot* sim_thread_acquire(SimThread* thread) {
+    if (atomic_load_explicit(&thread->shared, memory_order_relaxed) & SNAPSHOT_FRESH) {
+        int prev = atomic_exchange_explicit(&thread->shared, thread->front, memory_order_acq_rel);
+        thread->front = prev & ~SNAPSHOT_FRESH;
+    }
+    return &thread->slots[thread->front];
+}
+
+/* =============================================================================
+ * Commands
+ * ============================================================================= */
+
+void sim_thread_send(SimThread* thread, const SimCommand* command) {
+    pthread_mutex_lock(&thread->lock);
+    while (thread->queue_count == SIM_COMMAND_MAX && !thread->stop) {
+        pthread_cond_wait(&thread->space, &thread->lock);
+    }
+    if (!thread->stop) {
+        int tail = (thread->queue_head + thread->queue_count) % SIM_COMMAND_MAX;
+        thread->queue[tail] = *command;
+        thread->queue_count++;
+        pthread_cond_signal(&thread->wake);
+    }
+    pthread_mutex_unlock(&thread->lock);
+}
+
+static void sim_thread_apply(SimThread* thread, const SimCommand* command) {
+    switch (command->type) {
+        case SIM_CMD_PAINT:
+            world_paint_line(thread->world, command->x0, command->y0, command->x1, command->y1,
+                             command->radius, command->mat);
+            break;
+        case SIM_CMD_CLEAR:
+            world_clear(thread->world);
+            break;
+        case SIM_CMD_TOGGLE_PAUSE:
+            simulation_toggle_pause(thread->sim);
+            break;
+        case SIM_CMD_STEP:
+            simulation_step_once(thread->sim);
+            break;
+    }
+}
+
+/* =============================================================================
+ * Thread Loop
+ * ============================================================================= */
+
+static double sim_thread_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+/* Wait on the wake condition until a command arrives, stop is requested or
+ * the given monotonic time passes (lock held) */
+static void sim_thread_wait(SimThread* thread, double until) {
+    struct timespec deadline;
+    double whole = (double)(time_t)until;
+    deadline.tv_sec = (time_t)until;
+    deadline.tv_nsec = (long)((until - whole) * 1e9);
+    while (thread->queue_count == 0 && !thread->stop && sim_thread_now() < until) {
+        pthread_cond_timedwait(&thread->wake, &thread->lock, &deadline);
+    }
+}
+
+static void* sim_thread_main(void* arg) {
+    SimThread* thread = arg;
+    Simulation* sim = thread->sim;
+    SimCommand batch[SIM_COMMAND_MAX];
+    double last = sim_thread_now();
+
+    pthread_mutex_lock(&thread->lock);
+    while (!thread->stop) {
+        /* Take every queued command, then work without the lock */
+        int count = thread->queue_count;
+        for (int i = 0; i < count; i++) {
+            batch[i] = thread->queue[(thread->queue_head + i) % SIM_COMMAND_MAX];
+        }
+        thread->queue_head = (thread->queue_head + count) % SIM_COMMAND_MAX;
+        thread->queue_count = 0;
+        if (count > 0) pthread_cond_broadcast(&thread->space);
+        pthread_mutex_unlock(&thread->lock);
+
+        for (int i = 0; i < count; i++) {
+            sim_thread_apply(thread, &batch[i]);
+        }
+
+        double now = sim_thread_now();
+        uint64_t ticks = sim->tick_count;
+        bool paused = sim->paused;
+        simulation_update(sim, thread->world, MIN(now - last, SIM_MAX_DELTA_S));
+        last = now;
+        if (count > 0 || sim->tick_count != ticks || sim->paused != paused) {
+            snapshot_publish(thread);
+        }
+
+        /* Sleep until the next tick is due (or a command arrives) */
+        double wait = sim->paused ? SIM_IDLE_WAIT_S : sim->dt - sim->accumulator;
+        pthread_mutex_lock(&thread->lock);
+        sim_thread_wait(thread, now + MAX(wait, 0.0));
+    }
+    pthread_mutex_unlock(&thread->lock);
+    return NULL;
+}
+
+/* =============================================================================
+ * Lifecycle
+ * ============================================================================= */
+
+SimThread* sim_thread_start(Simulation* sim, World* world) {
+    SimThread* thread = calloc(1, sizeof(SimThread));
+    if (!thread) return NULL;
+
+    thread->sim = sim;
+    thread->world = world;
+    for (int i = 0; i < 3; i++) {
+        if (!snapshot_alloc(&thread->slots[i], world)) {
+            for (int j = 0; j < i; j++) snapshot_free(&thread->slots[j]);
+            free(thread);
+            return NULL;
+        }
+    }
+
+    /* The render thread starts on a copy of the initial world */
+    snapshot_fill(&thread->slots[0], world, sim);
+    thread->front = 0;
+    atomic_init(&thread->shared, 1);
+    thread->back = 2;
+
+    /* Tick deadlines are on the monotonic clock */
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_mutex_init(&thread->lock, NULL);
+    pthread_cond_init(&thread->wake, &attr);
+    pthread_cond_init(&thread->space, NULL);
+    pthread_condattr_destroy(&attr);
+    if (pthread_create(&thread->thread, NULL, sim_thread_main, thread) != 0) {
+        fprintf(stderr, "Failed to start simulation thread\n");
+        pthread_cond_destroy(&thread->space);
+        pthread_cond_destroy(&thread->wake);
+        pthread_mutex_destroy(&thread->lock);
+        for (int i = 0; i < 3; i++) snapshot_free(&thread->slots[i]);
+        free(thread);
+        return NULL;
+    }
+    return thread;
+}
+
+void sim_thread_stop(SimThread* thread) {
+    if (!thread) return;
+
+    pthread_mutex_lock(&thread->lock);
+    thread->stop = true;
+    pthread_cond_broadcast(&thread->wake);
+    pthread_cond_broadcast(&thread->space);
+    pthread_mutex_unlock(&thread->lock);
+    pthread_join(thread->thread, NULL);
+
+    pthread_cond_destroy(&thread->space);
+    pthread_cond_destroy(&thread->wake);
+    pthread_mutex_destroy(&thread->lock);
+    for (int i = 0; i < 3; i++) snapshot_free(&thread->slots[i]);
+    free(thread);
+}
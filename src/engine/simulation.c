@@ -2,17 +2,12 @@
  * simulation.c - Fixed timestep simulation loop implementation
  */
 #include "engine/simulation.h"
+#include "engine/stages.h"
+#include "engine/kernels.h"
 #include "core/utils.h"
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
-#include <sys/time.h>
-
-/* High-resolution timer for profiling */
-static double get_time_us(void) {
-    struct timeval tv;
-    gettimeofday(&tv, NULL);
-    return (double)tv.tv_sec * 1000000.0 + (double)tv.tv_usec;
-}
 
 /* Forward declarations for subsystem updates */
 void powder_update(Simulation* sim, World* world);
@@ -20,7 +15,33 @@ void fluid_update(Simulation* sim, World* world);
 void acid_update(Simulation* sim, World* world);
 void fire_update(Simulation* sim, World* world);
 void gas_update(Simulation* sim, World* world);
-void thermal_update(Simulation* sim, World* world);
+void thermal_copy_materials(Simulation* sim, World* world);
+void thermal_diffusion_update(Simulation* sim, World* world);
+void thermal_phase_update(Simulation* sim, World* world);
+void thermal_swap(Simulation* sim, World* world);
+
+/* =============================================================================
+ * Tick Stages (program order, with the world planes each one touches)
+ *
+ * Slow reactions (acid corrosion, phase changes) run every other tick on
+ * staggered phases, so at most one of them lands on any tick. Diffusion
+ * reads the materials copied at the tick start rather than mat, so it does
+ * not wait for the movers and runs alongside powder.
+ * ============================================================================= */
+
+static const StageDesc SIM_STAGES[] = {
+    { "tcopy",   thermal_copy_materials,   PLANE_MAT,                   PLANE_HEAT_MAT, 1, 0 },
+    { "powder",  powder_update,            PLANE_MOVERS,                PLANE_MOVERS, 1, 0 },
+    { "fluid",   fluid_update,             PLANE_MOVERS,                PLANE_MOVERS, 1, 0 },
+    { "fire",    fire_update,              PLANE_MOVERS,                PLANE_MOVERS, 1, 0 },
+    { "gas",     gas_update,               PLANE_MOVERS | PLANE_TEMP,   PLANE_MOVERS, 1, 0 },
+    { "acid",    acid_update,              PLANE_MOVERS,                PLANE_MOVERS, 2, STAGE_PHASE_AUTO },
+    { "diffuse", thermal_diffusion_update, PLANE_HEAT_MAT | PLANE_TEMP, PLANE_TEMP_NEXT, 1, 0 },
+    { "phase",   thermal_phase_update,     PLANE_MAT | PLANE_TEMP_NEXT, PLANE_MOVERS | PLANE_TEMP_NEXT, 2, STAGE_PHASE_AUTO },
+    { "tswap",   thermal_swap,             0,                           PLANE_TEMP | PLANE_TEMP_NEXT | PLANE_CHUNKS, 1, 0 },
+};
+
+#define SIM_STAGE_COUNT ((int)(sizeof(SIM_STAGES) / sizeof(SIM_STAGES[0])))
 
 Simulation* simulation_create(double tick_hz) {
     Simulation* sim = calloc(1, sizeof(Simulation));
@@ -40,10 +61,34 @@ Simulation* simulation_create(double tick_hz) {
     sim->paused = false;
     sim->step_once = false;
     
+    /* SIMD kernels for this CPU (PIXELSIM_ISA overrides) */
+    kernels_init();
+    
+    /* Worker pool (PIXELSIM_THREADS or one per CPU) */
+    sim->workers = workers_create(0);
+    sim->scratch = deferred_create(workers_count(sim->workers));
+    sim->stages = stage_graph_create();
+    if (!sim->workers || !sim->scratch || !sim->stages) {
+        simulation_destroy(sim);
+        return NULL;
+    }
+    
+    for (int i = 0; i < SIM_STAGE_COUNT; i++) {
+        simulation_register_stage(sim, &SIM_STAGES[i]);
+    }
+    
     return sim;
 }
 
+int simulation_register_stage(Simulation* sim, const StageDesc* desc) {
+    return stage_graph_add(sim->stages, desc);
+}
+
 void simulation_destroy(Simulation* sim) {
+    if (!sim) return;
+    stage_graph_destroy(sim->stages);
+    deferred_destroy(sim->scratch, workers_count(sim->workers));
+    workers_destroy(sim->workers);
     free(sim);
 }
 
@@ -91,41 +136,16 @@ void simulation_tick(Simulation* sim, World* world) {
     /* Reset stats */
     world->cells_updated = 0;
     
-    double t0, t1;
-    
-    /* 2. Powder step (sand/soil) - falls down */
-    t0 = get_time_us();
-    powder_update(sim, world);
-    t1 = get_time_us();
-    sim->profile_powder_us = t1 - t0;
-    
-    /* 3. Fluid step (water) - falls and spreads */
-    t0 = get_time_us();
-    fluid_update(sim, world);
-    t1 = get_time_us();
-    sim->profile_fluid_us = t1 - t0;
-    
-    /* 4. Fire step - burns and spreads */
-    t0 = get_time_us();
-    fire_update(sim, world);
-    t1 = get_time_us();
-    sim->profile_fire_us = t1 - t0;
-    
-    /* 5. Gas step (smoke, steam) - rises up */
-    t0 = get_time_us();
-    gas_update(sim, world);
-    t1 = get_time_us();
-    sim->profile_gas_us = t1 - t0;
-    
-    /* 6. Acid step - corrosion */
-    acid_update(sim, world);
+    /* 2-7. Powder, fluid, fire, gas, acid, thermal: the stage graph orders
+     * the stages due this tick by declared plane access. Diffusion runs in
+     * one group with powder; the other built-in stages run in program order. */
+    uint32_t enabled = stage_graph_due(sim->stages, sim->tick_count);
+    stage_graph_run(sim->stages, sim, world, enabled);
     
-    /* 7. Thermal step - heat diffusion and phase changes */
-    thermal_update(sim, world);
-    
-    /* Calculate total */
-    sim->profile_total_us = sim->profile_powder_us + sim->profile_fluid_us + 
-                            sim->profile_fire_us + sim->profile_gas_us;
+    sim->profile_total_us = 0.0;
+    for (int i = 0; i < sim->stages->count; i++) {
+        sim->profile_total_us += sim->stages->time_us[i];
+    }
     
     /* 12. Update chunk activation */
     world_update_chunk_activation(world);
@@ -147,6 +167,10 @@ void simulation_step_once(Simulation* sim) {
 }
 
 uint32_t simulation_rand(Simulation* sim) {
+    /* Parallel passes draw from the band's own stream */
+    if (thread_scratch) {
+        return xorshift32(&thread_scratch->rng);
+    }
     return xorshift32(&sim->tick_seed);
 }
 
@@ -160,6 +184,47 @@ int simulation_rand_range(Simulation* sim, int min, int max) {
     return min + (int)(simulation_rand(sim) % range);
 }
 
+bool simulation_set_threads(Simulation* sim, int thread_count) {
+    WorkerPool* workers = workers_create(thread_count);
+    ThreadScratch* scratch = workers ? deferred_create(workers_count(workers)) : NULL;
+    if (!scratch) {
+        workers_destroy(workers);
+        return false;
+    }
+    
+    deferred_destroy(sim->scratch, workers_count(sim->workers));
+    workers_destroy(sim->workers);
+    sim->workers = workers;
+    sim->scratch = scratch;
+    return true;
+}
+
+void simulation_set_update_mode(Simulation* sim, MaterialState state, UpdateMode mode) {
+    if (state >= STATE_COUNT || mode >= UPDATE_MODE_COUNT) return;
+    sim->update_mode[state] = mode;
+}
+
+static const char* const UPDATE_MODE_NAMES[UPDATE_MODE_COUNT] = {
+    [UPDATE_MODE_SWEEP] = "sweep",
+    [UPDATE_MODE_MARGOLUS] = "margolus",
+    [UPDATE_MODE_INTENT] = "intent",
+    [UPDATE_MODE_TILED] = "tiled",
+};
+
+bool simulation_parse_update_mode(const char* name, UpdateMode* mode) {
+    for (int i = 0; i < UPDATE_MODE_COUNT; i++) {
+        if (strcmp(name, UPDATE_MODE_NAMES[i]) == 0) {
+            *mode = (UpdateMode)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* simulation_update_mode_name(UpdateMode mode) {
+    return (mode < UPDATE_MODE_COUNT) ? UPDATE_MODE_NAMES[mode] : "unknown";
+}
+
 void simulation_reset(Simulation* sim) {
     sim->accumulator = 0.0;
     sim->tick_count = 0;
@@ -167,4 +232,7 @@ void simulation_reset(Simulation* sim) {
     sim->tick_seed = xorshift32(&sim->rng_state);
     sim->paused = false;
     sim->step_once = false;
+    
+    /* Rate-divided stages restart their elapsed-tick count */
+    memset(sim->stages->last_tick, 0, sizeof(sim->stages->last_tick));
 }
@@ -0,0 +1,202 @@
+/*
+ * stages.c - Simulation stage graph implementation
+ */
+#include "engine/stages.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* Ticks covered by the stage running on this thread */
+static _Thread_local int stage_elapsed_ticks = 1;
+
+/* Monotonic timer for per-stage profiling */
+static double stage_time_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1000000.0 + (double)ts.tv_nsec / 1000.0;
+}
+
+/* =============================================================================
+ * Graph Construction
+ * ============================================================================= */
+
+bool stage_conflicts(const StageDesc* a, const StageDesc* b) {
+    return (a->writes & (b->reads | b->writes)) != 0 ||
+           (b->writes & a->reads) != 0;
+}
+
+StageGraph* stage_graph_create(void) {
+    return calloc(1, sizeof(StageGraph));
+}
+
+void stage_graph_destroy(StageGraph* graph) {
+    free(graph);
+}
+
+static int gcd(int a, int b) {
+    while (b) {
+        int t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+/* Phase for a stage of the given rate that coincides with the fewest other
+ * low-rate stages. Stages i and j share a tick iff their phases agree
+ * modulo gcd(rate_i, rate_j). */
+static int stage_pick_phase(const StageGraph* graph, int self, int rate) {
+    int best = 0, best_hits = -1;
+
+    for (int p = 0; p < rate; p++) {
+        int hits = 0;
+        for (int j = 0; j < graph->count; j++) {
+            const StageDesc* other = &graph->desc[j];
+            if (j == self || other->rate <= 1) continue;
+            if ((p - other->phase) % gcd(rate, other->rate) == 0) hits++;
+        }
+        if (best_hits < 0 || hits < best_hits) {
+            best = p;
+            best_hits = hits;
+        }
+    }
+    return best;
+}
+
+void stage_graph_set_rate(StageGraph* graph, int stage, int rate, int phase) {
+    if (stage < 0 || stage >= graph->count) return;
+    StageDesc* desc = &graph->desc[stage];
+
+    desc->rate = MAX(rate, 1);
+    desc->phase = 0;   /* Excluded from its own stagger search below */
+    if (desc->rate == 1) return;
+
+    desc->phase = (phase == STAGE_PHASE_AUTO)
+                ? stage_pick_phase(graph, stage, desc->rate)
+                : phase % desc->rate;
+}
+
+int stage_graph_add(StageGraph* graph, const StageDesc* desc) {
+    if (graph->count >= STAGE_MAX) return -1;
+    int index = graph->count++;
+
+    graph->desc[index] = *desc;
+    graph->time_us[index] = 0.0;
+    graph->last_tick[index] = 0;
+    stage_graph_set_rate(graph, index, desc->rate, desc->phase);
+    return index;
+}
+
+int stage_graph_find(const StageGraph* graph, const char* name) {
+    for (int i = 0; i < graph->count; i++) {
+        if (strcmp(graph->desc[i].name, name) == 0) return i;
+    }
+    return -1;
+}
+
+uint32_t stage_graph_due(const StageGraph* graph, uint64_t tick) {
+    uint32_t due = 0;
+    for (int i = 0; i < graph->count; i++) {
+        const StageDesc* desc = &graph->desc[i];
+        if (desc->rate <= 1 || tick % (uint64_t)desc->rate == (uint64_t)desc->phase) {
+            due |= 1u << i;
+        }
+    }
+    return due;
+}
+
+void stage_graph_build(StageGraph* graph, uint32_t enabled) {
+    for (int j = 0; j < graph->count; j++) {
+        graph->deps[j] = 0;
+        if (!(enabled & (1u << j))) continue;
+
+        /* Program order decides the direction of every conflict edge */
+        for (int i = 0; i < j; i++) {
+            if (!(enabled & (1u << i))) continue;
+            if (stage_conflicts(&graph->desc[i], &graph->desc[j])) {
+                graph->deps[j] |= 1u << i;
+            }
+        }
+    }
+}
+
+/* =============================================================================
+ * Execution
+ * ============================================================================= */
+
+typedef struct {
+    StageGraph* graph;
+    Simulation* sim;
+    World* world;
+    int stages[STAGE_MAX];      /* Stage indices in the current group */
+} StageGroup;
+
+static void stage_run_one(StageGraph* graph, Simulation* sim, World* world, int stage) {
+    double t0 = stage_time_us();
+    stage_elapsed_ticks = graph->elapsed[stage];
+    graph->desc[stage].func(sim, world);
+    stage_elapsed_ticks = 1;
+    graph->time_us[stage] = stage_time_us() - t0;
+}
+
+static void stage_group_task(void* ctx_ptr, int item, int worker) {
+    (void)worker;
+    StageGroup* group = (StageGroup*)ctx_ptr;
+    stage_run_one(group->graph, group->sim, group->world, group->stages[item]);
+}
+
+void stage_graph_run(StageGraph* graph, Simulation* sim, World* world, uint32_t enabled) {
+    stage_graph_build(graph, enabled);
+
+    StageGroup group = { .graph = graph, .sim = sim, .world = world };
+    uint32_t pending = enabled & ((graph->count < 32) ? ((1u << graph->count) - 1) : ~0u);
+    graph->groups = 0;
+
+    /* Ticks each due stage stands in for (its rate on the first run) */
+    for (int i = 0; i < graph->count; i++) {
+        if (!(pending & (1u << i))) {
+            graph->time_us[i] = 0.0;
+            continue;
+        }
+        uint64_t last = graph->last_tick[i];
+        graph->elapsed[i] = last ? (int)MIN(sim->tick_count + 1 - last, (uint64_t)255)
+                                 : MAX(graph->desc[i].rate, 1);
+        graph->last_tick[i] = sim->tick_count + 1;
+    }
+
+    while (pending) {
+        /* Ready: every dependency already ran */
+        int ready = 0;
+        for (int i = 0; i < graph->count; i++) {
+            if ((pending & (1u << i)) && !(graph->deps[i] & pending)) {
+                group.stages[ready++] = i;
+            }
+        }
+
+        if (ready == 1) {
+            stage_run_one(graph, sim, world, group.stages[0]);
+        } else {
+            workers_parallel_for(sim->workers, ready, stage_group_task, &group);
+        }
+
+        for (int k = 0; k < ready; k++) {
+            pending &= ~(1u << group.stages[k]);
+        }
+        graph->groups++;
+    }
+}
+
+/* =============================================================================
+ * Rate Scaling
+ * ============================================================================= */
+
+int stage_current_elapsed(void) {
+    return stage_elapsed_ticks;
+}
+
+float stage_scale_chance(float p, int k) {
+    if (k <= 1) return p;
+    if (p >= 1.0f) return 1.0f;
+    return 1.0f - powf(1.0f - p, (float)k);
+}
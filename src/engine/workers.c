@@ -0,0 +1,515 @@
+/*
+ * workers.c - Worker thread pool implementation (pthreads)
+ *
+ * Scheduling: every job is dealt into one deque per worker before the
+ * workers wake. A worker pops from the front of its own deque and, once it
+ * runs dry, steals from the back of the others. Deques are never pushed to
+ * while a job runs, so each one is a single atomic (head, tail) word that
+ * both the owner and thieves update with compare-and-swap.
+ *
+ * Placement: workers are spread over the NUMA nodes in contiguous runs
+ * (worker w lives on node w * nodes / count) and, when pinned, each one is
+ * bound to a single CPU of its node. Worker 0 is the thread issuing a job,
+ * so its first job binds it and it stays bound for the jobs that follow.
+ * Creating a pool or calling workers_release_caller() gives it its own
+ * CPU mask back, so pools and threads it creates never inherit it. Items
+ * have a home worker proportional to their index, matching the bands each
+ * worker first-touched, and costed jobs only deal an item to workers on
+ * their home node.
+ */
+#define _GNU_SOURCE
+#include "engine/workers.h"
+#include "engine/numa.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#define WORKERS_SORT_INSERTION_MAX 32   /* Costed jobs up to this size skip qsort */
+
+typedef struct {
+    WorkerPool* pool;
+    int worker;
+} WorkerStart;
+
+/* Packed (head << 32) | tail into the pool's order array, one cache line each */
+typedef struct {
+    _Atomic uint64_t range;
+    char pad[64 - sizeof(uint64_t)];
+} WorkerDeque;
+
+typedef struct {
+    uint32_t cost;
+    int item;
+} WorkerItemCost;
+
+struct WorkerPool {
+    int count;                  /* Workers including the caller */
+    pthread_t threads[WORKERS_MAX];
+    WorkerStart starts[WORKERS_MAX];
+    WorkerDeque deques[WORKERS_MAX];
+    
+    /* Placement */
+    int cpu[WORKERS_MAX];       /* Pinned CPU, -1 when not pinned */
+    int node[WORKERS_MAX];      /* Index of the worker's NUMA node */
+    int node_count;             /* Nodes spanned by the pool */
+    int node_id[WORKERS_MAX];   /* System number of each spanned node */
+
+    pthread_mutex_t lock;
+    pthread_cond_t wake;        /* Signalled when a new job is published */
+    pthread_cond_t done;        /* Signalled when the last worker finishes */
+
+    /* Current job (guarded by lock) */
+    uint64_t generation;
+    WorkerTaskFunc func;
+    void* ctx;
+    int* order;                 /* Item ids, grouped by owning deque */
+    WorkerItemCost* items;      /* Costed dealing scratch, order_capacity each */
+    int* owner;
+    int order_capacity;
+    int pending;                /* Background workers still running the job */
+    bool broadcast;             /* Run func once per worker instead of items */
+    bool shutdown;
+};
+
+/* Tasks running on this thread; parallel loops issued from a task run inline */
+static _Thread_local int workers_nesting = 0;
+
+/* =============================================================================
+ * Deques
+ * ============================================================================= */
+
+static inline uint64_t deque_pack(uint32_t head, uint32_t tail) {
+    return ((uint64_t)head << 32) | tail;
+}
+
+/* Owner side: take the next item from the front */
+static bool deque_pop(WorkerDeque* deque, int* pos) {
+    uint64_t range = atomic_load(&deque->range);
+    for (;;) {
+        uint32_t head = (uint32_t)(range >> 32), tail = (uint32_t)range;
+        if (head >= tail) return false;
+        if (atomic_compare_exchange_weak(&deque->range, &range, deque_pack(head + 1, tail))) {
+            *pos = (int)head;
+            return true;
+        }
+    }
+}
+
+/* Thief side: take the last (cheapest) item from the back */
+static bool deque_steal(WorkerDeque* deque, int* pos) {
+    uint64_t range = atomic_load(&deque->range);
+    for (;;) {
+        uint32_t head = (uint32_t)(range >> 32), tail = (uint32_t)range;
+        if (head >= tail) return false;
+        if (atomic_compare_exchange_weak(&deque->range, &range, deque_pack(head, tail - 1))) {
+            *pos = (int)(tail - 1);
+            return true;
+        }
+    }
+}
+
+/* =============================================================================
+ * Job Setup and Execution
+ * ============================================================================= */
+
+/* Decreasing cost, then increasing item */
+static inline bool item_cost_before(const WorkerItemCost* a, const WorkerItemCost* b) {
+    return (a->cost != b->cost) ? a->cost > b->cost : a->item < b->item;
+}
+
+static int item_cost_compare(const void* a, const void* b) {
+    const WorkerItemCost* ia = (const WorkerItemCost*)a;
+    const WorkerItemCost* ib = (const WorkerItemCost*)b;
+    return item_cost_before(ia, ib) ? -1 : item_cost_before(ib, ia) ? 1 : 0;
+}
+
+/* Short lists (a chunk row's tiles, a grid's chunk rows) sort in place */
+static void item_cost_sort(WorkerItemCost* items, int count) {
+    if (count > WORKERS_SORT_INSERTION_MAX) {
+        qsort(items, (size_t)count, sizeof(WorkerItemCost), item_cost_compare);
+        return;
+    }
+    for (int i = 1; i < count; i++) {
+        WorkerItemCost item = items[i];
+        int j = i;
+        while (j > 0 && item_cost_before(&item, &items[j - 1])) {
+            items[j] = items[j - 1];
+            j--;
+        }
+        items[j] = item;
+    }
+}
+
+/* Contiguous ranges per worker (no cost estimates) */
+static void workers_deal_ranges(WorkerPool* pool, int count) {
+    for (int w = 0; w < pool->count; w++) {
+        int begin = (int)((int64_t)count * w / pool->count);
+        int end = (int)((int64_t)count * (w + 1) / pool->count);
+        atomic_store(&pool->deques[w].range, deque_pack((uint32_t)begin, (uint32_t)end));
+    }
+    for (int i = 0; i < count; i++) {
+        pool->order[i] = i;
+    }
+}
+
+/* Largest-first: give each item to the least-loaded worker, keeping each
+ * deque sorted by decreasing cost. Uses the pool's scratch (workers_reserve). */
+static void workers_deal_costed(WorkerPool* pool, int count, const uint32_t* cost) {
+    WorkerItemCost* items = pool->items;
+    int* owner = pool->owner;
+
+    for (int i = 0; i < count; i++) {
+        items[i] = (WorkerItemCost){cost[i], i};
+    }
+    item_cost_sort(items, count);
+
+    uint64_t load[WORKERS_MAX] = {0};
+    int fill[WORKERS_MAX] = {0};
+    for (int i = 0; i < count; i++) {
+        /* Stay on the node holding the item's band */
+        int home = pool->node[workers_home(pool, items[i].item, count)];
+        int best = -1;
+        for (int w = 0; w < pool->count; w++) {
+            if (pool->node[w] != home) continue;
+            if (best < 0 || load[w] < load[best]) best = w;
+        }
+        /* Every item costs at least one unit so zero-cost items spread out */
+        load[best] += (uint64_t)items[i].cost + 1;
+        owner[i] = best;
+        fill[best]++;
+    }
+
+    int start[WORKERS_MAX];
+    int offset = 0;
+    for (int w = 0; w < pool->count; w++) {
+        start[w] = offset;
+        atomic_store(&pool->deques[w].range,
+                     deque_pack((uint32_t)offset, (uint32_t)(offset + fill[w])));
+        offset += fill[w];
+    }
+    for (int i = 0; i < count; i++) {
+        pool->order[start[owner[i]]++] = items[i].item;
+    }
+}
+
+/* Grow the per-job buffers to count items (under the lock); false if out
+ * of memory. They only grow, so steady-state jobs allocate nothing. */
+static bool workers_reserve(WorkerPool* pool, int count) {
+    if (count <= pool->order_capacity) return true;
+
+    int* order = realloc(pool->order, (size_t)count * sizeof(int));
+    if (order) pool->order = order;
+    WorkerItemCost* items = realloc(pool->items, (size_t)count * sizeof(WorkerItemCost));
+    if (items) pool->items = items;
+    int* owner = realloc(pool->owner, (size_t)count * sizeof(int));
+    if (owner) pool->owner = owner;
+    if (!order || !items || !owner) return false;
+
+    pool->order_capacity = count;
+    return true;
+}
+
+static void workers_run(WorkerPool* pool, int worker) {
+    int pos;
+    workers_nesting++;
+
+    if (pool->broadcast) {
+        pool->func(pool->ctx, worker, worker);
+        workers_nesting--;
+        return;
+    }
+
+    while (deque_pop(&pool->deques[worker], &pos)) {
+        pool->func(pool->ctx, pool->order[pos], worker);
+    }
+
+    /* Own deque empty: steal until every deque is drained */
+    for (int k = 1; k < pool->count; k++) {
+        WorkerDeque* victim = &pool->deques[(worker + k) % pool->count];
+        while (deque_steal(victim, &pos)) {
+            pool->func(pool->ctx, pool->order[pos], worker);
+        }
+    }
+    workers_nesting--;
+}
+
+static void* workers_thread_main(void* arg) {
+    WorkerStart* start = (WorkerStart*)arg;
+    WorkerPool* pool = start->pool;
+    int worker = start->worker;
+    uint64_t seen = 0;
+
+    pthread_mutex_lock(&pool->lock);
+    for (;;) {
+        while (!pool->shutdown && pool->generation == seen) {
+            pthread_cond_wait(&pool->wake, &pool->lock);
+        }
+        if (pool->shutdown) break;
+        seen = pool->generation;
+        pthread_mutex_unlock(&pool->lock);
+
+        workers_run(pool, worker);
+
+        pthread_mutex_lock(&pool->lock);
+        if (--pool->pending == 0) {
+            pthread_cond_signal(&pool->done);
+        }
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return NULL;
+}
+
+/* =============================================================================
+ * Pool Lifecycle
+ * ============================================================================= */
+
+int workers_cpu_count(void) {
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return (n < 1) ? 1 : (int)n;
+}
+
+/* Pin when asked (PIXELSIM_PIN=1), never with PIXELSIM_PIN=0, and by
+ * default only when the machine has more than one NUMA node */
+static bool workers_want_pinning(const NumaTopology* topo) {
+    const char* env = getenv("PIXELSIM_PIN");
+    if (env && *env) return atoi(env) != 0;
+    return topo->node_count > 1;
+}
+
+/* Assign every worker slot a node and (if pinning) a CPU on it */
+static void workers_place(WorkerPool* pool, int thread_count, const NumaTopology* topo,
+                          bool pin) {
+    int nodes = MIN(topo->node_count, thread_count);
+    int next[NUMA_MAX_NODES] = {0};
+
+    pool->node_count = nodes;
+    for (int n = 0; n < nodes; n++) {
+        pool->node_id[n] = topo->node_id[n];
+    }
+    for (int w = 0; w < thread_count; w++) {
+        int n = (int)((int64_t)w * nodes / thread_count);
+        int k = next[n]++ % topo->node_cpus[n];
+        pool->node[w] = n;
+        pool->cpu[w] = pin ? topo->cpu_id[topo->node_first[n] + k] : -1;
+    }
+}
+
+static void workers_cpu_set(int cpu, cpu_set_t* set) {
+    CPU_ZERO(set);
+    CPU_SET(cpu, set);
+}
+
+/* CPU the calling thread is bound to as worker 0 (-1 when unbound) and the
+ * mask it had before; kept across jobs so a steady caller binds only once */
+static _Thread_local int workers_caller_cpu = -1;
+static _Thread_local cpu_set_t workers_caller_mask;
+
+/* Bind the calling thread to worker 0's CPU unless it already is */
+static void workers_bind_caller(const WorkerPool* pool) {
+    int cpu = pool->cpu[0];
+    if (cpu < 0 || cpu == workers_caller_cpu) return;
+    if (workers_caller_cpu < 0 &&
+        pthread_getaffinity_np(pthread_self(), sizeof(workers_caller_mask), &workers_caller_mask) != 0) {
+        return;
+    }
+
+    cpu_set_t set;
+    workers_cpu_set(cpu, &set);
+    if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0) {
+        workers_caller_cpu = cpu;
+    }
+}
+
+void workers_release_caller(void) {
+    if (workers_caller_cpu < 0) return;
+    pthread_setaffinity_np(pthread_self(), sizeof(workers_caller_mask), &workers_caller_mask);
+    workers_caller_cpu = -1;
+}
+
+static WorkerPool* workers_create_pool(int thread_count, bool allow_pin) {
+    if (thread_count <= 0) {
+        const char* env = getenv("PIXELSIM_THREADS");
+        thread_count = env ? atoi(env) : 0;
+    }
+    if (thread_count <= 0) {
+        thread_count = workers_cpu_count();
+    }
+    thread_count = CLAMP(thread_count, 1, WORKERS_MAX);
+
+    /* Detect and spawn from the caller's own mask, not worker 0's CPU */
+    workers_release_caller();
+
+    WorkerPool* pool = calloc(1, sizeof(WorkerPool));
+    if (!pool) return NULL;
+
+    NumaTopology* topo = malloc(sizeof(NumaTopology));
+    if (!topo) {
+        free(pool);
+        return NULL;
+    }
+    numa_detect(topo);
+    workers_place(pool, thread_count, topo, allow_pin && workers_want_pinning(topo));
+    free(topo);
+
+    pool->count = 1;
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->wake, NULL);
+    pthread_cond_init(&pool->done, NULL);
+
+    /* Worker 0 is whichever thread issues a job and is bound by its first
+     * one; spawn the rest, bound before they start */
+    cpu_set_t set;
+    for (int i = 1; i < thread_count; i++) {
+        pthread_attr_t attr;
+        pthread_attr_init(&attr);
+        if (pool->cpu[i] >= 0) {
+            workers_cpu_set(pool->cpu[i], &set);
+            pthread_attr_setaffinity_np(&attr, sizeof(set), &set);
+        }
+        pool->starts[i] = (WorkerStart){pool, i};
+        int err = pthread_create(&pool->threads[i], &attr, workers_thread_main, &pool->starts[i]);
+        pthread_attr_destroy(&attr);
+        if (err != 0) break;
+        pool->count++;
+    }
+
+    /* Fewer threads than planned: nodes past the last worker are unused */
+    pool->node_count = pool->node[pool->count - 1] + 1;
+
+    return pool;
+}
+
+WorkerPool* workers_create(int thread_count) {
+    return workers_create_pool(thread_count, true);
+}
+
+WorkerPool* workers_create_unpinned(int thread_count) {
+    return workers_create_pool(thread_count, false);
+}
+
+void workers_destroy(WorkerPool* pool) {
+    if (!pool) return;
+
+    pthread_mutex_lock(&pool->lock);
+    pool->shutdown = true;
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (int i = 1; i < pool->count; i++) {
+        pthread_join(pool->threads[i], NULL);
+    }
+
+    pthread_cond_destroy(&pool->done);
+    pthread_cond_destroy(&pool->wake);
+    pthread_mutex_destroy(&pool->lock);
+    free(pool->order);
+    free(pool->items);
+    free(pool->owner);
+    free(pool);
+}
+
+int workers_count(const WorkerPool* pool) {
+    return pool ? pool->count : 1;
+}
+
+int workers_concurrency(const WorkerPool* pool) {
+    return (workers_nesting > 0) ? 1 : workers_count(pool);
+}
+
+int workers_home(const WorkerPool* pool, int item, int count) {
+    if (!pool || count <= 0) return 0;
+    return (int)((int64_t)CLAMP(item, 0, count - 1) * pool->count / count);
+}
+
+int workers_node_count(const WorkerPool* pool) {
+    return pool ? pool->node_count : 1;
+}
+
+int workers_node(const WorkerPool* pool, int worker) {
+    return pool ? pool->node_id[pool->node[worker]] : 0;
+}
+
+int workers_cpu(const WorkerPool* pool, int worker) {
+    return pool ? pool->cpu[worker] : -1;
+}
+
+void workers_parallel_for_costed(WorkerPool* pool, int count, const uint32_t* cost,
+                                 WorkerTaskFunc func, void* ctx) {
+    if (count <= 0) return;
+
+    /* Inline path: no pool, single worker, nothing to split, or nested */
+    if (workers_concurrency(pool) == 1 || count == 1) {
+        for (int item = 0; item < count; item++) {
+            func(ctx, item, 0);
+        }
+        return;
+    }
+
+    pthread_mutex_lock(&pool->lock);
+
+    if (!workers_reserve(pool, count)) {
+        /* Out of memory: run the job inline rather than drop it */
+        pthread_mutex_unlock(&pool->lock);
+        for (int item = 0; item < count; item++) {
+            func(ctx, item, 0);
+        }
+        return;
+    }
+
+    if (cost) {
+        workers_deal_costed(pool, count, cost);
+    } else {
+        workers_deal_ranges(pool, count);
+    }
+
+    pool->func = func;
+    pool->ctx = ctx;
+    pool->broadcast = false;
+    pool->pending = pool->count - 1;
+    pool->generation++;
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+
+    workers_bind_caller(pool);
+    workers_run(pool, 0);
+
+    pthread_mutex_lock(&pool->lock);
+    while (pool->pending > 0) {
+        pthread_cond_wait(&pool->done, &pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+}
+
+void workers_parallel_for(WorkerPool* pool, int count, WorkerTaskFunc func, void* ctx) {
+    workers_parallel_for_costed(pool, count, NULL, func, ctx);
+}
+
+void workers_run_each(WorkerPool* pool, WorkerTaskFunc func, void* ctx) {
+    /* Nested or single worker: run every slot here (placement is lost) */
+    if (workers_concurrency(pool) == 1) {
+        for (int w = 0; w < workers_count(pool); w++) {
+            func(ctx, w, 0);
+        }
+        return;
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    pool->func = func;
+    pool->ctx = ctx;
+    pool->broadcast = true;
+    pool->pending = pool->count - 1;
+    pool->generation++;
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+
+    workers_bind_caller(pool);
+    workers_run(pool, 0);
+
+    pthread_mutex_lock(&pool->lock);
+    while (pool->pending > 0) {
+        pthread_cond_wait(&pool->done, &pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+}
@@ -5,23 +5,315 @@
  */
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
 
 #include "core/types.h"
 #include "materials/material.h"
 #include "world/world.h"
+#include "world/scene.h"
 #include "engine/simulation.h"
+#include "engine/stages.h"
+#include "engine/autotune.h"
+#include "engine/kernels.h"
 #include "engine/render.h"
 #include "engine/input.h"
+#include "engine/sim_thread.h"
+#include "engine/recorder.h"
+
+/* =============================================================================
+ * Command Line Options
+ * ============================================================================= */
+
+/* Options applied after the simulation exists */
+typedef struct {
+    int chunk_size;           /* --chunk-size, 0 = default or tuned */
+    bool modes_set;           /* An explicit --*-mode was given */
+    bool autotune;            /* --autotune: cached tuning, tune on a miss */
+    bool retune;              /* --retune: always tune and refresh the cache */
+    bool tune_modes;          /* --autotune-modes: also pick the update mode */
+    int headless_ticks;       /* --headless N: run N ticks without a window */
+    const char* output;       /* --output PATH: out.y4m or a pattern like out/f_%05d.png */
+    RecordPolicy record_policy; /* --record-policy, when record_policy_set */
+    bool record_policy_set;
+    int frame_every;          /* --frame-every N: render every Nth tick (default 1) */
+    const char* scene;        /* --scene NAME|FILE: starting scene (default "default") */
+} Options;
+
+/* Y4M frame rate of an interactive recording (one frame per vsync) */
+#define RECORD_DISPLAY_HZ 60
+
+/* Apply one --stage-rate NAME=N[:PHASE] value, returns false on error */
+static bool parse_stage_rate(Simulation* sim, const char* arg) {
+    char name[32];
+    int rate = 0, phase = STAGE_PHASE_AUTO;
+    
+    const char* eq = strchr(arg, '=');
+    if (!eq || eq == arg || (size_t)(eq - arg) >= sizeof(name)) return false;
+    memcpy(name, arg, (size_t)(eq - arg));
+    name[eq - arg] = '\0';
+    
+    int fields = sscanf(eq + 1, "%d:%d", &rate, &phase);
+    if (fields < 1 || rate < 1 || (fields == 2 && phase < 0)) return false;
+    
+    int stage = stage_graph_find(sim->stages, name);
+    if (stage < 0) return false;
+    stage_graph_set_rate(sim->stages, stage, rate, phase);
+    return true;
+}
+
+/* Apply --powder-mode/--fluid-mode/--gas-mode/--stage-rate options and
+ * collect the rest into opts, returns false on error */
+static bool parse_options(Simulation* sim, int argc, char* argv[], Options* opts) {
+    static const struct {
+        const char* flag;
+        MaterialState state;
+    } MODE_FLAGS[] = {
+        {"--powder-mode", STATE_POWDER},
+        {"--fluid-mode",  STATE_FLUID},
+        {"--gas-mode",    STATE_GAS},
+    };
+    
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--stage-rate") == 0) {
+            if (i + 1 >= argc || !parse_stage_rate(sim, argv[i + 1])) {
+                fprintf(stderr, "--stage-rate expects NAME=N[:PHASE] with a known stage name\n");
+                return false;
+            }
+            i++;
+            continue;
+        }
+        if (strcmp(argv[i], "--chunk-size") == 0) {
+            int size = (i + 1 < argc) ? atoi(argv[i + 1]) : 0;
+            if (size < CHUNK_SIZE_MIN || size > CHUNK_SIZE_MAX || (size & (size - 1)) != 0) {
+                fprintf(stderr, "--chunk-size expects a power of two in [%d, %d]\n",
+                        CHUNK_SIZE_MIN, CHUNK_SIZE_MAX);
+                return false;
+            }
+            opts->chunk_size = size;
+            i++;
+            continue;
+        }
+        if (strcmp(argv[i], "--headless") == 0 || strcmp(argv[i], "--frame-every") == 0) {
+            int value = (i + 1 < argc) ? atoi(argv[i + 1]) : 0;
+            if (value < 1) {
+                fprintf(stderr, "%s expects a positive count\n", argv[i]);
+                return false;
+            }
+            if (strcmp(argv[i], "--headless") == 0) {
+                opts->headless_ticks = value;
+            } else {
+                opts->frame_every = value;
+            }
+            i++;
+            continue;
+        }
+        if (strcmp(argv[i], "--output") == 0) {
+            if (i + 1 >= argc || !recorder_check_path(argv[i + 1])) {
+                fprintf(stderr, "--output expects a .y4m file or a .png/.raw file pattern "
+                        "with one %%d (e.g. out/f_%%05d.png)\n");
+                return false;
+            }
+            opts->output = argv[i + 1];
+            i++;
+            continue;
+        }
+        if (strcmp(argv[i], "--scene") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "--scene expects a scene name or a scene file\n");
+                return false;
+            }
+            opts->scene = argv[i + 1];
+            i++;
+            continue;
+        }
+        if (strcmp(argv[i], "--record-policy") == 0) {
+            if (i + 1 >= argc || !recorder_parse_policy(argv[i + 1], &opts->record_policy)) {
+                fprintf(stderr, "--record-policy expects one of: drop, block\n");
+                return false;
+            }
+            opts->record_policy_set = true;
+            i++;
+            continue;
+        }
+        if (strcmp(argv[i], "--autotune") == 0 || strcmp(argv[i], "--retune") == 0 ||
+            strcmp(argv[i], "--autotune-modes") == 0) {
+            opts->autotune = true;
+            opts->retune = opts->retune || strcmp(argv[i], "--retune") == 0;
+            opts->tune_modes = opts->tune_modes || strcmp(argv[i], "--autotune-modes") == 0;
+            continue;
+        }
+        
+        bool known = false;
+        for (size_t f = 0; f < sizeof(MODE_FLAGS) / sizeof(MODE_FLAGS[0]); f++) {
+            if (strcmp(argv[i], MODE_FLAGS[f].flag) != 0) continue;
+            
+            UpdateMode mode;
+            if (i + 1 >= argc || !simulation_parse_update_mode(argv[i + 1], &mode)) {
+                fprintf(stderr, "%s expects one of: sweep, margolus, intent, tiled\n", argv[i]);
+                return false;
+            }
+            simulation_set_update_mode(sim, MODE_FLAGS[f].state, mode);
+            opts->modes_set = true;
+            known = true;
+            i++;
+            break;
+        }
+        if (!known) {
+            fprintf(stderr, "Unknown option: %s\n", argv[i]);
+            return false;
+        }
+    }
+    return true;
+}
+
+/* Load or measure the tuned configuration and apply the thread count, and
+ * the update mode only with --autotune-modes; returns the tuned chunk size,
+ * or 0 when not tuning */
+static int apply_autotune(Simulation* sim, const Options* opts) {
+    TuneConfig config;
+    const char* path = autotune_cache_path();
+    
+    if (!opts->autotune) return 0;
+    bool tune_modes = opts->tune_modes && !opts->modes_set;
+    if (!opts->retune && autotune_load(sim, path, &config) && (config.mode_tuned || !tune_modes)) {
+        printf("Tuning: cached in %s\n", path);
+    } else {
+        printf("Tuning: measuring candidate configurations...\n");
+        if (!autotune_run(sim, &config, tune_modes, true)) {
+            fprintf(stderr, "Tuning failed, using defaults\n");
+            return 0;
+        }
+        if (!autotune_save(sim, path, &config)) {
+            fprintf(stderr, "Could not write tuning cache %s\n", path);
+        }
+    }
+    
+    const char* mode = (tune_modes && config.mode_tuned)
+                       ? simulation_update_mode_name(config.mode) : "as configured";
+    printf("Tuning: threads=%d chunk=%d mode=%s isa=%s (%.0fus/tick)\n", config.threads,
+           config.chunk_size, mode, kernels_isa_name(config.isa), config.tick_us);
+    if (!autotune_apply(sim, &config, tune_modes)) {
+        fprintf(stderr, "Could not apply tuned thread count or ISA\n");
+    }
+    return config.chunk_size;
+}
+
+/* Worker to CPU/NUMA node mapping, printed once at startup */
+static void print_worker_placement(const WorkerPool* pool) {
+    int count = workers_count(pool);
+    printf("Workers: %d on %d NUMA node(s)%s\n", count, workers_node_count(pool),
+           workers_cpu(pool, 0) >= 0 ? ", pinned" : "");
+    for (int w = 0; w < count; w++) {
+        int cpu = workers_cpu(pool, w);
+        if (cpu >= 0) {
+            printf("  worker %d: node %d, cpu %d\n", w, workers_node(pool, w), cpu);
+        } else {
+            printf("  worker %d: node %d\n", w, workers_node(pool, w));
+        }
+    }
+}
+
+/* Render pool size: PIXELSIM_RENDER_THREADS, default a quarter of the CPUs
+ * (the simulation pool uses all of them) */
+static int render_thread_count(void) {
+    const char* env = getenv("PIXELSIM_RENDER_THREADS");
+    int count = (env && *env) ? atoi(env) : workers_cpu_count() / 4;
+    return CLAMP(count, 1, WORKERS_MAX);
+}
+
+/* =============================================================================
+ * Headless Runs
+ * ============================================================================= */
+
+static double headless_time_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1000.0 + (double)ts.tv_nsec / 1000000.0;
+}
+
+/* Start recording renderer frames to opts->output (NULL when not recording
+ * or on error). Frames are handed to a writer thread; the policy decides
+ * whether a full queue drops frames or holds up the caller. */
+static Recorder* start_recording(const Options* opts, const Renderer* renderer, int rate_num,
+                                 int rate_den, RecordPolicy default_policy) {
+    if (!opts->output) return NULL;
+    
+    RecordPolicy policy = opts->record_policy_set ? opts->record_policy : default_policy;
+    Recorder* recorder = recorder_create(opts->output, renderer->width, renderer->height,
+                                         rate_num, rate_den, policy, RECORD_QUEUE_DEFAULT);
+    if (!recorder) {
+        fprintf(stderr, "Failed to start recording to %s\n", opts->output);
+        return NULL;
+    }
+    printf("Recording: %s (%s when the writer falls behind)\n", opts->output,
+           policy == RECORD_DROP ? "dropping frames" : "waiting");
+    return recorder;
+}
+
+/* Finish writing and report; false if a frame could not be written */
+static bool stop_recording(Recorder* recorder) {
+    RecordStats stats;
+    if (!recorder) return true;
+    
+    recorder_close(recorder, &stats);
+    printf("Recording: %llu frames written, %llu dropped (queue peak %d/%d)\n",
+           (unsigned long long)stats.written, (unsigned long long)stats.dropped,
+           stats.max_queued, RECORD_QUEUE_DEFAULT);
+    return !stats.failed;
+}
+
+/* Run opts->headless_ticks ticks without a window, rendering every
+ * frame_every-th tick and recording it when an output is set. Offline
+ * renders keep every frame unless --record-policy drop is given. */
+static int run_headless(Simulation* sim, World* world, const Options* opts) {
+    Renderer* renderer = render_create_headless(GRID_WIDTH, GRID_HEIGHT);
+    if (!renderer) {
+        fprintf(stderr, "Failed to create headless renderer\n");
+        return 1;
+    }
+    Recorder* recorder = start_recording(opts, renderer, TICK_HZ, opts->frame_every, RECORD_BLOCK);
+    if (opts->output && !recorder) {
+        render_destroy(renderer);
+        return 1;
+    }
+    /* Ticks and frames alternate on this thread, so they share the pool */
+    render_set_workers(renderer, sim->workers);
+    
+    double tick_ms = 0.0, render_ms = 0.0;
+    int frames = 0;
+    for (int t = 1; t <= opts->headless_ticks; t++) {
+        double t0 = headless_time_ms();
+        simulation_tick(sim, world);
+        double t1 = headless_time_ms();
+        tick_ms += t1 - t0;
+        if (t % opts->frame_every != 0) continue;
+        
+        render_begin_frame(renderer);
+        render_world(renderer, world);
+        render_overlay(renderer, world);
+        render_end_frame(renderer);
+        render_ms += headless_time_ms() - t1;
+        
+        if (recorder) {
+            recorder_submit(recorder, renderer->pixels, renderer->width);
+        }
+        frames++;
+    }
+    
+    printf("Headless: %d ticks (%.3f ms/tick), %d frames (%.3f ms/frame)\n",
+           opts->headless_ticks, tick_ms / MAX(opts->headless_ticks, 1),
+           frames, render_ms / MAX(frames, 1));
+    bool recorded = stop_recording(recorder);
+    render_destroy(renderer);
+    return recorded ? 0 : 1;
+}
 
 /* =============================================================================
  * Main Entry Point
  * ============================================================================= */
 
 int main(int argc, char* argv[]) {
-    (void)argc;
-    (void)argv;
-    
     printf("Pixel-Cell Physics Simulator - Full Simulation\n");
     printf("=================================================\n");
     printf("Controls:\n");
@@ -35,27 +327,64 @@ int main(int argc, char* argv[]) {
     printf("  Period (.)   - Step one tick (when paused)\n");
     printf("  C            - Clear world\n");
     printf("  Tab          - Cycle debug overlay (incl. Temperature)\n");
+    printf("  Arrows / Middle Drag - Pan view\n");
+    printf("  Ctrl + Wheel - Zoom view, Home - Reset view\n");
     printf("  Escape       - Quit\n");
     printf("=================================================\n");
     
     /* Initialize material system */
     material_init();
     
-    /* Create world */
-    World* world = world_create(GRID_WIDTH, GRID_HEIGHT);
+    /* Create simulation (owns the worker pool the world is placed with) */
+    Simulation* sim = simulation_create(TICK_HZ);
+    if (!sim) {
+        fprintf(stderr, "Failed to create simulation\n");
+        return 1;
+    }
+    
+    Options opts = { .frame_every = 1, .scene = "default" };
+    if (!parse_options(sim, argc, argv, &opts)) {
+        simulation_destroy(sim);
+        return 1;
+    }
+    
+    /* Tuning may replace the worker pool, so it runs before placement */
+    int chunk_size = apply_autotune(sim, &opts);
+    if (opts.chunk_size) chunk_size = opts.chunk_size;
+    
+    /* Create world, each band on its owning worker's NUMA node */
+    World* world = world_create_placed(GRID_WIDTH, GRID_HEIGHT, sim->workers);
     if (!world) {
         fprintf(stderr, "Failed to create world\n");
+        simulation_destroy(sim);
         return 1;
     }
+    if (chunk_size) {
+        world_set_chunk_size(world, chunk_size);
+    }
+    print_worker_placement(sim->workers);
+    printf("Kernels: %s (best supported: %s)\n", kernels_isa_name(kernels.isa),
+           kernels_isa_name(kernels_detect_isa()));
     
-    /* Create simulation */
-    Simulation* sim = simulation_create(TICK_HZ);
-    if (!sim) {
-        fprintf(stderr, "Failed to create simulation\n");
+    if (!scene_apply(world, opts.scene)) {
+        fprintf(stderr, "Failed to load scene %s\n", opts.scene);
         world_destroy(world);
+        simulation_destroy(sim);
         return 1;
     }
     
+    /* Setup jobs bound this thread to the pool's first CPU; the window,
+     * recorder and simulation threads must not inherit it */
+    workers_release_caller();
+    
+    /* Batch rendering: no window, no SDL video */
+    if (opts.headless_ticks > 0) {
+        int status = run_headless(sim, world, &opts);
+        simulation_destroy(sim);
+        world_destroy(world);
+        return status;
+    }
+    
     /* Create renderer */
     Renderer* renderer = render_create(WINDOW_WIDTH, WINDOW_HEIGHT, "Pixel Simulator - Sand (Phase A)");
     if (!renderer) {
@@ -75,42 +404,38 @@ int main(int argc, char* argv[]) {
         return 1;
     }
     
-    /* Create initial ground/walls for testing */
-    /* Bottom wall */
-    for (int x = 0; x < GRID_WIDTH; x++) {
-        for (int y = GRID_HEIGHT - 10; y < GRID_HEIGHT; y++) {
-            world_set_mat(world, x, y, MAT_STONE);
-        }
-    }
     
-    /* Left wall */
-    for (int y = 0; y < GRID_HEIGHT; y++) {
-        for (int x = 0; x < 10; x++) {
-            world_set_mat(world, x, y, MAT_STONE);
-        }
+    /* Rendering gets its own pool: the simulation pool is busy on the
+     * simulation thread. It is never pinned, so it does not stack onto the
+     * CPUs the simulation workers are bound to. */
+    WorkerPool* render_workers = workers_create_unpinned(render_thread_count());
+    if (!render_workers || !render_set_workers(renderer, render_workers)) {
+        fprintf(stderr, "Warning: rendering on one thread\n");
     }
     
-    /* Right wall */
-    for (int y = 0; y < GRID_HEIGHT; y++) {
-        for (int x = GRID_WIDTH - 10; x < GRID_WIDTH; x++) {
-            world_set_mat(world, x, y, MAT_STONE);
+    /* Recording reads the composed frame, so it needs the copy path; the
+     * render loop must never wait on the disk, so full queues drop frames */
+    Recorder* recorder = NULL;
+    if (opts.output) {
+        if (render_keep_frame(renderer)) {
+            recorder = start_recording(&opts, renderer, RECORD_DISPLAY_HZ, 1, RECORD_DROP);
+        } else {
+            fprintf(stderr, "Out of memory, not recording\n");
         }
     }
+    uint64_t recorded_tick = UINT64_MAX;
     
-    /* Platform in the middle */
-    for (int x = 150; x < 350; x++) {
-        for (int y = 350; y < 360; y++) {
-            world_set_mat(world, x, y, MAT_STONE);
-        }
-    }
-    
-    /* Activate all chunks initially */
-    for (int cy = 0; cy < CHUNKS_Y; cy++) {
-        for (int cx = 0; cx < CHUNKS_X; cx++) {
-            world_activate_chunk(world, cx, cy);
-        }
+    /* From here on the simulation thread owns the world */
+    SimThread* sim_thread = sim_thread_start(sim, world);
+    if (!sim_thread) {
+        stop_recording(recorder);
+        input_destroy(input);
+        render_destroy(renderer);
+        workers_destroy(render_workers);
+        simulation_destroy(sim);
+        world_destroy(world);
+        return 1;
     }
-    world_update_chunk_activation(world);
     
     /* Main loop timing */
     uint64_t last_time = SDL_GetPerformanceCounter();
@@ -121,33 +446,37 @@ int main(int argc, char* argv[]) {
     
     printf("Starting main loop...\n");
     
-    /* Main loop */
+    /* Main loop: input and rendering; the simulation ticks on its own
+     * thread at its fixed rate, independent of vsync */
     while (!input->quit_requested) {
         /* Calculate delta time */
         uint64_t current_time = SDL_GetPerformanceCounter();
         double delta_time = (double)(current_time - last_time) / (double)freq;
         last_time = current_time;
         
-        /* Cap delta time to prevent spiral of death */
-        if (delta_time > 0.1) {
-            delta_time = 0.1;
-        }
-        
         /* Update input */
         input_update(input);
         
-        /* Apply input to world */
-        input_apply(input, world, sim, renderer);
-        
-        /* Update simulation */
-        simulation_update(sim, world, delta_time);
+        /* Queue world edits, apply view changes */
+        input_apply(input, sim_thread, renderer);
         
-        /* Render */
+        /* Render the latest completed tick */
+        const WorldSnapshot* snap = sim_thread_acquire(sim_thread);
         render_begin_frame(renderer);
-        render_world(renderer, world);
-        render_overlay(renderer, world);
-        render_ui(renderer, world, sim->tick_time_ms, sim->tick_count, sim->paused);
-        render_end_frame(renderer);
+        render_world(renderer, &snap->world);
+        render_overlay(renderer, &snap->world);
+        render_ui(renderer, &snap->world, snap->tick_time_ms, snap->tick_count, snap->paused);
+        if (!render_end_frame(renderer)) {
+            /* Nothing changed and nothing was presented, so vsync does not
+             * pace the loop */
+            SDL_Delay(1);
+        }
+        
+        /* Record each frame that shows a new tick */
+        if (recorder && snap->tick_count != recorded_tick) {
+            recorder_submit(recorder, renderer->pixels, renderer->width);
+            recorded_tick = snap->tick_count;
+        }
         
         /* Update FPS counter */
         render_update_fps(renderer, delta_time);
@@ -158,28 +487,31 @@ int main(int argc, char* argv[]) {
         if (fps_timer >= 1.0) {
             printf("FPS: %.1f | Ticks: %llu | Cells: %u | Chunks: %u | %s [%d] | %s\n",
                    (double)frame_count / fps_timer,
-                   (unsigned long long)sim->tick_count,
-                   world->cells_updated,
-                   world->active_chunks,
+                   (unsigned long long)snap->tick_count,
+                   snap->world.cells_updated,
+                   snap->world.active_chunks,
                    input_get_material_name(input),
                    input->brush_size,
-                   sim->paused ? "PAUSED" : "RUNNING");
-            printf("  Profile: powder=%.0fus fluid=%.0fus fire=%.0fus gas=%.0fus total=%.0fus\n",
-                   sim->profile_powder_us,
-                   sim->profile_fluid_us,
-                   sim->profile_fire_us,
-                   sim->profile_gas_us,
-                   sim->profile_total_us);
+                   snap->paused ? "PAUSED" : "RUNNING");
+            printf("  Profile:");
+            for (int i = 0; i < sim->stages->count; i++) {
+                printf(" %s=%.0fus", sim->stages->desc[i].name, snap->stage_time_us[i]);
+            }
+            printf(" total=%.0fus\n", snap->profile_total_us);
             fps_timer = 0.0;
             frame_count = 0;
         }
     }
     
+    sim_thread_stop(sim_thread);
+    
     printf("Shutting down...\n");
+    stop_recording(recorder);
     
     /* Cleanup */
     input_destroy(input);
     render_destroy(renderer);
+    workers_destroy(render_workers);
     simulation_destroy(sim);
     world_destroy(world);
     
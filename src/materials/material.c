@@ -4,6 +4,7 @@
 #include "materials/material.h"
 #include "core/utils.h"
 #include <string.h>
+#include <strings.h>
 
 /* =============================================================================
  * Material Table (the heart of data-driven design)
@@ -21,6 +22,7 @@ static bool g_material_is_fluid_lut[MAT_COUNT];
 static bool g_material_is_solid_lut[MAT_COUNT];
 static bool g_material_is_empty_lut[MAT_COUNT];
 static bool g_material_is_gas_lut[MAT_COUNT];
+static uint32_t g_material_palette[MAT_COUNT * MATERIAL_PALETTE_SIZE];
 
 static void material_finalize_fixed(MaterialProps* mat) {
     mat->gravity_step_fixed = FIXED_FROM_FLOAT(GRAVITY_ACCEL * mat->gravity_scale);
@@ -28,6 +30,22 @@ static void material_finalize_fixed(MaterialProps* mat) {
     mat->terminal_velocity_fixed = FIXED_FROM_FLOAT(mat->terminal_velocity);
 }
 
+/* Variants spread evenly over [-color_variation, +color_variation] */
+static uint32_t material_bake_color(const MaterialProps* mat, int variant) {
+    Color c = mat->base_color;
+    
+    if (mat->color_variation > 0) {
+        int span = mat->color_variation * 2 + 1;
+        int var = variant * span / MATERIAL_PALETTE_SIZE - mat->color_variation;
+        
+        c.r = (uint8_t)CLAMP((int)c.r + var, 0, 255);
+        c.g = (uint8_t)CLAMP((int)c.g + var, 0, 255);
+        c.b = (uint8_t)CLAMP((int)c.b + var, 0, 255);
+    }
+    
+    return ((uint32_t)c.a << 24) | ((uint32_t)c.r << 16) | ((uint32_t)c.g << 8) | (uint32_t)c.b;
+}
+
 void material_init(void) {
     memset(g_materials, 0, sizeof(g_materials));
     
@@ -426,6 +444,12 @@ void material_init(void) {
         g_material_is_solid_lut[i] = (g_materials[i].state == STATE_SOLID);
         g_material_is_empty_lut[i] = (g_materials[i].state == STATE_EMPTY);
         g_material_is_gas_lut[i] = (g_materials[i].state == STATE_GAS);
+        
+        /* Bake color variants */
+        for (int v = 0; v < MATERIAL_PALETTE_SIZE; v++) {
+            g_material_palette[(i << MATERIAL_PALETTE_SHIFT) | v] =
+                material_bake_color(&g_materials[i], v);
+        }
     }
 }
 
@@ -436,6 +460,16 @@ const MaterialProps* material_get(MaterialID id) {
     return &g_materials[id];
 }
 
+bool material_find(const char* name, MaterialID* id) {
+    for (int i = 0; i < MAT_COUNT; i++) {
+        if (strcasecmp(g_materials[i].name, name) == 0) {
+            *id = (MaterialID)i;
+            return true;
+        }
+    }
+    return false;
+}
+
 /* Fast LUT-based material queries - inlined for hot paths */
 MaterialState material_state(MaterialID id) {
     return (id < MAT_COUNT) ? g_material_state_lut[id] : STATE_EMPTY;
@@ -461,18 +495,13 @@ bool material_is_gas(MaterialID id) {
     return (id < MAT_COUNT) ? g_material_is_gas_lut[id] : false;
 }
 
-Color material_color(MaterialID id, uint32_t seed) {
-    const MaterialProps* mat = material_get(id);
-    Color c = mat->base_color;
-    
-    if (mat->color_variation > 0 && seed != 0) {
-        uint32_t h = hash32(seed);
-        int var = (int)(h % (mat->color_variation * 2 + 1)) - mat->color_variation;
-        
-        c.r = (uint8_t)CLAMP((int)c.r + var, 0, 255);
-        c.g = (uint8_t)CLAMP((int)c.g + var, 0, 255);
-        c.b = (uint8_t)CLAMP((int)c.b + var, 0, 255);
-    }
-    
-    return c;
+Color material_color(MaterialID id, uint8_t variant) {
+    if (id >= MAT_COUNT) id = MAT_EMPTY;
+    uint32_t argb = g_material_palette[(id << MATERIAL_PALETTE_SHIFT) |
+                                       (variant & (MATERIAL_PALETTE_SIZE - 1))];
+    return (Color){ (uint8_t)(argb >> 16), (uint8_t)(argb >> 8), (uint8_t)argb, (uint8_t)(argb >> 24) };
+}
+
+const uint32_t* material_palette(void) {
+    return g_material_palette;
 }
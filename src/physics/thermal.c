@@ -11,13 +11,17 @@
 #include "world/cell_ops.h"
 #include "materials/behavior.h"
 #include "world/grid_iter.h"
+#include "engine/stages.h"
+#include "engine/kernels.h"
 #include <math.h>
+#include <string.h>
 
 /* =============================================================================
  * Phase Change Logic
  * ============================================================================= */
 
-void thermal_check_phase_change(Simulation* sim, World* world, int x, int y) {
+/* Phase change test covering `ticks` ticks of a rate-divided stage */
+static void thermal_phase_change_ticks(Simulation* sim, World* world, int x, int y, int ticks) {
     int idx = IDX(x, y);
     MaterialID mat = world->mat[idx];
     float temp = world->temp_next[idx];
@@ -30,7 +34,7 @@ void thermal_check_phase_change(Simulation* sim, World* world, int x, int y) {
         StateTransition trans = bhv_get_melt_transition(mat);
         float melt_chance = trans.probability + (temp - props->melting_temp) * 0.002f;
 
-        if (simulation_randf(sim) < melt_chance) {
+        if (simulation_randf(sim) < stage_scale_chance(melt_chance, ticks)) {
             world_set_mat(world, x, y, trans.result);
             world->temp_next[idx] -= 10.0f; /* Absorb heat */
         }
@@ -43,7 +47,7 @@ void thermal_check_phase_change(Simulation* sim, World* world, int x, int y) {
         StateTransition trans = bhv_get_freeze_transition(mat);
         float freeze_chance = trans.probability + (-temp) * 0.001f;
 
-        if (simulation_randf(sim) < freeze_chance) {
+        if (simulation_randf(sim) < stage_scale_chance(freeze_chance, ticks)) {
             world_set_mat(world, x, y, trans.result);
             world->temp_next[idx] += 5.0f; /* Release heat */
         }
@@ -56,7 +60,7 @@ void thermal_check_phase_change(Simulation* sim, World* world, int x, int y) {
         StateTransition trans = bhv_get_boil_transition(mat);
         float boil_chance = trans.probability + (temp - props->boiling_temp) * 0.005f;
 
-        if (simulation_randf(sim) < boil_chance) {
+        if (simulation_randf(sim) < stage_scale_chance(boil_chance, ticks)) {
             world_set_mat(world, x, y, trans.result);
             world->lifetime[idx] = 0;
             world->temp_next[idx] -= 50.0f; /* Absorb lot of heat */
@@ -70,7 +74,7 @@ void thermal_check_phase_change(Simulation* sim, World* world, int x, int y) {
         StateTransition trans = bhv_get_condense_transition(mat);
         float condense_chance = trans.probability + (80.0f - temp) * 0.001f;
 
-        if (simulation_randf(sim) < condense_chance) {
+        if (simulation_randf(sim) < stage_scale_chance(condense_chance, ticks)) {
             world_set_mat(world, x, y, trans.result);
             world->lifetime[idx] = 0;
             world->temp_next[idx] += 20.0f; /* Release heat */
@@ -78,28 +82,30 @@ void thermal_check_phase_change(Simulation* sim, World* world, int x, int y) {
     }
 }
 
+void thermal_check_phase_change(Simulation* sim, World* world, int x, int y) {
+    thermal_phase_change_ticks(sim, world, x, y, 1);
+}
+
 /* =============================================================================
- * Heat Diffusion Callback
+ * Heat Diffusion
  * ============================================================================= */
 
-static bool thermal_diffusion_callback(Simulation* sim, World* world, int x, int y, void* userdata) {
-    (void)sim;
-    (void)userdata;
-
+/* Reads heat_mat/temp, writes only temp_next at (x, y) */
+static void thermal_diffuse_cell(World* world, int x, int y) {
     int idx = IDX(x, y);
-    MaterialID mat = world->mat[idx];
+    MaterialID mat = world->heat_mat[idx];
     float temp = world->temp[idx];
 
     /* Fire produces constant heat */
     if (mat == MAT_FIRE) {
         world->temp_next[idx] = FIRE_TEMPERATURE;
-        return true;
+        return;
     }
 
     /* Empty cells cool to ambient quickly */
     if (mat == MAT_EMPTY) {
         world->temp_next[idx] = temp + (AMBIENT_TEMP - temp) * 0.1f;
-        return true;
+        return;
     }
 
     const MaterialProps* props = material_get(mat);
@@ -108,7 +114,7 @@ static bool thermal_diffusion_callback(Simulation* sim, World* world, int x, int
     /* No heat transfer for non-conductive materials */
     if (conductivity <= 0.001f) {
         world->temp_next[idx] = temp;
-        return true;
+        return;
     }
 
     /* Calculate heat exchange with 4-directional neighbors */
@@ -122,7 +128,7 @@ static bool thermal_diffusion_callback(Simulation* sim, World* world, int x, int
         if (!IN_BOUNDS(nx, ny)) continue;
 
         int nidx = IDX(nx, ny);
-        MaterialID nmat = world->mat[nidx];
+        MaterialID nmat = world->heat_mat[nidx];
         float ntemp = world->temp[nidx];
         float ncond = material_get(nmat)->conductivity;
 
@@ -148,8 +154,68 @@ static bool thermal_diffusion_callback(Simulation* sim, World* world, int x, int
 
     /* Clamp temperature */
     world->temp_next[idx] = CLAMP(world->temp_next[idx], MIN_TEMPERATURE, MAX_TEMPERATURE);
+}
 
-    return true;
+typedef struct {
+    World* world;
+    float conductivity[KERNEL_LUT_SIZE];
+    float thermal_mass[KERNEL_LUT_SIZE];
+} ThermalContext;
+
+/* Whether any cell of the span moved by more than THERMAL_WAKE_DELTA */
+static bool thermal_span_changed(const float* temp, const float* out, int x0, int x1) {
+    for (int x = x0; x < x1; x++) {
+        if (fabsf(out[x] - temp[x]) > THERMAL_WAKE_DELTA) return true;
+    }
+    return false;
+}
+
+/* One chunk row of active chunks; rows are independent. Interior cells go
+ * through the dispatched row kernel, grid edges through the scalar path.
+ * Records in chunk_warm which chunks are still changing temperature. */
+static void thermal_diffusion_task(void* ctx_ptr, int chunk_y, int worker) {
+    (void)worker;
+    ThermalContext* ctx = (ThermalContext*)ctx_ptr;
+    World* world = ctx->world;
+    int y_start = chunk_y * world->chunk_size;
+    int y_end = MIN(y_start + world->chunk_size, GRID_HEIGHT);
+    bool* warm = &world->chunk_warm[chunk_y * world->chunks_x];
+
+    for (int cx = 0; cx < world->chunks_x; cx++) {
+        warm[cx] = false;
+        if (!world_is_chunk_active(world, cx, chunk_y)) continue;
+        int x_start = cx * world->chunk_size;
+        int x_end = MIN(x_start + world->chunk_size, GRID_WIDTH);
+        int inner_start = MAX(x_start, 1);
+        int inner_end = MIN(x_end, GRID_WIDTH - 1);
+
+        for (int y = y_start; y < y_end; y++) {
+            if (y == 0 || y == GRID_HEIGHT - 1) {
+                for (int x = x_start; x < x_end; x++) {
+                    thermal_diffuse_cell(world, x, y);
+                }
+                continue;
+            }
+
+            ThermalRow row = {
+                .mat = &world->heat_mat[IDX(0, y)],
+                .temp = &world->temp[IDX(0, y)],
+                .out = &world->temp_next[IDX(0, y)],
+                .stride = GRID_WIDTH,
+                .conductivity = ctx->conductivity,
+                .thermal_mass = ctx->thermal_mass,
+            };
+            if (x_start == 0) thermal_diffuse_cell(world, 0, y);
+            kernels.thermal_row(&row, inner_start, inner_end);
+            if (x_end == GRID_WIDTH) thermal_diffuse_cell(world, GRID_WIDTH - 1, y);
+        }
+
+        /* Row by row, stopping at the first change */
+        for (int y = y_start; y < y_end && !warm[cx]; y++) {
+            warm[cx] = thermal_span_changed(&world->temp[IDX(0, y)], &world->temp_next[IDX(0, y)],
+                                            x_start, x_end);
+        }
+    }
 }
 
 /* =============================================================================
@@ -157,8 +223,7 @@ static bool thermal_diffusion_callback(Simulation* sim, World* world, int x, int
  * ============================================================================= */
 
 static bool thermal_phase_callback(Simulation* sim, World* world, int x, int y, void* userdata) {
-    (void)userdata;
-    thermal_check_phase_change(sim, world, x, y);
+    thermal_phase_change_ticks(sim, world, x, y, *(const int*)userdata);
     return true;
 }
 
@@ -166,17 +231,71 @@ static bool thermal_phase_callback(Simulation* sim, World* world, int x, int y,
  * Main Thermal Update
  * ============================================================================= */
 
-void thermal_update(Simulation* sim, World* world) {
-    /* Pass 1: Heat diffusion */
-    grid_iterate(sim, world, ITER_TOP_DOWN, ITER_LEFT_RIGHT,
-                 thermal_diffusion_callback, NULL);
+static void thermal_copy_task(void* ctx_ptr, int chunk_y, int worker) {
+    (void)worker;
+    World* world = (World*)ctx_ptr;
+    int y_start = chunk_y * world->chunk_size;
+    int y_end = MIN(y_start + world->chunk_size, GRID_HEIGHT);
+    size_t begin = (size_t)IDX(0, y_start);
+    memcpy(&world->heat_mat[begin], &world->mat[begin],
+           (size_t)(y_end - y_start) * GRID_WIDTH * sizeof(MaterialID));
+}
 
-    /* Pass 2: Phase changes */
+void thermal_copy_materials(Simulation* sim, World* world) {
+    /* Whole rows: the stencil also reads cells of inactive neighbours */
+    workers_parallel_for(sim->workers, world->chunks_y, thermal_copy_task, world);
+}
+
+void thermal_diffusion_update(Simulation* sim, World* world) {
+    /* Per-material tables for the row kernel */
+    ThermalContext ctx = { .world = world };
+    for (int m = 0; m < MAT_COUNT; m++) {
+        const MaterialProps* props = material_get((MaterialID)m);
+        ctx.conductivity[m] = props->conductivity;
+        ctx.thermal_mass[m] = (props->heat_capacity < 0.1f) ? 0.1f : props->heat_capacity;
+    }
+
+    /* Pure stencil temp -> temp_next, so chunk rows run in parallel */
+    uint32_t row_cost[CHUNKS_Y_MAX];
+    world_chunk_row_costs(world, row_cost);
+    workers_parallel_for_costed(sim->workers, world->chunks_y, row_cost,
+                                thermal_diffusion_task, &ctx);
+}
+
+void thermal_phase_update(Simulation* sim, World* world) {
+    /* More than one tick when the stage runs at a reduced rate */
+    int ticks = stage_current_elapsed();
     grid_iterate(sim, world, ITER_TOP_DOWN, ITER_LEFT_RIGHT,
-                 thermal_phase_callback, NULL);
+                 thermal_phase_callback, &ticks);
+}
 
-    /* Swap temperature buffers */
+void thermal_swap(Simulation* sim, World* world) {
+    (void)sim;
     float* tmp = world->temp;
     world->temp = world->temp_next;
     world->temp_next = tmp;
+
+    /* Chunks still heating or cooling stay awake, and so do their neighbours
+     * the heat flows into; diffusion skips sleeping chunks */
+    for (int cy = 0; cy < world->chunks_y; cy++) {
+        for (int cx = 0; cx < world->chunks_x; cx++) {
+            if (!world->chunk_warm[cy * world->chunks_x + cx]) continue;
+            world_activate_chunk(world, cx, cy);
+            world_activate_chunk(world, cx - 1, cy);
+            world_activate_chunk(world, cx + 1, cy);
+            world_activate_chunk(world, cx, cy - 1);
+            world_activate_chunk(world, cx, cy + 1);
+        }
+    }
+}
+
+void thermal_update(Simulation* sim, World* world) {
+    /* Pass 1: Heat diffusion */
+    thermal_diffusion_update(sim, world);
+
+    /* Pass 2: Phase changes */
+    thermal_phase_update(sim, world);
+
+    /* Swap temperature buffers */
+    thermal_swap(sim, world);
 }
@@ -11,6 +11,7 @@
 #include "world/cell_ops.h"
 #include "materials/behavior.h"
 #include "world/grid_iter.h"
+#include "engine/stages.h"
 
 /* =============================================================================
  * Acid Configuration
@@ -32,7 +33,8 @@ bool material_is_corrodible(MaterialID mat) {
  * Cell Update Logic
  * ============================================================================= */
 
-bool acid_update_cell(Simulation* sim, World* world, int x, int y) {
+/* One acid cell, with the corrosion roll already scaled to the stage rate */
+static bool acid_react_cell(Simulation* sim, World* world, int x, int y, float corrode_chance) {
     MaterialID mat = world_get_mat(world, x, y);
 
     if (mat != MAT_ACID) {
@@ -50,7 +52,7 @@ bool acid_update_cell(Simulation* sim, World* world, int x, int y) {
 
         if (bhv_is_corrodible(neighbor)) {
             /* Roll for corrosion */
-            if (simulation_randf(sim) < ACID_CORRODE_CHANCE) {
+            if (simulation_randf(sim) < corrode_chance) {
                 /* Get reaction details */
                 ReactionRule reaction = bhv_get_corrosion_reaction(neighbor);
 
@@ -80,13 +82,16 @@ bool acid_update_cell(Simulation* sim, World* world, int x, int y) {
     return false;
 }
 
+bool acid_update_cell(Simulation* sim, World* world, int x, int y) {
+    return acid_react_cell(sim, world, x, y, ACID_CORRODE_CHANCE);
+}
+
 /* =============================================================================
  * Grid Update Callback
  * ============================================================================= */
 
 static bool acid_cell_callback(Simulation* sim, World* world, int x, int y, void* userdata) {
-    (void)userdata;
-    acid_update_cell(sim, world, x, y);
+    acid_react_cell(sim, world, x, y, *(const float*)userdata);
     return true;
 }
 
@@ -96,5 +101,6 @@ static bool acid_cell_callback(Simulation* sim, World* world, int x, int y, void
 
 void acid_update(Simulation* sim, World* world) {
     /* Process acid corrosion (movement handled by fluid_update) */
-    grid_iterate_falling(sim, world, acid_cell_callback, NULL);
+    float corrode_chance = stage_scale_chance(ACID_CORRODE_CHANCE, stage_current_elapsed());
+    grid_iterate_falling(sim, world, acid_cell_callback, &corrode_chance);
 }
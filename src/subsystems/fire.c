@@ -11,6 +11,9 @@
 #include "world/cell_ops.h"
 #include "materials/behavior.h"
 #include "world/grid_iter.h"
+#include "world/grid_parallel.h"
+#include "world/margolus.h"
+#include "world/intent.h"
 
 /* =============================================================================
  * Fire Configuration
@@ -149,10 +152,11 @@ bool fire_update_cell(Simulation* sim, World* world, int x, int y) {
 
     int idx = IDX(x, y);
 
-    /* Increment lifetime */
+    /* Increment lifetime; the chunk must stay awake until the cell is gone */
     if (world->lifetime[idx] < 255) {
         world->lifetime[idx]++;
     }
+    world_keep_chunk_awake(world, x, y);
 
     /* =========================================================================
      * Fire Death Check
@@ -223,24 +227,15 @@ bool fire_update_cell(Simulation* sim, World* world, int x, int y) {
  * Gas/Smoke Cell Update
  * ============================================================================= */
 
-bool gas_update_cell(Simulation* sim, World* world, int x, int y) {
-    if (cell_skip_if_updated(world, x, y)) {
-        return false;
-    }
-
-    MaterialID mat = world_get_mat(world, x, y);
-    MaterialState state = material_state(mat);
-
-    if (state != STATE_GAS || mat == MAT_FIRE) {
-        return false;
-    }
-
+/* Lifetime, dissipation and condensation; returns true if the cell was consumed */
+static bool gas_update_lifetime(Simulation* sim, World* world, int x, int y, MaterialID mat) {
     int idx = IDX(x, y);
 
-    /* Increment lifetime */
+    /* Increment lifetime; the chunk must stay awake until the cell is gone */
     if (world->lifetime[idx] < 255) {
         world->lifetime[idx]++;
     }
+    world_keep_chunk_awake(world, x, y);
 
     /* =========================================================================
      * Smoke Dissipation
@@ -251,7 +246,7 @@ bool gas_update_cell(Simulation* sim, World* world, int x, int y) {
             world_set_mat(world, x, y, MAT_EMPTY);
             world->lifetime[idx] = 0;
             cell_mark_updated(world, x, y);
-            world->cells_updated++;
+            cell_count_update(world);
             return true;
         }
     }
@@ -267,12 +262,31 @@ bool gas_update_cell(Simulation* sim, World* world, int x, int y) {
                 world_set_mat(world, x, y, MAT_WATER);
                 world->lifetime[idx] = 0;
                 cell_mark_updated(world, x, y);
-                world->cells_updated++;
+                cell_count_update(world);
                 return true;
             }
         }
     }
 
+    return false;
+}
+
+bool gas_update_cell(Simulation* sim, World* world, int x, int y) {
+    if (cell_skip_if_updated(world, x, y)) {
+        return false;
+    }
+
+    MaterialID mat = world_get_mat(world, x, y);
+    MaterialState state = material_state(mat);
+
+    if (state != STATE_GAS || mat == MAT_FIRE) {
+        return false;
+    }
+
+    if (gas_update_lifetime(sim, world, x, y, mat)) {
+        return true;
+    }
+
     /* =========================================================================
      * Gas Movement
      * ========================================================================= */
@@ -356,6 +370,17 @@ static bool gas_cell_callback(Simulation* sim, World* world, int x, int y, void*
     return true;
 }
 
+static bool gas_lifetime_callback(Simulation* sim, World* world, int x, int y, void* userdata) {
+    (void)userdata;
+    if (cell_skip_if_updated(world, x, y)) return true;
+
+    MaterialID mat = world->mat[IDX(x, y)];
+    if (material_state(mat) == STATE_GAS && mat != MAT_FIRE) {
+        gas_update_lifetime(sim, world, x, y, mat);
+    }
+    return true;
+}
+
 /* =============================================================================
  * Main Update Functions
  * ============================================================================= */
@@ -366,6 +391,26 @@ void fire_update(Simulation* sim, World* world) {
 }
 
 void gas_update(Simulation* sim, World* world) {
+    /* Block update: per-cell lifetime pass, then order-independent movement */
+    if (sim->update_mode[STATE_GAS] == UPDATE_MODE_MARGOLUS) {
+        grid_iterate_rising(sim, world, gas_lifetime_callback, NULL);
+        margolus_update(sim, world, STATE_GAS, 0);
+        return;
+    }
+
+    /* Same lifetime pass, then double-buffered intent/resolve movement */
+    if (sim->update_mode[STATE_GAS] == UPDATE_MODE_INTENT) {
+        grid_iterate_rising(sim, world, gas_lifetime_callback, NULL);
+        intent_update(sim, world, STATE_GAS, 0);
+        return;
+    }
+
+    /* Same scan-order rule, swept in parallel tiles */
+    if (sim->update_mode[STATE_GAS] == UPDATE_MODE_TILED) {
+        grid_iterate_rising_parallel(sim, world, gas_cell_callback, NULL);
+        return;
+    }
+
     /* Gas rises, process top to bottom */
     grid_iterate_rising(sim, world, gas_cell_callback, NULL);
 }
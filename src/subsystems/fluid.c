@@ -13,6 +13,9 @@
 #include "physics/physics.h"
 #include "materials/behavior.h"
 #include "world/grid_iter.h"
+#include "world/grid_parallel.h"
+#include "world/margolus.h"
+#include "world/intent.h"
 #include <stdlib.h>
 
 /* =============================================================================
@@ -159,8 +162,29 @@ static bool fluid_cell_callback(Simulation* sim, World* world, int x, int y, voi
  * ============================================================================= */
 
 void fluid_update(Simulation* sim, World* world) {
-    /* Multiple passes for better dispersion */
+    /* Order-independent block update (one step per dispersion pass) */
+    if (sim->update_mode[STATE_FLUID] == UPDATE_MODE_MARGOLUS) {
+        for (int pass = 0; pass < FLUID_DISPERSION_PASSES; pass++) {
+            margolus_update(sim, world, STATE_FLUID, pass);
+        }
+        return;
+    }
+
+    /* Double-buffered intent/resolve update (one step per dispersion pass) */
+    if (sim->update_mode[STATE_FLUID] == UPDATE_MODE_INTENT) {
+        for (int pass = 0; pass < FLUID_DISPERSION_PASSES; pass++) {
+            intent_update(sim, world, STATE_FLUID, pass);
+        }
+        return;
+    }
+
+    /* Multiple passes for better dispersion, in parallel tiles when tiled */
+    bool tiled = sim->update_mode[STATE_FLUID] == UPDATE_MODE_TILED;
     for (int pass = 0; pass < FLUID_DISPERSION_PASSES; pass++) {
-        grid_iterate_falling(sim, world, fluid_cell_callback, &pass);
+        if (tiled) {
+            grid_iterate_falling_parallel(sim, world, fluid_cell_callback, &pass);
+        } else {
+            grid_iterate_falling(sim, world, fluid_cell_callback, &pass);
+        }
     }
 }
@@ -13,6 +13,9 @@
 #include "physics/physics.h"
 #include "materials/behavior.h"
 #include "world/grid_iter.h"
+#include "world/grid_parallel.h"
+#include "world/margolus.h"
+#include "world/intent.h"
 
 /* =============================================================================
  * Powder Movement Helpers
@@ -55,7 +58,7 @@ static void powder_create_splash(Simulation* sim, World* world,
         int splash_idx = IDX(splash_x, splash_y);
         world->vel_x[splash_idx] = FIXED_FROM_FLOAT(splash_dir * 0.8f);
         world->vel_y[splash_idx] = FIXED_FROM_FLOAT(-0.5f);
-        world->color_seed[splash_idx] = world->color_seed[IDX(x, y)];
+        world->color_variant[splash_idx] = world->color_variant[IDX(x, y)];
     }
 }
 
@@ -187,6 +190,24 @@ static bool powder_cell_callback(Simulation* sim, World* world, int x, int y, vo
  * ============================================================================= */
 
 void powder_update(Simulation* sim, World* world) {
+    /* Order-independent block update */
+    if (sim->update_mode[STATE_POWDER] == UPDATE_MODE_MARGOLUS) {
+        margolus_update(sim, world, STATE_POWDER, 0);
+        return;
+    }
+
+    /* Double-buffered intent/resolve update */
+    if (sim->update_mode[STATE_POWDER] == UPDATE_MODE_INTENT) {
+        intent_update(sim, world, STATE_POWDER, 0);
+        return;
+    }
+
+    /* Same scan-order rule, swept in parallel tiles */
+    if (sim->update_mode[STATE_POWDER] == UPDATE_MODE_TILED) {
+        grid_iterate_falling_parallel(sim, world, powder_cell_callback, NULL);
+        return;
+    }
+
     /* Process bottom to top with randomized horizontal direction */
     grid_iterate_falling(sim, world, powder_cell_callback, NULL);
 }
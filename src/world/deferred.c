@@ -0,0 +1,44 @@
+/*
+ * deferred.c - Per-thread deferred writes implementation
+ */
+#include "world/deferred.h"
+#include <stdlib.h>
+
+_Thread_local ThreadScratch* thread_scratch = NULL;
+
+/* =============================================================================
+ * Scratch Lifecycle
+ * ============================================================================= */
+
+ThreadScratch* deferred_create(int count) {
+    return calloc((size_t)count, sizeof(ThreadScratch));
+}
+
+void deferred_destroy(ThreadScratch* set, int count) {
+    (void)count;
+    free(set);
+}
+
+/* =============================================================================
+ * Merge
+ * ============================================================================= */
+
+void deferred_merge(World* world, ThreadScratch* set, int count) {
+    for (int i = 0; i < count; i++) {
+        ThreadScratch* scratch = &set[i];
+
+        world->cells_updated += scratch->cells_updated;
+        scratch->cells_updated = 0;
+
+        for (int w = 0; w < DEFERRED_CHUNK_WORDS; w++) {
+            uint64_t bits = scratch->chunk_bits[w];
+            while (bits) {
+                int chunk = w * 64 + __builtin_ctzll(bits);
+                world->chunk_active_next[chunk] = true;
+                world->chunk_version[chunk]++;
+                bits &= bits - 1;
+            }
+            scratch->chunk_bits[w] = 0;
+        }
+    }
+}
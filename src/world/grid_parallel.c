@@ -0,0 +1,158 @@
+/*
+ * grid_parallel.c - Tiled Parallel Grid Sweeps Implementation
+ *
+ * Tile geometry: a chunk row of h rows is cut with period
+ * P = 2h + 2 * GRID_TILE_MARGIN columns. Counting t rows from the row swept
+ * first, first-phase tile k spans [kP + t, kP + w - t) with w = 2h + margin
+ * - 1, so it narrows by one column per row on both sides; second-phase
+ * tiles fill the gaps and widen the same way. Both are at least margin + 1
+ * columns wide on every row.
+ */
+#include "world/grid_parallel.h"
+#include "world/deferred.h"
+#include "core/utils.h"
+
+#define GRID_TILE_MARGIN 8
+
+typedef struct {
+    Simulation* sim;
+    World* world;
+    CellUpdateFunc func;
+    void* userdata;
+    bool top_down;
+    uint32_t seed;            /* Per chunk row */
+    int chunk_y;
+    int phase;                /* 0: narrowing tiles, 1: the gaps between them */
+    int period;
+    int width;                /* Phase-0 tile width on the first row */
+} TilePass;
+
+/* Columns [*x_start, *x_end) of a tile on the row t rows after the first */
+static void tile_span(const TilePass* pass, int item, int t, int* x_start, int* x_end) {
+    int base = item * pass->period;
+    if (pass->phase == 0) {
+        *x_start = base + t;
+        *x_end = base + pass->width - t;
+    } else {
+        *x_start = base - pass->period + pass->width - t;
+        *x_end = base + t;
+    }
+    *x_start = MAX(*x_start, 0);
+    *x_end = MIN(*x_end, GRID_WIDTH);
+}
+
+static int tile_count(const TilePass* pass) {
+    return (GRID_WIDTH + pass->period - 1) / pass->period + pass->phase;
+}
+
+/* Estimated cost of each tile: active chunks under its middle row */
+static void tile_costs(const TilePass* pass, int count, uint32_t* tile_cost) {
+    const World* world = pass->world;
+    int row = pass->chunk_y * world->chunks_x;
+
+    for (int item = 0; item < count; item++) {
+        int x_start, x_end;
+        tile_span(pass, item, world->chunk_size / 2, &x_start, &x_end);
+
+        uint32_t sum = 0;
+        for (int cx = x_start >> world->chunk_shift;
+             x_start < x_end && cx <= (x_end - 1) >> world->chunk_shift; cx++) {
+            if (world->chunk_active[row + cx]) {
+                sum += WORLD_CHUNK_BASE_COST + world->chunk_cost[row + cx];
+            }
+        }
+        tile_cost[item] = sum;
+    }
+}
+
+/* Rows of one tile, with chunk spans tested once each; instantiated per
+ * chunk shift like grid_sweep_body so span bounds fold to constants */
+static inline __attribute__((always_inline))
+void tile_sweep_body(const TilePass* pass, ThreadScratch* scratch, int item, int shift,
+                     bool scan_left) {
+    Simulation* sim = pass->sim;
+    World* world = pass->world;
+    int chunks_x = (GRID_WIDTH + (1 << shift) - 1) >> shift;
+    int y_start = pass->chunk_y << shift;
+    int rows = MIN(1 << shift, GRID_HEIGHT - y_start);
+    const bool* active = &world->chunk_active[pass->chunk_y * chunks_x];
+    uint32_t* cost = &world->chunk_cost_next[pass->chunk_y * chunks_x];
+
+    for (int t = 0; t < rows; t++) {
+        int y = pass->top_down ? y_start + t : y_start + rows - 1 - t;
+        int x_start, x_end;
+        tile_span(pass, item, t, &x_start, &x_end);
+        if (x_start >= x_end) continue;
+
+        int first = x_start >> shift, last = (x_end - 1) >> shift;
+        for (int k = 0; k <= last - first; k++) {
+            int cx = scan_left ? first + k : last - k;
+            if (!active[cx]) continue;
+
+            int span_start = MAX(x_start, cx << shift);
+            int span_end = MIN(x_end, (cx + 1) << shift);
+            uint32_t before = scratch->cells_updated;
+
+            for (int i = span_start; i < span_end; i++) {
+                int x = scan_left ? i : span_start + span_end - 1 - i;
+                if (!pass->func(sim, world, x, y, pass->userdata)) return;
+            }
+
+            /* Cost estimate for next tick; a chunk can straddle two tiles */
+            uint32_t made = scratch->cells_updated - before;
+            if (made) __atomic_fetch_add(&cost[cx], made, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+static void tile_task(void* ctx_ptr, int item, int worker) {
+    TilePass* pass = (TilePass*)ctx_ptr;
+    Simulation* sim = pass->sim;
+
+    /* Stream depends only on the tile, not on the worker that runs it */
+    ThreadScratch* scratch = &sim->scratch[worker];
+    deferred_bind(scratch, hash32(pass->seed ^ ((uint32_t)(item * 2 + pass->phase) * 0x9E3779B1u)));
+
+    bool scan_left = (simulation_rand(sim) & 1) != 0;
+    switch (pass->world->chunk_shift) {
+        case 4:  tile_sweep_body(pass, scratch, item, 4, scan_left); break;
+        case 5:  tile_sweep_body(pass, scratch, item, 5, scan_left); break;
+        case 6:  tile_sweep_body(pass, scratch, item, 6, scan_left); break;
+        default: tile_sweep_body(pass, scratch, item, pass->world->chunk_shift, scan_left); break;
+    }
+
+    deferred_unbind();
+}
+
+void grid_iterate_parallel(Simulation* sim, World* world, IterDirection dir,
+                           CellUpdateFunc func, void* userdata) {
+    TilePass pass = {
+        .sim = sim,
+        .world = world,
+        .func = func,
+        .userdata = userdata,
+        .top_down = (dir == ITER_TOP_DOWN),
+        .period = 2 * world->chunk_size + 2 * GRID_TILE_MARGIN,
+        .width = 2 * world->chunk_size + GRID_TILE_MARGIN - 1,
+    };
+    uint32_t seed = simulation_rand(sim);
+
+    uint32_t row_cost[CHUNKS_Y_MAX];
+    uint32_t tile_cost[CHUNKS_X_MAX + 1];
+    world_chunk_row_costs(world, row_cost);
+
+    /* Chunk rows in sweep order, so every row sees the one swept before it
+     * finished, as in the serial sweep */
+    for (int r = 0; r < world->chunks_y; r++) {
+        pass.chunk_y = pass.top_down ? r : world->chunks_y - 1 - r;
+        if (row_cost[pass.chunk_y] == 0) continue;
+        pass.seed = hash32(seed ^ ((uint32_t)pass.chunk_y * 0x85EBCA6Bu));
+
+        for (pass.phase = 0; pass.phase < 2; pass.phase++) {
+            int count = tile_count(&pass);
+            tile_costs(&pass, count, tile_cost);
+            workers_parallel_for_costed(sim->workers, count, tile_cost, tile_task, &pass);
+            deferred_merge(world, sim->scratch, workers_concurrency(sim->workers));
+        }
+    }
+}
@@ -0,0 +1,315 @@
+/*
+ * intent.c - Intent/Resolve Double-Buffered Movement Implementation
+ *
+ * Invariants:
+ *   - world->intent is zero everywhere outside intent_update, so the resolve
+ *     phase can read neighbor intents at chunk borders without clearing.
+ *   - A target only accepts a claimant if it is not moving itself, so every
+ *     granted swap pairs a mover with a resting cell and pairs never overlap.
+ */
+#include "world/intent.h"
+#include "world/cell_ops.h"
+#include "world/deferred.h"
+#include "materials/material.h"
+#include "materials/behavior.h"
+#include "engine/kernels.h"
+#include "core/utils.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define INTENT_DIR_MASK  0xFu
+
+/* =============================================================================
+ * Pass Context
+ * ============================================================================= */
+
+typedef struct {
+    Simulation* sim;
+    World* world;
+    MaterialState state;
+    uint32_t seed;
+    bool ignore_updated;                /* Repeated pass within one tick */
+    const bool* region;                 /* Active chunks dilated by one ring */
+    int workers;                        /* > 1: bands run concurrently */
+    uint8_t movers[KERNEL_LUT_SIZE];    /* Materials of this state (fire excluded) */
+} IntentContext;
+
+/* NEIGHBOR8 index for an offset (center excluded) */
+static inline int intent_dir_index(int dx, int dy) {
+    int k = (dy + 1) * 3 + (dx + 1);
+    return (k > 4) ? k - 1 : k;
+}
+
+static void intent_move_table(MaterialState state, const MoveOffset** table, int* count) {
+    switch (state) {
+        case STATE_POWDER: *table = POWDER_MOVE_PRIORITY; *count = POWDER_MOVE_COUNT; break;
+        case STATE_FLUID:  *table = FLUID_MOVE_PRIORITY;  *count = FLUID_MOVE_COUNT;  break;
+        case STATE_GAS:    *table = GAS_MOVE_PRIORITY;    *count = GAS_MOVE_COUNT;    break;
+        default:           *table = NULL;                 *count = 0;                 break;
+    }
+}
+
+/* =============================================================================
+ * Phase 1: Intent
+ * ============================================================================= */
+
+/* Pick a target for one mover, returns packed intent or 0 to stay */
+static uint32_t intent_choose(const World* world, MaterialState state,
+                              MaterialID mat, int x, int y, uint32_t h) {
+    const MoveOffset* table;
+    int count;
+    intent_move_table(state, &table, &count);
+
+    const MaterialProps* props = material_get(mat);
+    int rank = 0;
+
+    /* Entries with the same dy form a rank; both sides tried in random order */
+    for (int i = 0; i < count; rank++) {
+        int n = (i + 1 < count && table[i + 1].dy == table[i].dy) ? 2 : 1;
+        MoveOffset head = table[i];
+        float roll = (float)(hash32(h + (uint32_t)rank) & 0xFFFF) / 65535.0f;
+
+        /* Lateral flow is gated by flow_rate, powder slides by cohesion */
+        bool allowed = true;
+        if (head.dy == 0) {
+            allowed = roll < props->flow_rate;
+        } else if (head.dx != 0 && state == STATE_POWDER) {
+            allowed = roll >= props->cohesion;
+        }
+
+        if (allowed) {
+            int first = (n == 2) ? (int)((h >> rank) & 1) : 0;
+            for (int k = 0; k < n; k++) {
+                MoveOffset m = table[i + (first ^ k)];
+                int tx = x + m.dx, ty = y + m.dy;
+                if (!IN_BOUNDS(tx, ty)) continue;
+                if (!cell_mover_can_enter(world, state, mat, IDX(tx, ty))) continue;
+
+                return (h & ~INTENT_DIR_MASK) | (uint32_t)(intent_dir_index(m.dx, m.dy) + 1);
+            }
+        }
+        i += n;
+    }
+    return 0;
+}
+
+static void intent_phase_task(void* ctx_ptr, int chunk_y, int worker) {
+    (void)worker;
+    IntentContext* ctx = (IntentContext*)ctx_ptr;
+    World* world = ctx->world;
+    int y_end = MIN((chunk_y + 1) * world->chunk_size, GRID_HEIGHT);
+
+    for (int cx = 0; cx < world->chunks_x; cx++) {
+        if (!world_is_chunk_active(world, cx, chunk_y)) continue;
+        int x_start = cx * world->chunk_size;
+        int x_end = MIN(x_start + world->chunk_size, GRID_WIDTH);
+
+        for (int y = chunk_y * world->chunk_size; y < y_end; y++) {
+            /* Pieces of at most 64 cells: one classification mask each,
+             * and per-cell hashes only where something moves */
+            for (int x0 = x_start; x0 < x_end; x0 += 64) {
+                int n = MIN(64, x_end - x0);
+                int first = IDX(x0, y);
+                uint64_t bits = kernels.row_classify(&world->mat[first], n, ctx->movers);
+                if (!bits) continue;
+
+                uint32_t hashes[64];
+                kernels.rng_fill(hashes, n, ctx->seed, (uint32_t)first);
+
+                while (bits) {
+                    int i = __builtin_ctzll(bits);
+                    bits &= bits - 1;
+                    int idx = first + i;
+                    if (!ctx->ignore_updated && (world->flags[idx] & FLAG_UPDATED)) continue;
+                    world->intent[idx] = intent_choose(world, ctx->state, world->mat[idx],
+                                                       x0 + i, y, hashes[i]);
+                }
+            }
+        }
+    }
+}
+
+/* =============================================================================
+ * Phase 2: Resolve (writes mat_next)
+ * ============================================================================= */
+
+static void copy_phase_task(void* ctx_ptr, int chunk_y, int worker) {
+    (void)worker;
+    World* world = ((IntentContext*)ctx_ptr)->world;
+    int y_start = chunk_y * world->chunk_size;
+    int y_end = MIN(y_start + world->chunk_size, GRID_HEIGHT);
+    size_t offset = (size_t)IDX(0, y_start);
+    size_t count = (size_t)(y_end - y_start) * GRID_WIDTH;
+
+    memcpy(world->mat_next + offset, world->mat + offset, count * sizeof(MaterialID));
+}
+
+static void resolve_phase_task(void* ctx_ptr, int chunk_y, int worker) {
+    (void)worker;
+    IntentContext* ctx = (IntentContext*)ctx_ptr;
+    World* world = ctx->world;
+    int y_end = MIN((chunk_y + 1) * world->chunk_size, GRID_HEIGHT);
+
+    for (int cx = 0; cx < world->chunks_x; cx++) {
+        if (!ctx->region[chunk_y * world->chunks_x + cx]) continue;
+        int x_start = cx * world->chunk_size;
+        int x_end = MIN(x_start + world->chunk_size, GRID_WIDTH);
+
+        for (int y = chunk_y * world->chunk_size; y < y_end; y++) {
+            for (int x = x_start; x < x_end; x++) {
+                int t = IDX(x, y);
+                world->intent_grant[t] = 0;
+
+                /* Movers are never targets */
+                if (world->intent[t] != 0) continue;
+
+                uint32_t best = 0;
+                int best_k = -1;
+                for (int k = 0; k < 8; k++) {
+                    int nx = x + NEIGHBOR8_DX[k];
+                    int ny = y + NEIGHBOR8_DY[k];
+                    if (!IN_BOUNDS(nx, ny)) continue;
+
+                    /* Neighbor at offset k claims us if it moves along 7 - k */
+                    uint32_t v = world->intent[IDX(nx, ny)];
+                    if ((v & INTENT_DIR_MASK) != (uint32_t)(8 - k)) continue;
+                    if (v > best) {
+                        best = v;
+                        best_k = k;
+                    }
+                }
+
+                if (best_k >= 0) {
+                    int src = IDX(x + NEIGHBOR8_DX[best_k], y + NEIGHBOR8_DY[best_k]);
+                    world->mat_next[t] = world->mat[src];
+                    world->mat_next[src] = world->mat[t];
+                    world->intent_grant[t] = (uint8_t)(best_k + 1);
+                }
+            }
+        }
+    }
+}
+
+/* =============================================================================
+ * Phase 3: Apply payload swaps (after buffer swap)
+ * ============================================================================= */
+
+static void apply_phase_task(void* ctx_ptr, int chunk_y, int worker) {
+    IntentContext* ctx = (IntentContext*)ctx_ptr;
+    World* world = ctx->world;
+    int y_end = MIN((chunk_y + 1) * world->chunk_size, GRID_HEIGHT);
+    uint32_t updated = 0;
+
+    /* Collect activations per thread; all swaps were resolved already */
+    ThreadScratch* scratch = NULL;
+    if (ctx->workers > 1) {
+        scratch = &ctx->sim->scratch[worker];
+        deferred_bind(scratch, 0);
+    }
+
+    for (int cx = 0; cx < world->chunks_x; cx++) {
+        if (!ctx->region[chunk_y * world->chunks_x + cx]) continue;
+        int x_start = cx * world->chunk_size;
+        int x_end = MIN(x_start + world->chunk_size, GRID_WIDTH);
+        uint32_t chunk_updated = 0;
+
+        for (int y = chunk_y * world->chunk_size; y < y_end; y++) {
+            for (int x = x_start; x < x_end; x++) {
+                int t = IDX(x, y);
+
+                /* Restore the zero-intent invariant */
+                world->intent[t] = 0;
+
+                int grant = world->intent_grant[t];
+                if (grant == 0) continue;
+
+                int sx = x + NEIGHBOR8_DX[grant - 1];
+                int sy = y + NEIGHBOR8_DY[grant - 1];
+                int s = IDX(sx, sy);
+
+                uint8_t tmp_variant = world->color_variant[t];
+                world->color_variant[t] = world->color_variant[s];
+                world->color_variant[s] = tmp_variant;
+
+                Fixed8 tmp_vx = world->vel_x[t];
+                Fixed8 tmp_vy = world->vel_y[t];
+                world->vel_x[t] = world->vel_x[s];
+                world->vel_y[t] = world->vel_y[s];
+                world->vel_x[s] = tmp_vx;
+                world->vel_y[s] = tmp_vy;
+
+                uint8_t tmp_life = world->lifetime[t];
+                world->lifetime[t] = world->lifetime[s];
+                world->lifetime[s] = tmp_life;
+
+                world->flags[t] |= FLAG_UPDATED;
+                world->flags[s] |= FLAG_UPDATED;
+
+                world_activate_chunk_at(world, x, y);
+                world_activate_chunk_at(world, sx, sy);
+                chunk_updated++;
+            }
+        }
+
+        /* Cost estimate for next tick's scheduling */
+        world->chunk_cost_next[chunk_y * world->chunks_x + cx] += chunk_updated;
+        updated += chunk_updated;
+    }
+
+    if (scratch) {
+        scratch->cells_updated += updated;
+        deferred_unbind();
+    } else {
+        world->cells_updated += updated;
+    }
+}
+
+/* =============================================================================
+ * Main Update
+ * ============================================================================= */
+
+void intent_update(Simulation* sim, World* world, MaterialState state, int pass) {
+    bool* region = world->intent_region;
+    memset(region, 0, (size_t)world->chunk_count * sizeof(bool));
+
+    /* Targets may lie one chunk outside the active set */
+    for (int cy = 0; cy < world->chunks_y; cy++) {
+        for (int cx = 0; cx < world->chunks_x; cx++) {
+            if (!world_is_chunk_active(world, cx, cy)) continue;
+            for (int dy = -1; dy <= 1; dy++) {
+                for (int dx = -1; dx <= 1; dx++) {
+                    int nx = cx + dx, ny = cy + dy;
+                    if (nx < 0 || nx >= world->chunks_x || ny < 0 || ny >= world->chunks_y) continue;
+                    region[ny * world->chunks_x + nx] = true;
+                }
+            }
+        }
+    }
+
+    IntentContext ctx = {
+        .sim = sim,
+        .world = world,
+        .state = state,
+        .seed = simulation_rand(sim),
+        .ignore_updated = (pass > 0),
+        .workers = workers_concurrency(sim->workers),
+        .region = region,
+    };
+    for (int m = 0; m < MAT_COUNT; m++) {
+        ctx.movers[m] = (material_state((MaterialID)m) == state && m != MAT_FIRE);
+    }
+
+    /* The copy is uniform; the other phases scale with last tick's work */
+    uint32_t row_cost[CHUNKS_Y_MAX];
+    world_chunk_row_costs(world, row_cost);
+
+    workers_parallel_for(sim->workers, world->chunks_y, copy_phase_task, &ctx);
+    workers_parallel_for_costed(sim->workers, world->chunks_y, row_cost, intent_phase_task, &ctx);
+    workers_parallel_for_costed(sim->workers, world->chunks_y, row_cost, resolve_phase_task, &ctx);
+
+    world_swap_buffers(world);
+    workers_parallel_for_costed(sim->workers, world->chunks_y, row_cost, apply_phase_task, &ctx);
+    if (ctx.workers > 1) {
+        deferred_merge(world, sim->scratch, ctx.workers);
+    }
+}
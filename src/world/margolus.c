@@ -0,0 +1,242 @@
+/*
+ * margolus.c - Margolus Block Cellular Automaton Implementation
+ *
+ * Each 2x2 block is viewed in the "gravity frame" of the processed state:
+ *
+ *     up row:    [a][b]      powder/fluid: up = y,     down = y + 1
+ *     down row:  [c][d]      gas:          up = y + 1, down = y
+ *
+ * Transition (all moves are swaps inside the block):
+ *   1. Vertical:  a -> c, b -> d       (fall for powder/fluid, rise for gas)
+ *   2. Diagonal:  a -> d, b -> c       (random order, cohesion for powders)
+ *   3. Lateral:   a <-> b, c <-> d     (fluids and gases, scaled by flow_rate)
+ *
+ * A cell moves at most once per block, and a block never touches cells
+ * outside itself, so blocks can be evaluated independently.
+ */
+#include "world/margolus.h"
+#include "world/cell_ops.h"
+#include "world/deferred.h"
+#include "materials/material.h"
+#include "core/utils.h"
+
+/* =============================================================================
+ * Block Cell Helpers
+ * ============================================================================= */
+
+typedef struct {
+    int x[4];
+    int y[4];
+    int idx[4];
+} MargolusBlock;
+
+/* Cell belongs to the processed state and may move this tick */
+static inline bool margolus_is_mover(const World* world, MaterialState state, int idx) {
+    MaterialID mat = world->mat[idx];
+    if (material_state(mat) != state) return false;
+    if (mat == MAT_FIRE) return false;  /* Fire movement is owned by fire_update */
+    return (world->flags[idx] & FLAG_UPDATED) == 0;
+}
+
+static inline void margolus_swap(World* world, const MargolusBlock* blk, int i, int j) {
+    world_swap_cells(world, blk->x[i], blk->y[i], blk->x[j], blk->y[j]);
+    world->flags[blk->idx[i]] |= FLAG_UPDATED;
+    world->flags[blk->idx[j]] |= FLAG_UPDATED;
+}
+
+/* Check if any chunk touched by the block starting at (x0, y0) is active */
+static inline bool margolus_block_active(const World* world, int x0, int y0) {
+    int cx0 = x0 >> world->chunk_shift, cy0 = y0 >> world->chunk_shift;
+    int cx1 = (x0 + 1) >> world->chunk_shift, cy1 = (y0 + 1) >> world->chunk_shift;
+
+    if (world_is_chunk_active(world, cx0, cy0)) return true;
+    if (cx0 == cx1 && cy0 == cy1) return false;
+    return world_is_chunk_active(world, cx1, cy0) ||
+           world_is_chunk_active(world, cx0, cy1) ||
+           world_is_chunk_active(world, cx1, cy1);
+}
+
+/* =============================================================================
+ * Block Transition
+ * ============================================================================= */
+
+/* Apply the transition to one block, returns number of swaps performed */
+static int margolus_step_block(World* world, MaterialState state,
+                               const MargolusBlock* blk, uint32_t h) {
+    const int A = 0, B = 1, C = 2;
+    unsigned moved = 0;
+    int swaps = 0;
+
+    /* Quick reject: nothing of this state in the up row and no lateral rule */
+    bool mover_a = margolus_is_mover(world, state, blk->idx[A]);
+    bool mover_b = margolus_is_mover(world, state, blk->idx[B]);
+    bool lateral = (state != STATE_POWDER);
+    if (!mover_a && !mover_b && !lateral) return 0;
+
+    /* 1. Vertical moves */
+    for (int col = 0; col < 2; col++) {
+        int up = A + col, dn = C + col;
+        if (!(col == 0 ? mover_a : mover_b)) continue;
+        if (cell_mover_can_enter(world, state, world->mat[blk->idx[up]], blk->idx[dn])) {
+            margolus_swap(world, blk, up, dn);
+            moved |= (1u << up) | (1u << dn);
+            swaps++;
+        }
+    }
+
+    /* 2. Diagonal moves, random order so neither side is favoured */
+    int first = (int)(h & 1);
+    for (int k = 0; k < 2; k++) {
+        int col = first ^ k;
+        int up = A + col, dn = C + (col ^ 1);
+        if (moved & ((1u << up) | (1u << dn))) continue;
+        if (!(col == 0 ? mover_a : mover_b)) continue;
+
+        MaterialID mat = world->mat[blk->idx[up]];
+        if (!cell_mover_can_enter(world, state, mat, blk->idx[dn])) continue;
+
+        /* Cohesion: chance for powders to hold their slope */
+        if (state == STATE_POWDER) {
+            float roll = (float)((h >> (8 + 8 * k)) & 0xFF) / 255.0f;
+            if (roll < material_get(mat)->cohesion) continue;
+        }
+
+        margolus_swap(world, blk, up, dn);
+        moved |= (1u << up) | (1u << dn);
+        swaps++;
+    }
+
+    /* 3. Lateral spreading within each row (fluids and gases) */
+    if (lateral) {
+        uint32_t h2 = hash32(h);
+        for (int row = 0; row < 2; row++) {
+            int l = row * 2, r = l + 1;
+            if (moved & ((1u << l) | (1u << r))) continue;
+
+            bool mover_l = margolus_is_mover(world, state, blk->idx[l]);
+            bool mover_r = margolus_is_mover(world, state, blk->idx[r]);
+            if (mover_l == mover_r) continue;
+
+            int src = mover_l ? l : r;
+            int dst = mover_l ? r : l;
+            MaterialID mat = world->mat[blk->idx[src]];
+            if (!cell_mover_can_enter(world, state, mat, blk->idx[dst])) continue;
+
+            float roll = (float)((h2 >> (16 * row)) & 0xFFFF) / 65535.0f;
+            if (roll >= material_get(mat)->flow_rate) continue;
+
+            margolus_swap(world, blk, src, dst);
+            moved |= (1u << src) | (1u << dst);
+            swaps++;
+        }
+    }
+
+    return swaps;
+}
+
+/* =============================================================================
+ * Block Row Iteration
+ * ============================================================================= */
+
+int margolus_block_rows(const World* world, int offset) {
+    (void)world;
+    return (GRID_HEIGHT - offset) / 2;
+}
+
+uint32_t margolus_update_rows(World* world, MaterialState state,
+                              int offset, uint32_t seed, bool clear_updated,
+                              int block_row_start, int block_row_end) {
+    bool rising = (state == STATE_GAS);
+    int block_cols = (GRID_WIDTH - offset) / 2;
+    uint32_t updated = 0;
+
+    for (int by = block_row_start; by < block_row_end; by++) {
+        int y0 = offset + by * 2;
+        int up_y = rising ? y0 + 1 : y0;
+        int dn_y = rising ? y0 : y0 + 1;
+
+        for (int bx = 0; bx < block_cols; bx++) {
+            int x0 = offset + bx * 2;
+            if (!margolus_block_active(world, x0, y0)) continue;
+
+            MargolusBlock blk = {
+                .x   = { x0, x0 + 1, x0, x0 + 1 },
+                .y   = { up_y, up_y, dn_y, dn_y },
+                .idx = { IDX(x0, up_y), IDX(x0 + 1, up_y),
+                         IDX(x0, dn_y), IDX(x0 + 1, dn_y) },
+            };
+
+            /* Later passes: cells moved by the previous pass may move again.
+             * Every cell is in exactly one block, so clearing here equals
+             * clearing before the pass. */
+            if (clear_updated) {
+                for (int i = 0; i < 4; i++) world->flags[blk.idx[i]] &= (CellFlags)~FLAG_UPDATED;
+            }
+
+            /* Per-block randomness: independent of processing order */
+            uint32_t h = hash32(seed ^ ((uint32_t)bx * 0x9E3779B1u) ^
+                                ((uint32_t)by * 0x85EBCA77u));
+            updated += (uint32_t)margolus_step_block(world, state, &blk, h);
+        }
+    }
+
+    return updated;
+}
+
+typedef struct {
+    Simulation* sim;
+    World* world;
+    MaterialState state;
+    int offset;
+    uint32_t seed;
+    bool clear_updated;       /* pass > 0 */
+    int workers;              /* > 1: rows run concurrently */
+} MargolusContext;
+
+static void margolus_row_task(void* ctx_ptr, int block_row, int worker) {
+    MargolusContext* ctx = (MargolusContext*)ctx_ptr;
+    World* world = ctx->world;
+
+    if (ctx->workers == 1) {
+        world->cells_updated += margolus_update_rows(world, ctx->state, ctx->offset,
+                                                     ctx->seed, ctx->clear_updated,
+                                                     block_row, block_row + 1);
+        return;
+    }
+
+    /* Blocks never leave their rows; scratch only collects activations */
+    ThreadScratch* scratch = &ctx->sim->scratch[worker];
+    deferred_bind(scratch, 0);
+    scratch->cells_updated += margolus_update_rows(world, ctx->state, ctx->offset,
+                                                   ctx->seed, ctx->clear_updated,
+                                                   block_row, block_row + 1);
+    deferred_unbind();
+}
+
+void margolus_update(Simulation* sim, World* world, MaterialState state, int pass) {
+    /* Alternate block partition every step so material crosses block edges */
+    MargolusContext ctx = {
+        .sim = sim,
+        .world = world,
+        .state = state,
+        .offset = (int)((sim->tick_count + (uint64_t)pass) & 1),
+        .seed = simulation_rand(sim),
+        .clear_updated = pass > 0,
+        .workers = workers_concurrency(sim->workers),
+    };
+
+    /* Each block row inherits the cost of the chunk row it starts in */
+    uint32_t row_cost[CHUNKS_Y_MAX];
+    world_chunk_row_costs(world, row_cost);
+
+    int rows = margolus_block_rows(world, ctx.offset);
+    uint32_t* block_cost = world->margolus_cost;
+    for (int by = 0; by < rows; by++) {
+        block_cost[by] = row_cost[(ctx.offset + by * 2) >> world->chunk_shift];
+    }
+
+    workers_parallel_for_costed(sim->workers, rows, block_cost, margolus_row_task, &ctx);
+    if (ctx.workers > 1) {
+        deferred_merge(world, sim->scratch, ctx.workers);
+    }
+}
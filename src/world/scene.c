@@ -0,0 +1,534 @@
+/*
+ * scene.c - Named starting scenes and scene files
+ *
+ * Scenes are written a row span at a time straight into the planes; chunks
+ * are activated once at the end, so even large worlds load in a few
+ * milliseconds.
+ */
+#include "world/scene.h"
+#include "physics/thermal.h"
+#include "core/utils.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SCENE_ANY_MAT   (-1)      /* scene_heat_rect: no material filter */
+#define SCENE_LINE_MAX  512
+#define SCENE_ARGS_MAX  10
+#define SCENE_COLOR_MAX 64        /* Image colour mappings per file */
+
+/* =============================================================================
+ * Fill Helpers
+ * ============================================================================= */
+
+/* Set cells [x0, x1) of row y with whole-span writes; chunk activation is
+ * left to scene_finish */
+static void scene_span(World* world, int y, int x0, int x1, MaterialID mat) {
+    x0 = MAX(x0, 0);
+    x1 = MIN(x1, world->width);
+    if (y < 0 || y >= world->height || x0 >= x1) return;
+
+    size_t start = (size_t)IDX(x0, y), n = (size_t)(x1 - x0);
+    memset(world->mat + start, mat, n * sizeof(MaterialID));
+    memset(world->vel_x + start, 0, n * sizeof(Fixed8));
+    memset(world->vel_y + start, 0, n * sizeof(Fixed8));
+}
+
+static inline void scene_cell(World* world, int idx, MaterialID mat) {
+    world->mat[idx] = mat;
+    world->vel_x[idx] = 0;
+    world->vel_y[idx] = 0;
+}
+
+/* Fill [x0, x1) x [y0, y1); cells whose index hash has no bit of
+ * density_mask set (mask 0: every cell, 1: about half, 3: a quarter) */
+static void scene_fill_rect(World* world, int x0, int y0, int x1, int y1,
+                            MaterialID mat, uint32_t density_mask, uint32_t salt) {
+    for (int y = MAX(y0, 0); y < MIN(y1, world->height); y++) {
+        if (density_mask == 0) {
+            scene_span(world, y, x0, x1, mat);
+            continue;
+        }
+        for (int x = MAX(x0, 0); x < MIN(x1, world->width); x++) {
+            if ((hash32((uint32_t)IDX(x, y) ^ salt) & density_mask) == 0) {
+                scene_cell(world, IDX(x, y), mat);
+            }
+        }
+    }
+}
+
+/* Filled disc, one span per row (same cells as world_paint_circle) */
+static void scene_fill_circle(World* world, int cx, int cy, int radius, MaterialID mat) {
+    for (int dy = -radius; dy <= radius; dy++) {
+        int half = (int)sqrt((double)(radius * radius - dy * dy));
+        scene_span(world, cy + dy, cx - half, cx + half + 1, mat);
+    }
+}
+
+/* Lattice value noise in [0, 1): hashed corners every scale cells,
+ * smoothly interpolated (scale 1: independent per cell) */
+static float scene_noise(int x, int y, int scale, uint32_t seed) {
+    int gx = x / scale, gy = y / scale;
+    float fx = (float)(x - gx * scale) / (float)scale;
+    float fy = (float)(y - gy * scale) / (float)scale;
+    float v[4];
+
+    for (int i = 0; i < 4; i++) {
+        uint32_t key = (uint32_t)(gx + (i & 1)) * 73856093u ^ (uint32_t)(gy + (i >> 1)) * 19349663u;
+        v[i] = (float)(hash32(hash32(key) ^ seed) >> 8) * (1.0f / 16777216.0f);
+    }
+    fx = fx * fx * (3.0f - 2.0f * fx);
+    fy = fy * fy * (3.0f - 2.0f * fy);
+    float top = v[0] + (v[1] - v[0]) * fx;
+    float bottom = v[2] + (v[3] - v[2]) * fx;
+    return top + (bottom - top) * fy;
+}
+
+/* Fill the cells of [x0, x1) x [y0, y1) whose noise is below density */
+static void scene_fill_noise(World* world, int x0, int y0, int x1, int y1, MaterialID mat,
+                             float density, int scale, uint32_t seed) {
+    for (int y = MAX(y0, 0); y < MIN(y1, world->height); y++) {
+        for (int x = MAX(x0, 0); x < MIN(x1, world->width); x++) {
+            if (scene_noise(x, y, scale, seed) < density) {
+                scene_cell(world, IDX(x, y), mat);
+            }
+        }
+    }
+}
+
+/* Set the temperature of the cells of [x0, x1) x [y0, y1) holding mat
+ * (SCENE_ANY_MAT: every cell) */
+static void scene_heat_rect(World* world, int x0, int y0, int x1, int y1, int mat, float temp) {
+    for (int y = MAX(y0, 0); y < MIN(y1, world->height); y++) {
+        for (int x = MAX(x0, 0); x < MIN(x1, world->width); x++) {
+            int idx = IDX(x, y);
+            if (mat != SCENE_ANY_MAT && world->mat[idx] != mat) continue;
+            world->temp[idx] = temp;
+            world->temp_next[idx] = temp;
+        }
+    }
+}
+
+/* Empty world at room temperature */
+static void scene_begin(World* world) {
+    world_clear(world);
+    for (int i = 0; i < world->width * world->height; i++) {
+        world->temp[i] = 20.0f;
+        world->temp_next[i] = 20.0f;
+    }
+}
+
+/* Activate all chunks so the first tick visits the whole scene */
+static void scene_finish(World* world) {
+    for (int cy = 0; cy < world->chunks_y; cy++) {
+        for (int cx = 0; cx < world->chunks_x; cx++) {
+            world_activate_chunk(world, cx, cy);
+        }
+    }
+    world_update_chunk_activation(world);
+}
+
+/* =============================================================================
+ * Scenes
+ * ============================================================================= */
+
+/* Ground, side walls and a platform in the middle */
+static void scene_default(World* world) {
+    int w = world->width, h = world->height;
+
+    scene_fill_rect(world, 0, h - 10, w, h, MAT_STONE, 0, 0);
+    scene_fill_rect(world, 0, 0, 10, h, MAT_STONE, 0, 0);
+    scene_fill_rect(world, w - 10, 0, w, h, MAT_STONE, 0, 0);
+    scene_fill_rect(world, w * 150 / 512, h * 350 / 512, w * 350 / 512, h * 360 / 512,
+                    MAT_STONE, 0, 0);
+}
+
+/* A solid sand heap collapsing down a stone ramp, with sparse sand
+ * raining over the lower end */
+static void scene_sand_avalanche(World* world) {
+    int w = world->width, h = world->height;
+
+    for (int x = 0; x < w; x++) {
+        int top = h / 2 + (int)((int64_t)x * h / (4 * w));
+        scene_fill_rect(world, x, top, x + 1, h, MAT_STONE, 0, 1);
+    }
+    scene_fill_rect(world, 0, h / 16, w / 2, h / 2, MAT_SAND, 0, 2);
+    scene_fill_rect(world, w / 2, h / 16, w, h / 4, MAT_SAND, 3, 3);
+}
+
+/* A deep water column behind a divider, draining through a gap at the
+ * bottom into a shallow pool */
+static void scene_water_tank(World* world) {
+    int w = world->width, h = world->height;
+    int wall = MAX(w / 32, 1);
+
+    scene_fill_rect(world, 0, h - h / 16, w, h, MAT_STONE, 0, 1);
+    scene_fill_rect(world, 0, 0, wall, h, MAT_STONE, 0, 1);
+    scene_fill_rect(world, w - wall, 0, w, h, MAT_STONE, 0, 1);
+    scene_fill_rect(world, w / 2 - wall / 2, h / 8, w / 2 + wall / 2 + 1, h * 13 / 16,
+                    MAT_STONE, 0, 1);
+    scene_fill_rect(world, wall, h / 8, w / 2 - wall / 2, h - h / 16, MAT_WATER, 0, 2);
+    scene_fill_rect(world, w / 2 + wall / 2 + 1, h * 11 / 16, w - wall, h - h / 16,
+                    MAT_WATER, 0, 3);
+}
+
+/* A row of trees with touching canopies on soil, lit at the first trunk */
+static void scene_forest_fire(World* world) {
+    int w = world->width, h = world->height;
+    int trunk = MAX(w / 128, 1);
+
+    scene_fill_rect(world, 0, h * 13 / 16, w, h, MAT_SOIL, 0, 1);
+    for (int i = 0; i < 8; i++) {
+        int cx = w / 16 + i * w / 8;
+        scene_fill_rect(world, cx - trunk, h / 2, cx + trunk, h * 13 / 16, MAT_WOOD, 0, 2);
+        scene_fill_rect(world, cx - w / 16, h * 3 / 8, cx + w / 16, h / 2, MAT_WOOD, 1, 3);
+    }
+    scene_fill_rect(world, w / 16 - w / 32, h * 12 / 16, w / 16 + w / 32, h * 13 / 16,
+                    MAT_FIRE, 1, 4);
+}
+
+/* A stone pot of near-boiling water on a hot base over burning wood */
+static void scene_boiling_pot(World* world) {
+    int w = world->width, h = world->height;
+    int wall = MAX(w / 32, 1);
+
+    scene_fill_rect(world, 0, h - h / 16, w, h, MAT_STONE, 0, 1);
+    scene_fill_rect(world, w / 4, h / 4, w / 4 + wall, h * 5 / 8, MAT_STONE, 0, 1);
+    scene_fill_rect(world, w * 3 / 4 - wall, h / 4, w * 3 / 4, h * 5 / 8, MAT_STONE, 0, 1);
+    scene_fill_rect(world, w / 4, h * 5 / 8, w * 3 / 4, h * 5 / 8 + wall, MAT_STONE, 0, 1);
+    scene_fill_rect(world, w / 4 + wall, h * 5 / 16, w * 3 / 4 - wall, h * 5 / 8,
+                    MAT_WATER, 0, 2);
+    scene_fill_rect(world, w / 4, h * 11 / 16, w * 3 / 4, h - h / 16, MAT_WOOD, 0, 3);
+    scene_fill_rect(world, w / 4, h * 5 / 8 + wall, w * 3 / 4, h * 11 / 16, MAT_FIRE, 1, 4);
+
+    scene_heat_rect(world, 0, 0, w, h, MAT_WATER, 98.0f);
+    scene_heat_rect(world, 0, 0, w, h, MAT_FIRE, 600.0f);
+    scene_heat_rect(world, w / 4, h * 5 / 8, w * 3 / 4, h * 5 / 8 + wall, MAT_STONE, 600.0f);
+}
+
+/* Sand, soil and wood blocks dropping into an acid pool in a stone pit */
+static void scene_acid_pit(World* world) {
+    int w = world->width, h = world->height;
+    int wall = MAX(w / 32, 1);
+
+    scene_fill_rect(world, 0, h - h / 16, w, h, MAT_STONE, 0, 1);
+    scene_fill_rect(world, w / 8, h / 2, w / 8 + wall, h - h / 16, MAT_STONE, 0, 1);
+    scene_fill_rect(world, w * 7 / 8 - wall, h / 2, w * 7 / 8, h - h / 16, MAT_STONE, 0, 1);
+    scene_fill_rect(world, w / 8 + wall, h * 11 / 16, w * 7 / 8 - wall, h - h / 16,
+                    MAT_ACID, 0, 2);
+    scene_fill_rect(world, w / 4, h / 8, w / 2, h / 4, MAT_SAND, 0, 3);
+    scene_fill_rect(world, w * 9 / 16, h / 16, w * 3 / 4, h / 4, MAT_SOIL, 0, 4);
+    scene_fill_rect(world, w * 3 / 8, h / 3, w * 5 / 8, h * 3 / 8, MAT_WOOD, 0, 5);
+}
+
+/* A mix of every subsystem: falling sand, a water body, rising smoke, a
+ * fire on a wooden floor and acid on stone */
+static void scene_mixed(World* world) {
+    int w = world->width, h = world->height;
+
+    scene_fill_rect(world, 0, h - h / 16, w, h, MAT_STONE, 0, 1);
+    scene_fill_rect(world, w / 16, h / 8, w * 5 / 16, h / 2, MAT_SAND, 1, 2);
+    scene_fill_rect(world, w * 6 / 16, h / 4, w * 10 / 16, h * 3 / 4, MAT_WATER, 0, 3);
+    scene_fill_rect(world, w * 11 / 16, h / 2, w * 15 / 16, h * 13 / 16, MAT_SMOKE, 3, 4);
+    scene_fill_rect(world, w / 16, h * 13 / 16, w * 5 / 16, h * 14 / 16, MAT_WOOD, 0, 5);
+    scene_fill_rect(world, w / 16, h * 12 / 16, w * 5 / 16, h * 13 / 16, MAT_FIRE, 7, 6);
+    scene_fill_rect(world, w * 11 / 16, h * 14 / 16, w * 15 / 16, h * 15 / 16, MAT_ACID, 1, 7);
+}
+
+static const SceneDesc SCENES[] = {
+    {"default",        "Ground, walls and a platform (interactive start)", scene_default},
+    {"sand-avalanche", "Sand heap collapsing down a ramp",                 scene_sand_avalanche},
+    {"water-tank",     "Deep water column draining under a divider",       scene_water_tank},
+    {"forest-fire",    "Fire spreading through a row of trees",            scene_forest_fire},
+    {"boiling-pot",    "Hot water boiling over a wood fire",               scene_boiling_pot},
+    {"acid-pit",       "Blocks dissolving in an acid pool",                scene_acid_pit},
+    {"mixed",          "Every subsystem at once",                          scene_mixed},
+};
+
+#define SCENE_COUNT ((int)(sizeof(SCENES) / sizeof(SCENES[0])))
+
+/* =============================================================================
+ * Scene Files
+ * ============================================================================= */
+
+typedef struct {
+    World* world;
+    const char* path;
+    uint32_t colors[SCENE_COLOR_MAX];     /* RGB of each image colour mapping */
+    MaterialID color_mats[SCENE_COLOR_MAX];
+    int color_count;
+} SceneFile;
+
+/* Coordinate: whole cells, or a percentage of extent ("25%") */
+static bool scene_parse_coord(const char* text, int extent, int* value) {
+    char* end;
+    double v = strtod(text, &end);
+    if (end == text) return false;
+    if (*end == '%' && end[1] == '\0') {
+        *value = (int)floor(v * extent / 100.0 + 0.5);
+        return true;
+    }
+    if (*end != '\0' || v != floor(v) || fabs(v) > 1e9) return false;
+    *value = (int)v;
+    return true;
+}
+
+/* X0 Y0 X1 Y1 starting at args[0] */
+static bool scene_parse_rect(const World* world, char** args, int* rect) {
+    return scene_parse_coord(args[0], world->width, &rect[0]) &&
+           scene_parse_coord(args[1], world->height, &rect[1]) &&
+           scene_parse_coord(args[2], world->width, &rect[2]) &&
+           scene_parse_coord(args[3], world->height, &rect[3]);
+}
+
+static bool scene_parse_float(const char* text, float* value) {
+    char* end;
+    *value = strtof(text, &end);
+    return end != text && *end == '\0' && isfinite(*value);
+}
+
+static bool scene_parse_int(const char* text, long min, long* value) {
+    char* end;
+    *value = strtol(text, &end, 0);
+    return end != text && *end == '\0' && *value >= min;
+}
+
+/* Skip whitespace and # comments in a PPM header */
+static void scene_ppm_skip(FILE* file) {
+    int c;
+    while ((c = fgetc(file)) != EOF) {
+        if (c == '#') {
+            while ((c = fgetc(file)) != EOF && c != '\n') {}
+        } else if (c != ' ' && c != '\t' && c != '\r' && c != '\n') {
+            ungetc(c, file);
+            return;
+        }
+    }
+}
+
+/* Binary PPM (P6, 8-bit) as packed RGB; NULL on error */
+static uint8_t* scene_read_ppm(const char* path, int* width, int* height) {
+    FILE* file = fopen(path, "rb");
+    if (!file) return NULL;
+
+    int maxval = 0;
+    uint8_t* rgb = NULL;
+    if (fgetc(file) == 'P' && fgetc(file) == '6') {
+        scene_ppm_skip(file);
+        if (fscanf(file, "%d", width) == 1) scene_ppm_skip(file);
+        if (fscanf(file, "%d", height) == 1) scene_ppm_skip(file);
+        if (fscanf(file, "%d", &maxval) == 1 && fgetc(file) != EOF &&
+            *width > 0 && *height > 0 && *width <= 65536 && *height <= 65536 &&
+            maxval > 0 && maxval < 256) {
+            size_t size = (size_t)*width * *height * 3;
+            rgb = malloc(size);
+            if (rgb && fread(rgb, 1, size, file) != size) {
+                free(rgb);
+                rgb = NULL;
+            }
+        }
+    }
+    fclose(file);
+    return rgb;
+}
+
+/* Image layer: each pixel covers scale x scale cells from (x0, y0); pixels
+ * with a mapped colour set their material, the rest are left as they are */
+static const char* scene_image_layer(SceneFile* scene, const char* image_path,
+                                     int x0, int y0, int scale) {
+    World* world = scene->world;
+    char path[SCENE_LINE_MAX * 2];
+    int width, height;
+
+    /* Relative image paths are resolved against the scene file */
+    const char* slash = strrchr(scene->path, '/');
+    if (image_path[0] != '/' && slash) {
+        snprintf(path, sizeof(path), "%.*s/%s", (int)(slash - scene->path), scene->path,
+                 image_path);
+    } else {
+        snprintf(path, sizeof(path), "%s", image_path);
+    }
+
+    uint8_t* rgb = scene_read_ppm(path, &width, &height);
+    if (!rgb) return "cannot read image (binary PPM, P6, 8-bit)";
+
+    for (int py = 0; py < height; py++) {
+        /* Runs of one mapped colour become one span per covered row */
+        int run_start = 0, run_mat = SCENE_ANY_MAT;
+        for (int px = 0; px <= width; px++) {
+            int mat = SCENE_ANY_MAT;
+            if (px < width) {
+                const uint8_t* p = &rgb[((size_t)py * width + px) * 3];
+                uint32_t color = (uint32_t)p[0] << 16 | (uint32_t)p[1] << 8 | p[2];
+                for (int i = 0; i < scene->color_count; i++) {
+                    if (scene->colors[i] == color) {
+                        mat = scene->color_mats[i];
+                        break;
+                    }
+                }
+            }
+            if (mat == run_mat) continue;
+            if (run_mat != SCENE_ANY_MAT) {
+                for (int y = y0 + py * scale; y < y0 + (py + 1) * scale; y++) {
+                    scene_span(world, y, x0 + run_start * scale, x0 + px * scale,
+                               (MaterialID)run_mat);
+                }
+            }
+            run_start = px;
+            run_mat = mat;
+        }
+    }
+    free(rgb);
+    return NULL;
+}
+
+/* Apply one command; returns an error message, NULL on success */
+static const char* scene_command(SceneFile* scene, char** args, int argc) {
+    World* world = scene->world;
+    const char* cmd = args[0];
+    MaterialID mat = MAT_EMPTY;
+    int rect[4];
+    long value;
+
+    if (strcmp(cmd, "fill") == 0 || strcmp(cmd, "rect") == 0 ||
+        strcmp(cmd, "circle") == 0 || strcmp(cmd, "noise") == 0) {
+        if (argc < 2 || !material_find(args[1], &mat)) return "unknown material";
+    }
+
+    if (strcmp(cmd, "fill") == 0) {
+        if (argc != 2) return "expected: fill MAT";
+        scene_fill_rect(world, 0, 0, world->width, world->height, mat, 0, 0);
+    } else if (strcmp(cmd, "rect") == 0) {
+        if (argc != 6 || !scene_parse_rect(world, &args[2], rect)) {
+            return "expected: rect MAT X0 Y0 X1 Y1";
+        }
+        scene_fill_rect(world, rect[0], rect[1], rect[2], rect[3], mat, 0, 0);
+    } else if (strcmp(cmd, "circle") == 0) {
+        int cx, cy, radius;
+        if (argc != 5 || !scene_parse_coord(args[2], world->width, &cx) ||
+            !scene_parse_coord(args[3], world->height, &cy) ||
+            !scene_parse_coord(args[4], world->width, &radius) || radius < 0) {
+            return "expected: circle MAT CX CY R";
+        }
+        scene_fill_circle(world, cx, cy, radius, mat);
+    } else if (strcmp(cmd, "noise") == 0) {
+        float density;
+        long scale = 1, seed = 0;
+        if (argc < 7 || argc > 9 || !scene_parse_rect(world, &args[2], rect) ||
+            !scene_parse_float(args[6], &density) || density < 0.0f || density > 1.0f ||
+            (argc > 7 && !scene_parse_int(args[7], 1, &scale)) ||
+            (argc > 8 && !scene_parse_int(args[8], 0, &seed))) {
+            return "expected: noise MAT X0 Y0 X1 Y1 DENSITY [SCALE [SEED]]";
+        }
+        scene_fill_noise(world, rect[0], rect[1], rect[2], rect[3], mat, density,
+                         (int)MIN(scale, 1 << 20), (uint32_t)seed);
+    } else if (strcmp(cmd, "temp") == 0) {
+        float temp;
+        if ((argc != 6 && argc != 7) || !scene_parse_float(args[1], &temp) ||
+            !scene_parse_rect(world, &args[2], rect)) {
+            return "expected: temp T X0 Y0 X1 Y1 [MAT]";
+        }
+        if (temp < MIN_TEMPERATURE || temp > MAX_TEMPERATURE) return "temperature out of range";
+        if (argc == 7 && !material_find(args[6], &mat)) return "unknown material";
+        scene_heat_rect(world, rect[0], rect[1], rect[2], rect[3],
+                        argc == 7 ? mat : SCENE_ANY_MAT, temp);
+    } else if (strcmp(cmd, "color") == 0) {
+        char* end;
+        unsigned long rgb = (argc == 3) ? strtoul(args[1], &end, 16) : 0;
+        if (argc != 3 || strlen(args[1]) != 6 || *end != '\0') {
+            return "expected: color RRGGBB MAT";
+        }
+        if (!material_find(args[2], &mat)) return "unknown material";
+        if (scene->color_count == SCENE_COLOR_MAX) return "too many colour mappings";
+        scene->colors[scene->color_count] = (uint32_t)rgb;
+        scene->color_mats[scene->color_count] = mat;
+        scene->color_count++;
+    } else if (strcmp(cmd, "image") == 0) {
+        int x0 = 0, y0 = 0;
+        value = 1;
+        if (argc < 4 || argc > 5 || !scene_parse_coord(args[2], world->width, &x0) ||
+            !scene_parse_coord(args[3], world->height, &y0) ||
+            (argc == 5 && !scene_parse_int(args[4], 1, &value))) {
+            return "expected: image PATH X Y [SCALE]";
+        }
+        return scene_image_layer(scene, args[1], x0, y0, (int)MIN(value, 4096));
+    } else {
+        return "unknown command";
+    }
+    return NULL;
+}
+
+/* =============================================================================
+ * Public API
+ * ============================================================================= */
+
+int scene_count(void) {
+    return SCENE_COUNT;
+}
+
+const SceneDesc* scene_get(int index) {
+    return (index >= 0 && index < SCENE_COUNT) ? &SCENES[index] : NULL;
+}
+
+const SceneDesc* scene_find(const char* name) {
+    for (int i = 0; i < SCENE_COUNT; i++) {
+        if (strcmp(SCENES[i].name, name) == 0) return &SCENES[i];
+    }
+    return NULL;
+}
+
+bool scene_build(World* world, const char* name) {
+    const SceneDesc* scene = scene_find(name);
+    if (!scene) return false;
+
+    scene_begin(world);
+    scene->build(world);
+    scene_finish(world);
+    return true;
+}
+
+bool scene_load(World* world, const char* path) {
+    char line[SCENE_LINE_MAX];
+    SceneFile scene = { .world = world, .path = path };
+
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        fprintf(stderr, "Scene: cannot open %s\n", path);
+        return false;
+    }
+
+    scene_begin(world);
+    bool ok = true;
+    for (int number = 1; ok && fgets(line, sizeof(line), file); number++) {
+        char* args[SCENE_ARGS_MAX];
+        int argc = 0;
+
+        char* comment = strchr(line, '#');
+        if (comment) *comment = '\0';
+        for (char* tok = strtok(line, " \t\r\n"); tok; tok = strtok(NULL, " \t\r\n")) {
+            if (argc == SCENE_ARGS_MAX) break;
+            args[argc++] = tok;
+        }
+        if (argc == 0) continue;
+
+        const char* error = scene_command(&scene, args, argc);
+        if (error) {
+            fprintf(stderr, "%s:%d: %s\n", path, number, error);
+            ok = false;
+        }
+    }
+    if (ok && ferror(file)) {
+        fprintf(stderr, "Scene: failed to read %s\n", path);
+        ok = false;
+    }
+    fclose(file);
+
+    scene_finish(world);
+    return ok;
+}
+
+bool scene_apply(World* world, const char* spec) {
+    if (scene_find(spec)) return scene_build(world, spec);
+    return scene_load(world, spec);
+}
@@ -2,12 +2,65 @@
  * world.c - Grid/World model implementation
  */
 #include "world/world.h"
+#include "world/deferred.h"
+#include "engine/workers.h"
 #include "core/utils.h"
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
 
+/* Initialize rows [y_start, y_end) of every per-cell plane. This is the
+ * first write to those pages, so it places them on the writer's node. */
+static void world_init_rows(World* world, int y_start, int y_end) {
+    size_t begin = (size_t)y_start * world->width;
+    size_t n = (size_t)(y_end - y_start) * world->width;
+    
+    memset(world->mat + begin, MAT_EMPTY, n * sizeof(MaterialID));
+    memset(world->mat_next + begin, MAT_EMPTY, n * sizeof(MaterialID));
+    memset(world->heat_mat + begin, MAT_EMPTY, n * sizeof(MaterialID));
+    memset(world->flags + begin, 0, n * sizeof(CellFlags));
+    memset(world->pressure + begin, 0, n * sizeof(float));
+    memset(world->density + begin, 0, n * sizeof(float));
+    memset(world->vel_x + begin, 0, n * sizeof(Fixed8));
+    memset(world->vel_y + begin, 0, n * sizeof(Fixed8));
+    memset(world->lifetime + begin, 0, n * sizeof(uint8_t));
+    memset(world->intent + begin, 0, n * sizeof(uint32_t));
+    memset(world->intent_grant + begin, 0, n * sizeof(uint8_t));
+    
+    for (size_t i = begin; i < begin + n; i++) {
+        /* Color variants: per-cell hash so rows can be filled independently */
+        world->color_variant[i] = (uint8_t)(hash32((uint32_t)i ^ 12345u) >> (32 - MATERIAL_PALETTE_SHIFT));
+        
+        /* Temperature starts at ambient */
+        world->temp[i] = 20.0f;  /* Room temperature */
+        world->temp_next[i] = 20.0f;
+    }
+}
+
+typedef struct {
+    World* world;
+    const WorkerPool* pool;
+} WorldPlacement;
+
+/* Each worker initializes the chunk rows it is home to */
+static void world_place_task(void* ctx_ptr, int item, int worker) {
+    (void)worker;
+    WorldPlacement* ctx = (WorldPlacement*)ctx_ptr;
+    World* world = ctx->world;
+    
+    for (int chunk_y = 0; chunk_y < world->chunks_y; chunk_y++) {
+        if (workers_home(ctx->pool, chunk_y, world->chunks_y) != item) continue;
+        int y_start = chunk_y * world->chunk_size;
+        int y_end = MIN(y_start + world->chunk_size, world->height);
+        world_init_rows(world, y_start, y_end);
+    }
+}
+
 World* world_create(int width, int height) {
+    return world_create_placed(width, height, NULL);
+}
+
+World* world_create_placed(int width, int height, WorkerPool* pool) {
     World* world = calloc(1, sizeof(World));
     if (!world) return NULL;
     
@@ -15,13 +68,14 @@ World* world_create(int width, int height) {
     world->height = height;
     
     size_t grid_size = (size_t)width * height;
-    size_t chunk_count = (size_t)CHUNKS_X * CHUNKS_Y;
+    size_t chunk_count = CHUNK_COUNT_MAX;
     
     /* Allocate all arrays */
     world->mat = calloc(grid_size, sizeof(MaterialID));
     world->mat_next = calloc(grid_size, sizeof(MaterialID));
+    world->heat_mat = calloc(grid_size, sizeof(MaterialID));
     world->flags = calloc(grid_size, sizeof(CellFlags));
-    world->color_seed = calloc(grid_size, sizeof(uint32_t));
+    world->color_variant = calloc(grid_size, sizeof(uint8_t));
     world->temp = calloc(grid_size, sizeof(float));
     world->temp_next = calloc(grid_size, sizeof(float));
     world->pressure = calloc(grid_size, sizeof(float));
@@ -29,40 +83,79 @@ World* world_create(int width, int height) {
     world->vel_x = calloc(grid_size, sizeof(Fixed8));
     world->vel_y = calloc(grid_size, sizeof(Fixed8));
     world->lifetime = calloc(grid_size, sizeof(uint8_t));
+    world->intent = calloc(grid_size, sizeof(uint32_t));
+    world->intent_grant = calloc(grid_size, sizeof(uint8_t));
+    world->intent_region = calloc(chunk_count, sizeof(bool));
+    world->margolus_cost = calloc((size_t)height / 2, sizeof(uint32_t));
     world->chunk_active = calloc(chunk_count, sizeof(bool));
     world->chunk_active_next = calloc(chunk_count, sizeof(bool));
+    world->chunk_cost = calloc(chunk_count, sizeof(uint32_t));
+    world->chunk_cost_next = calloc(chunk_count, sizeof(uint32_t));
+    world->chunk_warm = calloc(chunk_count, sizeof(bool));
+    world->chunk_version = calloc(chunk_count, sizeof(uint32_t));
     
     /* Check allocations */
-    if (!world->mat || !world->mat_next || !world->flags || 
-        !world->color_seed || !world->temp || !world->temp_next ||
+    if (!world->mat || !world->mat_next || !world->heat_mat || !world->flags || 
+        !world->color_variant || !world->temp || !world->temp_next ||
         !world->pressure || !world->density || !world->vel_x || !world->vel_y ||
-        !world->lifetime || !world->chunk_active || !world->chunk_active_next) {
+        !world->lifetime || !world->intent || !world->intent_grant ||
+        !world->intent_region || !world->margolus_cost ||
+        !world->chunk_active || !world->chunk_active_next ||
+        !world->chunk_cost || !world->chunk_cost_next || !world->chunk_warm ||
+        !world->chunk_version) {
         world_destroy(world);
         return NULL;
     }
     
-    /* Initialize color seeds with random values */
-    uint32_t seed = 12345;
-    for (size_t i = 0; i < grid_size; i++) {
-        world->color_seed[i] = xorshift32(&seed);
-    }
+    /* A new world is empty: no chunk needs processing yet */
+    world_set_chunk_size(world, CHUNK_SIZE_DEFAULT);
+    memset(world->chunk_active, 0, CHUNK_COUNT_MAX * sizeof(bool));
+    world->active_chunks = 0;
     
-    /* Initialize temperature to ambient */
-    for (size_t i = 0; i < grid_size; i++) {
-        world->temp[i] = 20.0f;  /* Room temperature */
-        world->temp_next[i] = 20.0f;
+    /* Band ownership: each chunk row is first touched by its home worker */
+    if (pool) {
+        WorldPlacement ctx = { .world = world, .pool = pool };
+        workers_run_each(pool, world_place_task, &ctx);
+    } else {
+        world_init_rows(world, 0, height);
     }
     
     return world;
 }
 
+bool world_set_chunk_size(World* world, int chunk_size) {
+    if (chunk_size < CHUNK_SIZE_MIN || chunk_size > CHUNK_SIZE_MAX ||
+        (chunk_size & (chunk_size - 1)) != 0) {
+        return false;
+    }
+    
+    world->chunk_size = chunk_size;
+    world->chunk_shift = __builtin_ctz((unsigned)chunk_size);
+    world->chunks_x = (world->width + chunk_size - 1) / chunk_size;
+    world->chunks_y = (world->height + chunk_size - 1) / chunk_size;
+    world->chunk_count = world->chunks_x * world->chunks_y;
+    
+    /* Old activity does not map onto the new grid: wake everything once */
+    for (int i = 0; i < CHUNK_COUNT_MAX; i++) {
+        world->chunk_active[i] = i < world->chunk_count;
+        world->chunk_active_next[i] = false;
+        world->chunk_cost[i] = 0;
+        world->chunk_cost_next[i] = 0;
+        world->chunk_warm[i] = false;
+        world->chunk_version[i]++;
+    }
+    world->active_chunks = (uint32_t)world->chunk_count;
+    return true;
+}
+
 void world_destroy(World* world) {
     if (!world) return;
     
     free(world->mat);
     free(world->mat_next);
+    free(world->heat_mat);
     free(world->flags);
-    free(world->color_seed);
+    free(world->color_variant);
     free(world->temp);
     free(world->temp_next);
     free(world->pressure);
@@ -70,19 +163,32 @@ void world_destroy(World* world) {
     free(world->vel_x);
     free(world->vel_y);
     free(world->lifetime);
+    free(world->intent);
+    free(world->intent_grant);
+    free(world->intent_region);
+    free(world->margolus_cost);
     free(world->chunk_active);
     free(world->chunk_active_next);
+    free(world->chunk_cost);
+    free(world->chunk_cost_next);
+    free(world->chunk_warm);
+    free(world->chunk_version);
     free(world);
 }
 
 void world_clear(World* world) {
-    size_t grid_size = (size_t)world->width * world->height;
-    memset(world->mat, MAT_EMPTY, grid_size * sizeof(MaterialID));
-    memset(world->mat_next, MAT_EMPTY, grid_size * sizeof(MaterialID));
-    memset(world->flags, 0, grid_size * sizeof(CellFlags));
-    memset(world->vel_x, 0, grid_size * sizeof(Fixed8));
-    memset(world->vel_y, 0, grid_size * sizeof(Fixed8));
-    memset(world->lifetime, 0, grid_size * sizeof(uint8_t));
+    /* Also restores color variants and temperature, so a scene built on a
+     * cleared world starts the same every time */
+    world_init_rows(world, 0, world->height);
+    
+    /* Drop pending activations and measured costs from the old contents */
+    memset(world->chunk_active_next, 0, CHUNK_COUNT_MAX * sizeof(bool));
+    memset(world->chunk_cost, 0, CHUNK_COUNT_MAX * sizeof(uint32_t));
+    memset(world->chunk_cost_next, 0, CHUNK_COUNT_MAX * sizeof(uint32_t));
+    memset(world->chunk_warm, 0, CHUNK_COUNT_MAX * sizeof(bool));
+    for (int i = 0; i < world->chunk_count; i++) {
+        world->chunk_version[i]++;
+    }
 }
 
 MaterialID world_get_mat(const World* world, int x, int y) {
@@ -149,10 +255,10 @@ void world_swap_cells(World* world, int x1, int y1, int x2, int y2) {
     world->mat[idx1] = world->mat[idx2];
     world->mat[idx2] = tmp_mat;
     
-    /* Swap color seed (so colors follow the material) */
-    uint32_t tmp_seed = world->color_seed[idx1];
-    world->color_seed[idx1] = world->color_seed[idx2];
-    world->color_seed[idx2] = tmp_seed;
+    /* Swap color variant (so colors follow the material) */
+    uint8_t tmp_variant = world->color_variant[idx1];
+    world->color_variant[idx1] = world->color_variant[idx2];
+    world->color_variant[idx2] = tmp_variant;
     
     /* Swap velocity */
     Fixed8 tmp_vx = world->vel_x[idx1];
@@ -173,15 +279,27 @@ void world_swap_cells(World* world, int x1, int y1, int x2, int y2) {
 }
 
 void world_activate_chunk(World* world, int chunk_x, int chunk_y) {
-    if (chunk_x < 0 || chunk_x >= CHUNKS_X || chunk_y < 0 || chunk_y >= CHUNKS_Y) return;
-    int idx = chunk_y * CHUNKS_X + chunk_x;
+    if (chunk_x < 0 || chunk_x >= world->chunks_x || chunk_y < 0 || chunk_y >= world->chunks_y) return;
+    int idx = chunk_y * world->chunks_x + chunk_x;
+    
+    /* Parallel passes collect activations per thread */
+    if (thread_scratch) {
+        deferred_mark_chunk(thread_scratch, idx);
+        return;
+    }
     world->chunk_active_next[idx] = true;
+    world->chunk_version[idx]++;
+}
+
+void world_keep_chunk_awake(World* world, int x, int y) {
+    if (!IN_BOUNDS(x, y)) return;
+    world_activate_chunk(world, x >> world->chunk_shift, y >> world->chunk_shift);
 }
 
 void world_activate_chunk_at(World* world, int x, int y) {
     if (!IN_BOUNDS(x, y)) return;
-    int chunk_x = x / CHUNK_SIZE;
-    int chunk_y = y / CHUNK_SIZE;
+    int chunk_x = x >> world->chunk_shift;
+    int chunk_y = y >> world->chunk_shift;
     world_activate_chunk(world, chunk_x, chunk_y);
     
     /* Also activate neighbor chunks (for particles that might move across boundaries) */
@@ -194,16 +312,17 @@ void world_activate_chunk_at(World* world, int x, int y) {
 }
 
 bool world_is_chunk_active(const World* world, int chunk_x, int chunk_y) {
-    if (chunk_x < 0 || chunk_x >= CHUNKS_X || chunk_y < 0 || chunk_y >= CHUNKS_Y) return false;
-    int idx = chunk_y * CHUNKS_X + chunk_x;
+    if (chunk_x < 0 || chunk_x >= world->chunks_x || chunk_y < 0 || chunk_y >= world->chunks_y) return false;
+    int idx = chunk_y * world->chunks_x + chunk_x;
     return world->chunk_active[idx];
 }
 
 void world_swap_buffers(World* world) {
-    /* For materials, we typically don't double-buffer in cellular automata
-     * Instead, we use in-place updates with careful ordering
-     * This function is here for future fluid simulation needs */
-    (void)world;
+    /* Sweep modes update mat in place; the intent/resolve mode writes the
+     * complete next material layout into mat_next and publishes it here */
+    MaterialID* tmp = world->mat;
+    world->mat = world->mat_next;
+    world->mat_next = tmp;
 }
 
 void world_clear_tick_flags(World* world) {
@@ -214,7 +333,7 @@ void world_clear_tick_flags(World* world) {
 }
 
 void world_clear_chunk_activation(World* world) {
-    memset(world->chunk_active_next, 0, CHUNK_COUNT * sizeof(bool));
+    memset(world->chunk_active_next, 0, world->chunk_count * sizeof(bool));
 }
 
 void world_update_chunk_activation(World* world) {
@@ -223,13 +342,37 @@ void world_update_chunk_activation(World* world) {
     world->chunk_active = world->chunk_active_next;
     world->chunk_active_next = tmp;
     
+    /* Stages (and paint commands before the next tick) mark it afresh */
+    world_clear_chunk_activation(world);
+    
     /* Count active chunks */
     world->active_chunks = 0;
-    for (int i = 0; i < CHUNK_COUNT; i++) {
+    for (int i = 0; i < world->chunk_count; i++) {
         if (world->chunk_active[i]) {
             world->active_chunks++;
         }
     }
+    
+    /* Publish this tick's measured costs for next tick's scheduling */
+    uint32_t* cost = world->chunk_cost;
+    world->chunk_cost = world->chunk_cost_next;
+    world->chunk_cost_next = cost;
+    memset(world->chunk_cost_next, 0, world->chunk_count * sizeof(uint32_t));
+    
+    world->generation++;
+}
+
+void world_chunk_row_costs(const World* world, uint32_t* row_cost) {
+    for (int cy = 0; cy < world->chunks_y; cy++) {
+        uint32_t sum = 0;
+        for (int cx = 0; cx < world->chunks_x; cx++) {
+            int idx = cy * world->chunks_x + cx;
+            if (world->chunk_active[idx]) {
+                sum += WORLD_CHUNK_BASE_COST + world->chunk_cost[idx];
+            }
+        }
+        row_cost[cy] = sum;
+    }
 }
 
 void world_paint_circle(World* world, int cx, int cy, int radius, MaterialID mat) {
@@ -280,7 +423,5 @@ Color world_get_cell_color(const World* world, int x, int y) {
     
     int idx = IDX(x, y);
     MaterialID mat = world->mat[idx];
-    uint32_t seed = world->color_seed[idx];
-    
-    return material_color(mat, seed);
+    return material_color(mat, world->color_variant[idx]);
 }
@@ -0,0 +1,873 @@
+/*
+ * bench.c - Headless tick-throughput benchmark (pixelsim-bench)
+ *
+ * Runs named scenes or scene files (world/scene.h) for a fixed number of
+ * ticks from a fixed seed and prints one JSON report on stdout: ticks/s,
+ * cells updated/s, time per tick stage and peak RSS. Links the engine
+ * without the renderer or input, so it needs no SDL.
+ *
+ * With --repeat each scene runs several times from the same start, and the
+ * per-repetition mean tick and stage times form the samples. --baseline
+ * compares them with a stored report using Welch's t-test and exits with
+ * status 2 when a metric got significantly slower by more than the
+ * threshold.
+ *
+ * --sweep runs one scene across grid sizes and thread counts instead
+ * (sweep.h) and prints a scaling table rather than JSON.
+ *
+ * --check-threads runs each scene from the same seed at several thread
+ * counts and compares a hash of the world afterwards; it exits with status
+ * 3 when any thread count ends in a different world.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <sys/resource.h>
+
+#include "core/types.h"
+#include "core/utils.h"
+#include "materials/material.h"
+#include "world/world.h"
+#include "world/scene.h"
+#include "engine/simulation.h"
+#include "engine/stages.h"
+#include "engine/kernels.h"
+#include "json.h"
+#include "stats.h"
+#include "sweep.h"
+
+#define BENCH_TICKS_DEFAULT     600
+#define BENCH_WARMUP_DEFAULT    30
+#define BENCH_SWEEP_TICKS       100   /* Sweep defaults: large grids tick slowly */
+#define BENCH_SWEEP_WARMUP      10
+#define BENCH_SWEEP_SCENE       "mixed"
+#define BENCH_SEED_DEFAULT      12345u
+#define BENCH_SCENES_MAX        32
+#define BENCH_REPEAT_MAX        100
+#define BENCH_BASELINE_REPEAT   5     /* --repeat default with --baseline */
+#define BENCH_THRESHOLD_DEFAULT 5.0   /* Percent slowdown that counts as a regression */
+#define BENCH_ALPHA_DEFAULT     0.05  /* Significance level of the comparison */
+#define BENCH_STAGE_FLOOR_US    5.0   /* Stages cheaper than this in the baseline are not compared */
+#define BENCH_STATUS_REGRESSION 2
+#define BENCH_CHECK_TICKS       120   /* --check-threads default, no warm-up */
+#define BENCH_STATUS_MISMATCH   3
+
+typedef struct {
+    const char* scenes[BENCH_SCENES_MAX]; /* --scene NAME|FILE, in order; none = every scene */
+    int scene_count;
+    int ticks;                    /* --ticks N, measured per repetition; 0 = default */
+    int warmup;                   /* --warmup N, run before measuring; -1 = default */
+    int repeat;                   /* --repeat N, repetitions per scene; 0 = default */
+    uint32_t seed;                /* --seed S, RNG state at the first tick */
+    int threads;                  /* --threads N, 0 = PIXELSIM_THREADS or CPU count */
+    int chunk_size;               /* --chunk-size N, 0 = default */
+    const char* baseline;         /* --baseline FILE: report to compare against */
+    double threshold_pct;         /* --threshold PCT */
+    double alpha;                 /* --alpha A */
+    bool sweep;                   /* --sweep: scaling table instead of a report */
+    SweepOptions sweep_opts;      /* --grids, --thread-counts, --csv */
+    int check_threads[SWEEP_THREADS_MAX]; /* --check-threads N,..., ascending */
+    int check_count;
+    UpdateMode modes[STATE_COUNT]; /* --powder-mode, --fluid-mode, --gas-mode */
+    bool modes_set;
+} BenchOptions;
+
+/* Mode options, as in pixelsim, and their report keys */
+static const struct {
+    const char* flag;
+    const char* key;
+    MaterialState state;
+} BENCH_MODE_FLAGS[] = {
+    {"--powder-mode", "powder_mode", STATE_POWDER},
+    {"--fluid-mode",  "fluid_mode",  STATE_FLUID},
+    {"--gas-mode",    "gas_mode",    STATE_GAS},
+};
+
+#define BENCH_MODE_FLAG_COUNT ((int)(sizeof(BENCH_MODE_FLAGS) / sizeof(BENCH_MODE_FLAGS[0])))
+
+typedef struct {
+    double wall_s;                /* Summed over repetitions */
+    uint64_t cells_updated;
+    uint64_t active_chunks;
+    double stage_us[STAGE_MAX];
+    int reps;
+    double tick_ms[BENCH_REPEAT_MAX];                 /* Mean tick time of each repetition */
+    double rep_stage_us[BENCH_REPEAT_MAX][STAGE_MAX]; /* Mean stage time of each repetition */
+    double tick_p50, tick_p90, tick_p99;              /* Over every measured tick, ms */
+} BenchResult;
+
+typedef struct {
+    const char* scene;
+    char metric[48];              /* "tick_ms" or "stage_us.NAME" */
+    bool tested;                  /* Enough samples on both sides */
+    WelchResult test;
+    double change_pct;            /* Relative to the baseline mean */
+    double ci_low_pct, ci_high_pct;
+    bool regression;
+} BenchComparison;
+
+/* =============================================================================
+ * Command Line Options
+ * ============================================================================= */
+
+static void bench_usage(void) {
+    fprintf(stderr,
+            "Usage: pixelsim-bench [--scene NAME|FILE]... [--ticks N] [--warmup N] [--seed S]\n"
+            "                      [--threads N] [--chunk-size N] [--repeat N]\n"
+            "                      [--powder-mode M] [--fluid-mode M] [--gas-mode M]\n"
+            "                      [--baseline FILE [--threshold PCT] [--alpha A]] [--list]\n"
+            "       pixelsim-bench --sweep [--scene NAME|FILE] [--grids N,...]\n"
+            "                      [--thread-counts N,...] [--csv FILE|-] [--ticks N] ...\n"
+            "       pixelsim-bench --check-threads N,... [--scene NAME|FILE]... [--ticks N] ...\n");
+}
+
+static void bench_list(void) {
+    for (int i = 0; i < scene_count(); i++) {
+        const SceneDesc* scene = scene_get(i);
+        printf("%-16s %s\n", scene->name, scene->description);
+    }
+}
+
+/* Parse a non-negative integer option value; false if missing or invalid */
+static bool bench_parse_count(int argc, char* argv[], int i, long min, long* value) {
+    char* end;
+    if (i + 1 >= argc) return false;
+    *value = strtol(argv[i + 1], &end, 10);
+    return *end == '\0' && end != argv[i + 1] && *value >= min && *value <= 0x7FFFFFFF;
+}
+
+/* Parse a real option value in (min, max]; false if missing or invalid */
+static bool bench_parse_real(int argc, char* argv[], int i, double min, double max,
+                             double* value) {
+    char* end;
+    if (i + 1 >= argc) return false;
+    *value = strtod(argv[i + 1], &end);
+    return *end == '\0' && end != argv[i + 1] && *value > min && *value <= max;
+}
+
+/* Returns 1 on success, 0 to exit successfully (--list), -1 on error */
+static int bench_parse_options(int argc, char* argv[], BenchOptions* opts) {
+    for (int i = 1; i < argc; i++) {
+        long value = 0;
+        if (strcmp(argv[i], "--list") == 0) {
+            bench_list();
+            return 0;
+        }
+        if (strcmp(argv[i], "--scene") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "--scene expects a scene name (see --list) or a scene file\n");
+                return -1;
+            }
+            if (opts->scene_count == BENCH_SCENES_MAX) {
+                fprintf(stderr, "Too many --scene options\n");
+                return -1;
+            }
+            opts->scenes[opts->scene_count++] = argv[i + 1];
+            i++;
+            continue;
+        }
+        int mode_flag = -1;
+        for (int f = 0; f < BENCH_MODE_FLAG_COUNT; f++) {
+            if (strcmp(argv[i], BENCH_MODE_FLAGS[f].flag) == 0) mode_flag = f;
+        }
+        if (mode_flag >= 0) {
+            UpdateMode mode;
+            if (i + 1 >= argc || !simulation_parse_update_mode(argv[i + 1], &mode)) {
+                fprintf(stderr, "%s expects one of: sweep, margolus, intent, tiled\n", argv[i]);
+                return -1;
+            }
+            opts->modes[BENCH_MODE_FLAGS[mode_flag].state] = mode;
+            opts->modes_set = true;
+            i++;
+            continue;
+        }
+        if (strcmp(argv[i], "--ticks") == 0 || strcmp(argv[i], "--threads") == 0 ||
+            strcmp(argv[i], "--seed") == 0) {
+            if (!bench_parse_count(argc, argv, i, 1, &value)) {
+                fprintf(stderr, "%s expects a positive number\n", argv[i]);
+                return -1;
+            }
+            if (strcmp(argv[i], "--ticks") == 0) opts->ticks = (int)value;
+            else if (strcmp(argv[i], "--threads") == 0) opts->threads = (int)value;
+            else opts->seed = (uint32_t)value;
+            i++;
+            continue;
+        }
+        if (strcmp(argv[i], "--repeat") == 0) {
+            if (!bench_parse_count(argc, argv, i, 1, &value) || value > BENCH_REPEAT_MAX) {
+                fprintf(stderr, "--repeat expects a count in [1, %d]\n", BENCH_REPEAT_MAX);
+                return -1;
+            }
+            opts->repeat = (int)value;
+            i++;
+            continue;
+        }
+        if (strcmp(argv[i], "--warmup") == 0) {
+            if (!bench_parse_count(argc, argv, i, 0, &value)) {
+                fprintf(stderr, "--warmup expects a count\n");
+                return -1;
+            }
+            opts->warmup = (int)value;
+            i++;
+            continue;
+        }
+        if (strcmp(argv[i], "--chunk-size") == 0) {
+            int size = bench_parse_count(argc, argv, i, 1, &value) ? (int)value : 0;
+            if (size < CHUNK_SIZE_MIN || size > CHUNK_SIZE_MAX || (size & (size - 1)) != 0) {
+                fprintf(stderr, "--chunk-size expects a power of two in [%d, %d]\n",
+                        CHUNK_SIZE_MIN, CHUNK_SIZE_MAX);
+                return -1;
+            }
+            opts->chunk_size = size;
+            i++;
+            continue;
+        }
+        if (strcmp(argv[i], "--sweep") == 0) {
+            opts->sweep = true;
+            continue;
+        }
+        if (strcmp(argv[i], "--grids") == 0 || strcmp(argv[i], "--thread-counts") == 0) {
+            bool grids = strcmp(argv[i], "--grids") == 0;
+            SweepOptions* sweep = &opts->sweep_opts;
+            if (i + 1 >= argc ||
+                !(grids ? sweep_parse_list(argv[i + 1], sweep->grids, SWEEP_GRIDS_MAX,
+                                           &sweep->grid_count)
+                        : sweep_parse_list(argv[i + 1], sweep->threads, SWEEP_THREADS_MAX,
+                                           &sweep->thread_count))) {
+                fprintf(stderr, "%s expects a comma-separated list of at most %d numbers\n",
+                        argv[i], grids ? SWEEP_GRIDS_MAX : SWEEP_THREADS_MAX);
+                return -1;
+            }
+            i++;
+            continue;
+        }
+        if (strcmp(argv[i], "--check-threads") == 0) {
+            if (i + 1 >= argc || !sweep_parse_list(argv[i + 1], opts->check_threads,
+                                                   SWEEP_THREADS_MAX, &opts->check_count) ||
+                opts->check_threads[opts->check_count - 1] > WORKERS_MAX) {
+                fprintf(stderr, "--check-threads expects a comma-separated list of at most %d "
+                                "thread counts in [1, %d]\n", SWEEP_THREADS_MAX, WORKERS_MAX);
+                return -1;
+            }
+            i++;
+            continue;
+        }
+        if (strcmp(argv[i], "--csv") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "--csv expects a file name or -\n");
+                return -1;
+            }
+            opts->sweep_opts.csv = argv[i + 1];
+            i++;
+            continue;
+        }
+        if (strcmp(argv[i], "--baseline") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "--baseline expects a report file\n");
+                return -1;
+            }
+            opts->baseline = argv[i + 1];
+            i++;
+            continue;
+        }
+        if (strcmp(argv[i], "--threshold") == 0) {
+            if (!bench_parse_real(argc, argv, i, -1e-9, 1000.0, &opts->threshold_pct)) {
+                fprintf(stderr, "--threshold expects a percentage >= 0\n");
+                return -1;
+            }
+            i++;
+            continue;
+        }
+        if (strcmp(argv[i], "--alpha") == 0) {
+            if (!bench_parse_real(argc, argv, i, 0.0, 0.5, &opts->alpha)) {
+                fprintf(stderr, "--alpha expects a significance level in (0, 0.5]\n");
+                return -1;
+            }
+            i++;
+            continue;
+        }
+        fprintf(stderr, "Unknown option: %s\n", argv[i]);
+        bench_usage();
+        return -1;
+    }
+
+    if (opts->sweep) {
+        SweepOptions* sweep = &opts->sweep_opts;
+        if (opts->scene_count > 1 || opts->baseline || opts->repeat > 1 || opts->threads ||
+            opts->check_count || opts->modes_set) {
+            fprintf(stderr, "--sweep takes one --scene and no --baseline, --repeat, --threads, "
+                            "--check-threads or mode options\n");
+            return -1;
+        }
+        sweep->scene = opts->scene_count ? opts->scenes[0] : BENCH_SWEEP_SCENE;
+        sweep->ticks = opts->ticks ? opts->ticks : BENCH_SWEEP_TICKS;
+        sweep->warmup = opts->warmup >= 0 ? opts->warmup : BENCH_SWEEP_WARMUP;
+        sweep->seed = opts->seed;
+        sweep->chunk_size = opts->chunk_size;
+        if (sweep->grid_count == 0) sweep_default_grids(sweep);
+        if (sweep->thread_count == 0) sweep_default_threads(sweep);
+        return 1;
+    }
+    if (opts->sweep_opts.grid_count || opts->sweep_opts.thread_count || opts->sweep_opts.csv) {
+        fprintf(stderr, "--grids, --thread-counts and --csv need --sweep\n");
+        return -1;
+    }
+    if (opts->check_count) {
+        if (opts->baseline || opts->repeat > 1 || opts->threads) {
+            fprintf(stderr, "--check-threads takes no --baseline, --repeat or --threads\n");
+            return -1;
+        }
+        if (opts->ticks == 0) opts->ticks = BENCH_CHECK_TICKS;
+        if (opts->warmup < 0) opts->warmup = 0;
+    }
+    if (opts->baseline) {
+        /* One repetition gives no variance, so nothing could be tested */
+        if (opts->repeat == 1) {
+            fprintf(stderr, "--baseline needs --repeat 2 or more (default %d)\n",
+                    BENCH_BASELINE_REPEAT);
+            return -1;
+        }
+        if (opts->repeat == 0) opts->repeat = BENCH_BASELINE_REPEAT;
+    }
+    if (opts->repeat == 0) opts->repeat = 1;
+    if (opts->ticks == 0) opts->ticks = BENCH_TICKS_DEFAULT;
+    if (opts->warmup < 0) opts->warmup = BENCH_WARMUP_DEFAULT;
+
+    if (opts->scene_count == 0) {
+        for (int i = 0; i < scene_count(); i++) {
+            opts->scenes[opts->scene_count++] = scene_get(i)->name;
+        }
+    }
+    return 1;
+}
+
+/* =============================================================================
+ * Measurement
+ * ============================================================================= */
+
+static double bench_time_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+/* Peak resident set size of the process so far, in KiB */
+static long bench_peak_rss_kb(void) {
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+    return usage.ru_maxrss;
+}
+
+/* Each repetition builds the scene, restarts the simulation from the seed,
+ * runs the warm-up ticks, then times the measured ones; false if the scene
+ * cannot be built */
+static bool bench_run_scene(Simulation* sim, World* world, const char* scene,
+                            const BenchOptions* opts, BenchResult* result) {
+    int stages = sim->stages->count;
+    double* tick_times = malloc((size_t)opts->ticks * opts->repeat * sizeof(double));
+    if (!tick_times) return false;
+
+    memset(result, 0, sizeof(*result));
+    for (int rep = 0; rep < opts->repeat; rep++) {
+        if (!scene_apply(world, scene)) {
+            free(tick_times);
+            return false;
+        }
+        simulation_reset(sim);
+        sim->rng_state = opts->seed;
+
+        for (int t = 0; t < opts->warmup; t++) {
+            simulation_tick(sim, world);
+        }
+
+        double* rep_stage_us = result->rep_stage_us[rep];
+        double* times = &tick_times[(size_t)rep * opts->ticks];
+        double start = bench_time_s(), last = start;
+        for (int t = 0; t < opts->ticks; t++) {
+            simulation_tick(sim, world);
+            double now = bench_time_s();
+            times[t] = (now - last) * 1000.0;
+            last = now;
+            result->cells_updated += world->cells_updated;
+            result->active_chunks += world->active_chunks;
+            for (int i = 0; i < stages; i++) {
+                rep_stage_us[i] += sim->stages->time_us[i];
+            }
+        }
+
+        result->wall_s += last - start;
+        result->tick_ms[rep] = (last - start) * 1000.0 / opts->ticks;
+        for (int i = 0; i < stages; i++) {
+            result->stage_us[i] += rep_stage_us[i];
+            rep_stage_us[i] /= opts->ticks;
+        }
+        result->reps++;
+    }
+
+    int count = opts->ticks * opts->repeat;
+    stats_sort(tick_times, count);
+    result->tick_p50 = stats_quantile(tick_times, count, 0.50);
+    result->tick_p90 = stats_quantile(tick_times, count, 0.90);
+    result->tick_p99 = stats_quantile(tick_times, count, 0.99);
+    free(tick_times);
+    return true;
+}
+
+/* =============================================================================
+ * Thread-Count Check
+ * ============================================================================= */
+
+/* FNV-1a, continued from hash */
+static uint64_t bench_hash_bytes(uint64_t hash, const void* data, size_t size) {
+    const uint8_t* bytes = data;
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ bytes[i]) * 0x100000001B3ull;
+    }
+    return hash;
+}
+
+/* Hash of every simulated cell plane (not the renderer's chunk versions) */
+static uint64_t bench_world_hash(const World* world) {
+    size_t cells = (size_t)world->width * world->height;
+    uint64_t hash = 0xCBF29CE484222325ull;
+    hash = bench_hash_bytes(hash, world->mat, cells * sizeof(*world->mat));
+    hash = bench_hash_bytes(hash, world->flags, cells * sizeof(*world->flags));
+    hash = bench_hash_bytes(hash, world->color_variant, cells * sizeof(*world->color_variant));
+    hash = bench_hash_bytes(hash, world->temp, cells * sizeof(*world->temp));
+    hash = bench_hash_bytes(hash, world->vel_x, cells * sizeof(*world->vel_x));
+    hash = bench_hash_bytes(hash, world->vel_y, cells * sizeof(*world->vel_y));
+    hash = bench_hash_bytes(hash, world->lifetime, cells * sizeof(*world->lifetime));
+    return hash;
+}
+
+/* Runs every scene for warmup + ticks ticks at each thread count from the
+ * same seed and prints the world hash of each run; returns 0 when all thread
+ * counts agree, BENCH_STATUS_MISMATCH when one differs, 1 on failure */
+static int bench_check_threads(Simulation* sim, World* world, const BenchOptions* opts) {
+    int ticks = opts->warmup + opts->ticks;
+    int status = 0;
+    printf("%d ticks, seed %u, chunk size %d, modes powder=%s fluid=%s gas=%s\n", ticks,
+           opts->seed, world->chunk_size,
+           simulation_update_mode_name(sim->update_mode[STATE_POWDER]),
+           simulation_update_mode_name(sim->update_mode[STATE_FLUID]),
+           simulation_update_mode_name(sim->update_mode[STATE_GAS]));
+    printf("%-16s %7s %14s %16s\n", "scene", "threads", "cells_updated", "hash");
+
+    for (int s = 0; s < opts->scene_count; s++) {
+        uint64_t first = 0;
+        for (int t = 0; t < opts->check_count; t++) {
+            int threads = opts->check_threads[t];
+            if (!simulation_set_threads(sim, threads)) {
+                fprintf(stderr, "Failed to start %d worker threads\n", threads);
+                return 1;
+            }
+            if (!scene_apply(world, opts->scenes[s])) {
+                fprintf(stderr, "Failed to run scene %s\n", opts->scenes[s]);
+                return 1;
+            }
+            simulation_reset(sim);
+            sim->rng_state = opts->seed;
+
+            uint64_t updated = 0;
+            for (int i = 0; i < ticks; i++) {
+                simulation_tick(sim, world);
+                updated += world->cells_updated;
+            }
+
+            uint64_t hash = bench_world_hash(world);
+            if (t == 0) first = hash;
+            bool match = hash == first;
+            if (!match) status = BENCH_STATUS_MISMATCH;
+            printf("%-16s %7d %14llu %016llx%s\n", opts->scenes[s], threads,
+                   (unsigned long long)updated, (unsigned long long)hash,
+                   match ? "" : "  MISMATCH");
+            fflush(stdout);
+        }
+    }
+    printf("%s\n", status == 0 ? "All thread counts match"
+                                : "Thread counts disagree");
+    return status;
+}
+
+/* =============================================================================
+ * Baseline Comparison
+ * ============================================================================= */
+
+/* Numbers of a JSON array into out; returns the count */
+static int bench_json_samples(const JsonValue* array, double* out, int max) {
+    int n = 0;
+    if (!array || array->type != JSON_ARRAY) return 0;
+    for (int i = 0; i < array->count && n < max; i++) {
+        if (array->items[i].type == JSON_NUMBER) out[n++] = array->items[i].number;
+    }
+    return n;
+}
+
+static const JsonValue* bench_baseline_scene(const JsonValue* baseline, const char* name) {
+    const JsonValue* scenes = json_get(baseline, "scenes");
+    if (!scenes || scenes->type != JSON_ARRAY) return NULL;
+    for (int i = 0; i < scenes->count; i++) {
+        const JsonValue* scene_name = json_get(&scenes->items[i], "name");
+        if (scene_name && scene_name->type == JSON_STRING && strcmp(scene_name->string, name) == 0) {
+            return &scenes->items[i];
+        }
+    }
+    return NULL;
+}
+
+/* Warn when the baseline ran with a different setup */
+static void bench_check_baseline(const JsonValue* baseline, const World* world,
+                                 const Simulation* sim, const BenchOptions* opts) {
+    static const char* KEYS[] = { "threads", "chunk_size", "ticks", "warmup", "seed" };
+    double current[] = { workers_count(sim->workers), world->chunk_size, opts->ticks,
+                         opts->warmup, opts->seed };
+    const JsonValue* grid = json_get(baseline, "grid");
+
+    if (!grid || grid->type != JSON_ARRAY || grid->count != 2 ||
+        grid->items[0].number != world->width || grid->items[1].number != world->height) {
+        fprintf(stderr, "Warning: baseline grid differs from %dx%d\n", world->width, world->height);
+    }
+    for (size_t k = 0; k < sizeof(KEYS) / sizeof(KEYS[0]); k++) {
+        double value = json_get_number(baseline, KEYS[k], NAN);
+        if (value != current[k]) {
+            fprintf(stderr, "Warning: baseline %s is %g, this run uses %g\n", KEYS[k], value,
+                    current[k]);
+        }
+    }
+    for (int f = 0; f < BENCH_MODE_FLAG_COUNT; f++) {
+        const char* mode = simulation_update_mode_name(sim->update_mode[BENCH_MODE_FLAGS[f].state]);
+        const JsonValue* value = json_get(baseline, BENCH_MODE_FLAGS[f].key);
+        /* Reports without the key predate modes and ran sweeps */
+        const char* base = (value && value->type == JSON_STRING) ? value->string : "sweep";
+        if (strcmp(base, mode) != 0) {
+            fprintf(stderr, "Warning: baseline %s is %s, this run uses %s\n",
+                    BENCH_MODE_FLAGS[f].key, base, mode);
+        }
+    }
+}
+
+/* Test one metric of one scene; the regression rule is a significant
+ * slowdown larger than the threshold */
+static void bench_compare_metric(BenchComparison* cmp, const double* base, int base_n,
+                                 const double* cur, int cur_n, const BenchOptions* opts) {
+    cmp->tested = stats_welch(base, base_n, cur, cur_n, 1.0 - opts->alpha, &cmp->test);
+    if (!cmp->tested) {
+        cmp->test.mean_a = stats_mean(base, base_n);
+        cmp->test.mean_b = stats_mean(cur, cur_n);
+    }
+    double scale = cmp->test.mean_a > 0.0 ? 100.0 / cmp->test.mean_a : 0.0;
+    cmp->change_pct = (cmp->test.mean_b - cmp->test.mean_a) * scale;
+    cmp->ci_low_pct = cmp->test.ci_low * scale;
+    cmp->ci_high_pct = cmp->test.ci_high * scale;
+    cmp->regression = cmp->tested && cmp->test.p < opts->alpha &&
+                      cmp->change_pct > opts->threshold_pct;
+}
+
+/* Compare every scene's tick time and stage times; returns the number of
+ * comparisons written to out */
+static int bench_compare(const JsonValue* baseline, const Simulation* sim, const BenchOptions* opts,
+                         const BenchResult* results, BenchComparison* out) {
+    double base[BENCH_REPEAT_MAX];
+    int count = 0;
+
+    for (int s = 0; s < opts->scene_count; s++) {
+        const JsonValue* scene = bench_baseline_scene(baseline, opts->scenes[s]);
+        if (!scene) {
+            fprintf(stderr, "Warning: scene %s is not in the baseline\n", opts->scenes[s]);
+            continue;
+        }
+        const BenchResult* result = &results[s];
+
+        int n = bench_json_samples(json_get(json_get(scene, "tick_ms"), "samples"), base,
+                                   BENCH_REPEAT_MAX);
+        if (n > 0) {
+            BenchComparison* cmp = &out[count++];
+            cmp->scene = opts->scenes[s];
+            snprintf(cmp->metric, sizeof(cmp->metric), "tick_ms");
+            bench_compare_metric(cmp, base, n, result->tick_ms, result->reps, opts);
+        }
+
+        const JsonValue* stage_samples = json_get(scene, "stage_us_samples");
+        for (int i = 0; i < sim->stages->count; i++) {
+            double cur[BENCH_REPEAT_MAX];
+            n = bench_json_samples(json_get(stage_samples, sim->stages->desc[i].name), base,
+                                   BENCH_REPEAT_MAX);
+            if (n == 0 || stats_mean(base, n) < BENCH_STAGE_FLOOR_US) continue;
+            for (int r = 0; r < result->reps; r++) cur[r] = result->rep_stage_us[r][i];
+
+            BenchComparison* cmp = &out[count++];
+            cmp->scene = opts->scenes[s];
+            snprintf(cmp->metric, sizeof(cmp->metric), "stage_us.%s", sim->stages->desc[i].name);
+            bench_compare_metric(cmp, base, n, cur, result->reps, opts);
+        }
+    }
+    return count;
+}
+
+/* Human-readable summary on stderr */
+static void bench_print_summary(const BenchComparison* cmps, int count, const BenchOptions* opts) {
+    fprintf(stderr, "%-20s %-18s %12s %12s %9s %21s %8s\n", "scene", "metric", "baseline",
+            "current", "change", "interval", "p");
+    for (int i = 0; i < count; i++) {
+        const BenchComparison* cmp = &cmps[i];
+        fprintf(stderr, "%-20s %-18s %12.4g %12.4g %+8.2f%% ", cmp->scene, cmp->metric,
+                cmp->test.mean_a, cmp->test.mean_b, cmp->change_pct);
+        if (cmp->tested) {
+            fprintf(stderr, "[%+8.2f%%, %+8.2f%%] %8.2g%s\n", cmp->ci_low_pct, cmp->ci_high_pct,
+                    cmp->test.p, cmp->regression ? "  REGRESSION" : "");
+        } else {
+            fprintf(stderr, "%21s %8s  UNTESTED\n", "(baseline --repeat 1)", "-");
+        }
+    }
+    fprintf(stderr, "Regression: significant at p < %g and more than %g%% slower\n", opts->alpha,
+            opts->threshold_pct);
+}
+
+/* =============================================================================
+ * Report
+ * ============================================================================= */
+
+/* JSON string body: quotes, backslashes and control characters escaped */
+static void bench_print_string(const char* text) {
+    for (const unsigned char* c = (const unsigned char*)text; *c; c++) {
+        if (*c == '"' || *c == '\\') printf("\\%c", *c);
+        else if (*c < 0x20) printf("\\u%04x", *c);
+        else putchar(*c);
+    }
+}
+
+static void bench_print_samples(const double* x, int n, int stride) {
+    printf("[");
+    for (int i = 0; i < n; i++) {
+        printf("%s%.6g", i ? ", " : "", x[(size_t)i * stride]);
+    }
+    printf("]");
+}
+
+static void bench_print_scene(const Simulation* sim, const char* scene,
+                              const BenchOptions* opts, const BenchResult* result) {
+    double wall_s = MAX(result->wall_s, 1e-9);
+    int ticks = opts->ticks * result->reps;
+
+    /* Interval of the mean tick time at the comparison's confidence */
+    double mean = stats_mean(result->tick_ms, result->reps);
+    double half = 0.0;
+    if (result->reps > 1) {
+        half = stats_t_quantile(1.0 - opts->alpha / 2.0, result->reps - 1) *
+               stats_stddev(result->tick_ms, result->reps) / sqrt(result->reps);
+    }
+
+    printf("    {\n");
+    printf("      \"name\": \"");
+    bench_print_string(scene);
+    printf("\",\n");
+    printf("      \"repetitions\": %d,\n", result->reps);
+    printf("      \"wall_s\": %.6f,\n", result->wall_s);
+    printf("      \"ticks_per_s\": %.2f,\n", ticks / wall_s);
+    printf("      \"ms_per_tick\": %.4f,\n", result->wall_s * 1000.0 / ticks);
+    printf("      \"cells_updated\": %llu,\n", (unsigned long long)result->cells_updated);
+    printf("      \"cells_updated_per_s\": %.0f,\n", result->cells_updated / wall_s);
+    printf("      \"active_chunks_mean\": %.2f,\n", (double)result->active_chunks / ticks);
+    printf("      \"tick_ms\": {\"mean\": %.6g, \"stddev\": %.6g, \"ci\": [%.6g, %.6g], "
+           "\"p50\": %.6g, \"p90\": %.6g, \"p99\": %.6g, \"samples\": ",
+           mean, stats_stddev(result->tick_ms, result->reps), mean - half, mean + half,
+           result->tick_p50, result->tick_p90, result->tick_p99);
+    bench_print_samples(result->tick_ms, result->reps, 1);
+    printf("},\n");
+    printf("      \"stage_us_per_tick\": {");
+    for (int i = 0; i < sim->stages->count; i++) {
+        printf("%s\"%s\": %.2f", i ? ", " : "", sim->stages->desc[i].name,
+               result->stage_us[i] / ticks);
+    }
+    printf("},\n");
+    printf("      \"stage_us_samples\": {");
+    for (int i = 0; i < sim->stages->count; i++) {
+        printf("%s\"%s\": ", i ? ", " : "", sim->stages->desc[i].name);
+        bench_print_samples(&result->rep_stage_us[0][i], result->reps, STAGE_MAX);
+    }
+    printf("},\n");
+    printf("      \"peak_rss_kb\": %ld\n", bench_peak_rss_kb());
+    printf("    }");
+}
+
+static void bench_print_comparison(const BenchComparison* cmps, int count,
+                                   const BenchOptions* opts, int regressions) {
+    printf("  \"comparison\": {\n");
+    printf("    \"baseline\": \"");
+    bench_print_string(opts->baseline);
+    printf("\",\n");
+    printf("    \"confidence\": %g,\n", 1.0 - opts->alpha);
+    printf("    \"threshold_pct\": %g,\n", opts->threshold_pct);
+    printf("    \"regressions\": %d,\n", regressions);
+    printf("    \"metrics\": [\n");
+    for (int i = 0; i < count; i++) {
+        const BenchComparison* cmp = &cmps[i];
+        printf("      {\"scene\": \"");
+        bench_print_string(cmp->scene);
+        printf("\", \"metric\": \"%s\", \"baseline\": %.6g, \"current\": %.6g, "
+               "\"change_pct\": %.3f, ", cmp->metric, cmp->test.mean_a, cmp->test.mean_b,
+               cmp->change_pct);
+        if (cmp->tested) {
+            printf("\"ci_pct\": [%.3f, %.3f], \"p\": %.4g, ", cmp->ci_low_pct, cmp->ci_high_pct,
+                   cmp->test.p);
+        } else {
+            printf("\"ci_pct\": null, \"p\": null, ");
+        }
+        printf("\"regression\": %s}%s\n", cmp->regression ? "true" : "false",
+               i == count - 1 ? "" : ",");
+    }
+    printf("    ]\n");
+    printf("  },\n");
+}
+
+/* =============================================================================
+ * Main Entry Point
+ * ============================================================================= */
+
+int main(int argc, char* argv[]) {
+    BenchOptions opts = {
+        .warmup = -1,
+        .seed = BENCH_SEED_DEFAULT,
+        .threshold_pct = BENCH_THRESHOLD_DEFAULT,
+        .alpha = BENCH_ALPHA_DEFAULT,
+    };
+    int parsed = bench_parse_options(argc, argv, &opts);
+    if (parsed <= 0) return parsed < 0 ? 1 : 0;
+
+    if (opts.sweep) {
+        opts.sweep_opts.self = argv[0];
+        return sweep_run(&opts.sweep_opts);
+    }
+
+    JsonValue* baseline = NULL;
+    if (opts.baseline) {
+        baseline = json_parse_file(opts.baseline);
+        if (!baseline) return 1;
+    }
+
+    material_init();
+
+    Simulation* sim = simulation_create(TICK_HZ);
+    BenchResult* results = calloc((size_t)opts.scene_count, sizeof(BenchResult));
+    if (!sim || !results) {
+        fprintf(stderr, "Failed to create simulation\n");
+        free(results);
+        if (sim) simulation_destroy(sim);
+        json_free(baseline);
+        return 1;
+    }
+    for (int f = 0; f < BENCH_MODE_FLAG_COUNT; f++) {
+        MaterialState state = BENCH_MODE_FLAGS[f].state;
+        simulation_set_update_mode(sim, state, opts.modes[state]);
+    }
+    if (opts.threads && !simulation_set_threads(sim, opts.threads)) {
+        fprintf(stderr, "Failed to start %d worker threads\n", opts.threads);
+        free(results);
+        simulation_destroy(sim);
+        json_free(baseline);
+        return 1;
+    }
+
+    World* world = world_create_placed(GRID_WIDTH, GRID_HEIGHT, sim->workers);
+    if (!world) {
+        fprintf(stderr, "Failed to create world\n");
+        free(results);
+        simulation_destroy(sim);
+        json_free(baseline);
+        return 1;
+    }
+    if (opts.chunk_size) {
+        world_set_chunk_size(world, opts.chunk_size);
+    }
+    if (baseline) {
+        bench_check_baseline(baseline, world, sim, &opts);
+    }
+
+    /* Load every scene once before the report starts, so a bad name or
+     * scene file fails without printing anything */
+    for (int i = 0; i < opts.scene_count; i++) {
+        if (!scene_apply(world, opts.scenes[i])) {
+            fprintf(stderr, "Failed to load scene %s\n", opts.scenes[i]);
+            world_destroy(world);
+            free(results);
+            simulation_destroy(sim);
+            json_free(baseline);
+            return 1;
+        }
+    }
+
+    if (opts.check_count) {
+        int status = bench_check_threads(sim, world, &opts);
+        world_destroy(world);
+        free(results);
+        simulation_destroy(sim);
+        json_free(baseline);
+        return status;
+    }
+
+    printf("{\n");
+    printf("  \"grid\": [%d, %d],\n", world->width, world->height);
+    printf("  \"threads\": %d,\n", workers_count(sim->workers));
+    printf("  \"chunk_size\": %d,\n", world->chunk_size);
+    printf("  \"isa\": \"%s\",\n", kernels_isa_name(kernels.isa));
+    for (int f = 0; f < BENCH_MODE_FLAG_COUNT; f++) {
+        printf("  \"%s\": \"%s\",\n", BENCH_MODE_FLAGS[f].key,
+               simulation_update_mode_name(sim->update_mode[BENCH_MODE_FLAGS[f].state]));
+    }
+    printf("  \"seed\": %u,\n", opts.seed);
+    printf("  \"ticks\": %d,\n", opts.ticks);
+    printf("  \"warmup\": %d,\n", opts.warmup);
+    printf("  \"scenes\": [\n");
+    int status = 0;
+    for (int i = 0; i < opts.scene_count; i++) {
+        if (!bench_run_scene(sim, world, opts.scenes[i], &opts, &results[i])) {
+            fprintf(stderr, "Failed to run scene %s\n", opts.scenes[i]);
+            status = 1;
+            break;
+        }
+        printf("%s", i ? ",\n" : "");
+        bench_print_scene(sim, opts.scenes[i], &opts, &results[i]);
+        fflush(stdout);
+    }
+    printf("\n  ],\n");
+    if (status == 0) {
+        if (baseline) {
+            BenchComparison* cmps = calloc((size_t)opts.scene_count * (STAGE_MAX + 1),
+                                           sizeof(BenchComparison));
+            if (cmps) {
+                int count = bench_compare(baseline, sim, &opts, results, cmps);
+                int regressions = 0, untested = 0;
+                for (int i = 0; i < count; i++) {
+                    regressions += cmps[i].regression;
+                    untested += !cmps[i].tested;
+                }
+                bench_print_comparison(cmps, count, &opts, regressions);
+                bench_print_summary(cmps, count, &opts);
+                if (regressions > 0) {
+                    status = BENCH_STATUS_REGRESSION;
+                } else if (untested > 0) {
+                    /* A gate that cannot test must not pass */
+                    fprintf(stderr, "%d metrics could not be tested; rerun the baseline with "
+                                    "--repeat 2 or more\n", untested);
+                    status = 1;
+                }
+                free(cmps);
+            } else {
+                fprintf(stderr, "Out of memory comparing with the baseline\n");
+                status = 1;
+            }
+        }
+    }
+    /* The document is closed even when a scene failed, listing the scenes
+     * that ran */
+    printf("  \"peak_rss_kb\": %ld\n", bench_peak_rss_kb());
+    printf("}\n");
+
+    world_destroy(world);
+    free(results);
+    simulation_destroy(sim);
+    json_free(baseline);
+    return status;
+}
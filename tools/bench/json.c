@@ -0,0 +1,249 @@
+/*
+ * json.c - Minimal JSON reader implementation
+ */
+#include "json.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define JSON_DEPTH_MAX 64
+
+typedef struct {
+    const char* text;
+    const char* pos;
+    const char* error;
+} JsonParser;
+
+static bool json_parse_value(JsonParser* parser, JsonValue* value, int depth);
+
+static void json_free_items(JsonValue* value) {
+    for (int i = 0; i < value->count; i++) {
+        json_free_items(&value->items[i]);
+    }
+    free(value->items);
+    free(value->string);
+    free(value->key);
+}
+
+void json_free(JsonValue* value) {
+    if (!value) return;
+    json_free_items(value);
+    free(value);
+}
+
+/* =============================================================================
+ * Parser
+ * ============================================================================= */
+
+static void json_skip_space(JsonParser* parser) {
+    while (*parser->pos == ' ' || *parser->pos == '\t' || *parser->pos == '\n' ||
+           *parser->pos == '\r') {
+        parser->pos++;
+    }
+}
+
+static bool json_fail(JsonParser* parser, const char* error) {
+    if (!parser->error) parser->error = error;
+    return false;
+}
+
+/* String after the opening quote; \u escapes outside ASCII become '?' */
+static char* json_parse_string(JsonParser* parser) {
+    size_t cap = 16, len = 0;
+    char* out = malloc(cap);
+    if (!out) return NULL;
+
+    for (;;) {
+        char c = *parser->pos++;
+        if (c == '"') break;
+        if (c == '\0' || (unsigned char)c < 0x20) {
+            free(out);
+            json_fail(parser, "unterminated string");
+            return NULL;
+        }
+        if (c == '\\') {
+            char e = *parser->pos++;
+            switch (e) {
+                case 'n': c = '\n'; break;
+                case 't': c = '\t'; break;
+                case 'r': c = '\r'; break;
+                case 'b': c = '\b'; break;
+                case 'f': c = '\f'; break;
+                case '"': case '\\': case '/': c = e; break;
+                case 'u': {
+                    unsigned code = 0;
+                    for (int i = 0; i < 4; i++) {
+                        char h = *parser->pos++;
+                        code <<= 4;
+                        if (h >= '0' && h <= '9') code |= (unsigned)(h - '0');
+                        else if (h >= 'a' && h <= 'f') code |= (unsigned)(h - 'a' + 10);
+                        else if (h >= 'A' && h <= 'F') code |= (unsigned)(h - 'A' + 10);
+                        else {
+                            free(out);
+                            json_fail(parser, "bad \\u escape");
+                            return NULL;
+                        }
+                    }
+                    c = (code < 0x80) ? (char)code : '?';
+                    break;
+                }
+                default:
+                    free(out);
+                    json_fail(parser, "bad escape");
+                    return NULL;
+            }
+        }
+        if (len + 1 >= cap) {
+            char* grown = realloc(out, cap * 2);
+            if (!grown) {
+                free(out);
+                return NULL;
+            }
+            out = grown;
+            cap *= 2;
+        }
+        out[len++] = c;
+    }
+    out[len] = '\0';
+    return out;
+}
+
+/* Append a zeroed item to an array or object; NULL when out of memory */
+static JsonValue* json_push(JsonParser* parser, JsonValue* value) {
+    /* Capacity is 4, then doubles whenever count reaches a power of two */
+    if (value->count == 0 || (value->count >= 4 && (value->count & (value->count - 1)) == 0)) {
+        int cap = value->count ? value->count * 2 : 4;
+        JsonValue* grown = realloc(value->items, (size_t)cap * sizeof(JsonValue));
+        if (!grown) {
+            json_fail(parser, "out of memory");
+            return NULL;
+        }
+        value->items = grown;
+    }
+    JsonValue* item = &value->items[value->count++];
+    memset(item, 0, sizeof(*item));
+    return item;
+}
+
+static bool json_parse_container(JsonParser* parser, JsonValue* value, int depth) {
+    bool object = value->type == JSON_OBJECT;
+    char close = object ? '}' : ']';
+
+    json_skip_space(parser);
+    if (*parser->pos == close) {
+        parser->pos++;
+        return true;
+    }
+    for (;;) {
+        JsonValue* item = json_push(parser, value);
+        if (!item) return false;
+        json_skip_space(parser);
+        if (object) {
+            if (*parser->pos++ != '"') return json_fail(parser, "expected member name");
+            item->key = json_parse_string(parser);
+            if (!item->key) return json_fail(parser, "bad member name");
+            json_skip_space(parser);
+            if (*parser->pos++ != ':') return json_fail(parser, "expected ':'");
+        }
+        if (!json_parse_value(parser, item, depth + 1)) return false;
+        json_skip_space(parser);
+        char c = *parser->pos++;
+        if (c == close) return true;
+        if (c != ',') return json_fail(parser, object ? "expected ',' or '}'" : "expected ',' or ']'");
+    }
+}
+
+static bool json_parse_value(JsonParser* parser, JsonValue* value, int depth) {
+    if (depth > JSON_DEPTH_MAX) return json_fail(parser, "nested too deeply");
+
+    json_skip_space(parser);
+    char c = *parser->pos;
+    if (c == '{' || c == '[') {
+        parser->pos++;
+        value->type = (c == '{') ? JSON_OBJECT : JSON_ARRAY;
+        return json_parse_container(parser, value, depth);
+    }
+    if (c == '"') {
+        parser->pos++;
+        value->type = JSON_STRING;
+        value->string = json_parse_string(parser);
+        return value->string != NULL || json_fail(parser, "bad string");
+    }
+    if (strncmp(parser->pos, "true", 4) == 0 || strncmp(parser->pos, "false", 5) == 0) {
+        value->type = JSON_BOOL;
+        value->number = (c == 't');
+        parser->pos += (c == 't') ? 4 : 5;
+        return true;
+    }
+    if (strncmp(parser->pos, "null", 4) == 0) {
+        value->type = JSON_NULL;
+        parser->pos += 4;
+        return true;
+    }
+
+    char* end;
+    value->type = JSON_NUMBER;
+    value->number = strtod(parser->pos, &end);
+    if (end == parser->pos) return json_fail(parser, "unexpected character");
+    parser->pos = end;
+    return true;
+}
+
+/* =============================================================================
+ * Public API
+ * ============================================================================= */
+
+JsonValue* json_parse(const char* text, const char* name) {
+    JsonParser parser = { .text = text, .pos = text };
+    JsonValue* root = calloc(1, sizeof(JsonValue));
+    bool ok = root && json_parse_value(&parser, root, 0);
+    if (ok) {
+        json_skip_space(&parser);
+        if (*parser.pos != '\0') ok = json_fail(&parser, "trailing characters");
+    }
+    if (!ok) {
+        fprintf(stderr, "%s: invalid JSON at offset %ld: %s\n", name,
+                (long)(parser.pos - parser.text), parser.error ? parser.error : "out of memory");
+        json_free(root);
+        root = NULL;
+    }
+    return root;
+}
+
+JsonValue* json_parse_file(const char* path) {
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        fprintf(stderr, "Cannot open %s\n", path);
+        return NULL;
+    }
+
+    char* text = NULL;
+    long size = -1;
+    if (fseek(file, 0, SEEK_END) == 0) size = ftell(file);
+    if (size >= 0 && fseek(file, 0, SEEK_SET) == 0) text = malloc((size_t)size + 1);
+    if (!text || fread(text, 1, (size_t)size, file) != (size_t)size) {
+        fprintf(stderr, "Failed to read %s\n", path);
+        free(text);
+        fclose(file);
+        return NULL;
+    }
+    text[size] = '\0';
+    fclose(file);
+
+    JsonValue* root = json_parse(text, path);
+    free(text);
+    return root;
+}
+
+const JsonValue* json_get(const JsonValue* object, const char* key) {
+    if (!object || object->type != JSON_OBJECT) return NULL;
+    for (int i = 0; i < object->count; i++) {
+        if (strcmp(object->items[i].key, key) == 0) return &object->items[i];
+    }
+    return NULL;
+}
+
+double json_get_number(const JsonValue* object, const char* key, double fallback) {
+    const JsonValue* value = json_get(object, key);
+    return (value && value->type == JSON_NUMBER) ? value->number : fallback;
+}
@@ -0,0 +1,46 @@
+/*
+ * json.h - Minimal JSON reader for benchmark baselines
+ *
+ * Parses a whole document into a tree. Objects keep their members in file
+ * order; lookups are linear, which is fine for report-sized files.
+ */
+#ifndef BENCH_JSON_H
+#define BENCH_JSON_H
+
+#include <stdbool.h>
+
+typedef enum {
+    JSON_NULL = 0,
+    JSON_BOOL,
+    JSON_NUMBER,
+    JSON_STRING,
+    JSON_ARRAY,
+    JSON_OBJECT,
+} JsonType;
+
+typedef struct JsonValue JsonValue;
+
+struct JsonValue {
+    JsonType type;
+    double number;            /* JSON_NUMBER, JSON_BOOL (0 or 1) */
+    char* string;             /* JSON_STRING */
+    char* key;                /* Member name, inside an object */
+    JsonValue* items;         /* JSON_ARRAY elements or JSON_OBJECT members */
+    int count;
+};
+
+/* Parse a document; NULL with a message on stderr naming it on error */
+JsonValue* json_parse(const char* text, const char* name);
+
+/* Parse a file; NULL with a message on stderr on error */
+JsonValue* json_parse_file(const char* path);
+
+void json_free(JsonValue* value);
+
+/* Object member by name, NULL if absent or not an object */
+const JsonValue* json_get(const JsonValue* object, const char* key);
+
+/* Number member, or fallback if absent or not a number */
+double json_get_number(const JsonValue* object, const char* key, double fallback);
+
+#endif /* BENCH_JSON_H */
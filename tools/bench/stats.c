@@ -0,0 +1,139 @@
+/*
+ * stats.c - Sample statistics implementation
+ *
+ * The t distribution goes through the regularized incomplete beta
+ * function, evaluated with Lentz's continued fraction.
+ */
+#include "stats.h"
+#include <math.h>
+#include <stdlib.h>
+
+#define STATS_CF_ITERATIONS 300
+#define STATS_CF_EPSILON    1e-14
+#define STATS_TINY          1e-300
+
+double stats_mean(const double* x, int n) {
+    double sum = 0.0;
+    for (int i = 0; i < n; i++) sum += x[i];
+    return n > 0 ? sum / n : 0.0;
+}
+
+double stats_stddev(const double* x, int n) {
+    if (n < 2) return 0.0;
+    double mean = stats_mean(x, n), sum = 0.0;
+    for (int i = 0; i < n; i++) sum += (x[i] - mean) * (x[i] - mean);
+    return sqrt(sum / (n - 1));
+}
+
+double stats_quantile(const double* sorted, int n, double q) {
+    if (n <= 0) return 0.0;
+    double pos = q * (n - 1);
+    int i = (int)pos;
+    if (i >= n - 1) return sorted[n - 1];
+    return sorted[i] + (sorted[i + 1] - sorted[i]) * (pos - i);
+}
+
+static int stats_compare(const void* a, const void* b) {
+    double da = *(const double*)a, db = *(const double*)b;
+    return (da > db) - (da < db);
+}
+
+void stats_sort(double* x, int n) {
+    qsort(x, (size_t)n, sizeof(double), stats_compare);
+}
+
+/* =============================================================================
+ * Student's t Distribution
+ * ============================================================================= */
+
+/* Continued fraction of the incomplete beta function */
+static double stats_beta_cf(double a, double b, double x) {
+    double c = 1.0, d = 1.0 - (a + b) * x / (a + 1.0);
+    if (fabs(d) < STATS_TINY) d = STATS_TINY;
+    d = 1.0 / d;
+    double h = d;
+
+    for (int m = 1; m <= STATS_CF_ITERATIONS; m++) {
+        double m2 = 2.0 * m;
+        double num = m * (b - m) * x / ((a + m2 - 1.0) * (a + m2));
+        d = 1.0 + num * d;
+        c = 1.0 + num / c;
+        if (fabs(d) < STATS_TINY) d = STATS_TINY;
+        if (fabs(c) < STATS_TINY) c = STATS_TINY;
+        d = 1.0 / d;
+        h *= d * c;
+
+        num = -(a + m) * (a + b + m) * x / ((a + m2) * (a + m2 + 1.0));
+        d = 1.0 + num * d;
+        c = 1.0 + num / c;
+        if (fabs(d) < STATS_TINY) d = STATS_TINY;
+        if (fabs(c) < STATS_TINY) c = STATS_TINY;
+        d = 1.0 / d;
+        double delta = d * c;
+        h *= delta;
+        if (fabs(delta - 1.0) < STATS_CF_EPSILON) break;
+    }
+    return h;
+}
+
+/* Regularized incomplete beta function I_x(a, b) */
+static double stats_beta_inc(double a, double b, double x) {
+    if (x <= 0.0) return 0.0;
+    if (x >= 1.0) return 1.0;
+    double front = exp(lgamma(a + b) - lgamma(a) - lgamma(b) + a * log(x) + b * log(1.0 - x));
+    if (x < (a + 1.0) / (a + b + 2.0)) return front * stats_beta_cf(a, b, x) / a;
+    return 1.0 - front * stats_beta_cf(b, a, 1.0 - x) / b;
+}
+
+double stats_t_cdf(double t, double df) {
+    double tail = 0.5 * stats_beta_inc(df / 2.0, 0.5, df / (df + t * t));
+    return t >= 0.0 ? 1.0 - tail : tail;
+}
+
+double stats_t_quantile(double p, double df) {
+    /* The CDF is monotonic: bisect on a bracket wide enough for df >= 1 */
+    double lo = -1e4, hi = 1e4;
+    for (int i = 0; i < 200 && hi - lo > 1e-12; i++) {
+        double mid = 0.5 * (lo + hi);
+        if (stats_t_cdf(mid, df) < p) lo = mid;
+        else hi = mid;
+    }
+    return 0.5 * (lo + hi);
+}
+
+/* =============================================================================
+ * Welch's t-test
+ * ============================================================================= */
+
+bool stats_welch(const double* a, int na, const double* b, int nb, double confidence,
+                 WelchResult* result) {
+    if (na < 2 || nb < 2) return false;
+
+    double sa = stats_stddev(a, na), sb = stats_stddev(b, nb);
+    double va = sa * sa / na, vb = sb * sb / nb;
+    double se = sqrt(va + vb);
+
+    result->mean_a = stats_mean(a, na);
+    result->mean_b = stats_mean(b, nb);
+    result->diff = result->mean_b - result->mean_a;
+
+    if (se == 0.0) {
+        /* Both sides constant: the difference is exact */
+        result->t = (result->diff == 0.0) ? 0.0 : copysign(INFINITY, result->diff);
+        result->df = na + nb - 2;
+        result->p = (result->diff == 0.0) ? 1.0 : 0.0;
+        result->ci_low = result->ci_high = result->diff;
+        return true;
+    }
+
+    /* Welch-Satterthwaite degrees of freedom */
+    double df = (va + vb) * (va + vb) / (va * va / (na - 1) + vb * vb / (nb - 1));
+    double t_crit = stats_t_quantile(0.5 + confidence / 2.0, df);
+
+    result->t = result->diff / se;
+    result->df = df;
+    result->p = 2.0 * (1.0 - stats_t_cdf(fabs(result->t), df));
+    result->ci_low = result->diff - t_crit * se;
+    result->ci_high = result->diff + t_crit * se;
+    return true;
+}
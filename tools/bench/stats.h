@@ -0,0 +1,39 @@
+/*
+ * stats.h - Sample statistics for benchmark comparisons
+ */
+#ifndef BENCH_STATS_H
+#define BENCH_STATS_H
+
+#include <stdbool.h>
+
+/* Welch's unequal-variance t-test of b against a */
+typedef struct {
+    double mean_a, mean_b;
+    double diff;              /* mean_b - mean_a */
+    double ci_low, ci_high;   /* Confidence interval of diff */
+    double t, df;
+    double p;                 /* Two-sided p-value */
+} WelchResult;
+
+double stats_mean(const double* x, int n);
+
+/* Sample standard deviation (n - 1 denominator); 0 below two samples */
+double stats_stddev(const double* x, int n);
+
+/* Quantile q in [0, 1] of sorted data, linearly interpolated */
+double stats_quantile(const double* sorted, int n, double q);
+
+/* Sort ascending in place */
+void stats_sort(double* x, int n);
+
+/* Student's t distribution with df degrees of freedom: P(T <= t), and the
+ * t with P(T <= t) = p */
+double stats_t_cdf(double t, double df);
+double stats_t_quantile(double p, double df);
+
+/* Two-sided interval at the given confidence (e.g. 0.95); false when
+ * either side has fewer than two samples */
+bool stats_welch(const double* a, int na, const double* b, int nb, double confidence,
+                 WelchResult* result);
+
+#endif /* BENCH_STATS_H */
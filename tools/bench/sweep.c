@@ -0,0 +1,282 @@
+/*
+ * sweep.c - Scaling sweep implementation
+ *
+ * Throughput is cell-ticks per second (grid cells times ticks/s), so sizes
+ * compare directly. Parallel efficiency is the speedup over the smallest
+ * thread count of the same size divided by the thread ratio. Memory per
+ * cell is the child's peak RSS over the cell count, so small grids include
+ * the fixed process overhead.
+ */
+#include "sweep.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "core/types.h"
+#include "core/utils.h"
+#include "engine/workers.h"
+#include "json.h"
+
+#define SWEEP_GRID_MIN     256
+#define SWEEP_GRID_MAX     8192
+#define SWEEP_COMMAND_SIZE 4096
+
+typedef struct {
+    int grid;
+    int threads;                  /* As reported by the run */
+    double ticks_per_s;
+    double cell_ticks_per_s;
+    double updates_per_s;         /* Cells moved or changed per second */
+    double speedup;               /* Over the first run of the same size */
+    double efficiency;
+    double bytes_per_cell;
+    double active_fraction;       /* Mean active chunks over all chunks */
+} SweepRow;
+
+/* =============================================================================
+ * Lists
+ * ============================================================================= */
+
+static void sweep_insert(int* list, int* count, int value) {
+    int i = *count;
+    while (i > 0 && list[i - 1] > value) {
+        list[i] = list[i - 1];
+        i--;
+    }
+    if (i > 0 && list[i - 1] == value) {
+        memmove(&list[i], &list[i + 1], (size_t)(*count - i) * sizeof(int));
+        return;
+    }
+    list[i] = value;
+    (*count)++;
+}
+
+bool sweep_parse_list(const char* text, int* out, int max, int* count) {
+    *count = 0;
+    while (*text) {
+        char* end;
+        long value = strtol(text, &end, 10);
+        if (end == text || value < 1 || value > 0x7FFFFFFF || *count == max) return false;
+        sweep_insert(out, count, (int)value);
+        if (*end == ',') end++;
+        else if (*end != '\0') return false;
+        text = end;
+    }
+    return *count > 0;
+}
+
+void sweep_default_grids(SweepOptions* opts) {
+    opts->grid_count = 0;
+    for (int n = SWEEP_GRID_MIN; n <= SWEEP_GRID_MAX; n *= 2) {
+        opts->grids[opts->grid_count++] = n;
+    }
+}
+
+void sweep_default_threads(SweepOptions* opts) {
+    int cpus = MIN(workers_cpu_count(), WORKERS_MAX);
+    opts->thread_count = 0;
+    for (int n = 1; n <= cpus; n *= 2) {
+        sweep_insert(opts->threads, &opts->thread_count, n);
+    }
+    sweep_insert(opts->threads, &opts->thread_count, cpus);
+}
+
+/* =============================================================================
+ * Runs
+ * ============================================================================= */
+
+/* Binary for an N x N grid: pixelsim-bench-N next to this one, or this one
+ * when it was built for that size; false if neither exists */
+static bool sweep_binary(const SweepOptions* opts, int grid, char* path, size_t size) {
+    const char* slash = strrchr(opts->self, '/');
+    int dir_len = slash ? (int)(slash - opts->self) + 1 : 0;
+
+    snprintf(path, size, "%.*spixelsim-bench-%d", dir_len, opts->self, grid);
+    if (access(path, X_OK) == 0) return true;
+    if (grid == GRID_WIDTH && grid == GRID_HEIGHT && strchr(opts->self, '/')) {
+        snprintf(path, size, "%s", opts->self);
+        return true;
+    }
+    return false;
+}
+
+/* Append text in single quotes for the shell */
+static void sweep_quote(char* out, size_t size, const char* text) {
+    size_t len = strlen(out);
+    if (len + 1 < size) out[len++] = '\'';
+    for (; *text && len + 5 < size; text++) {
+        if (*text == '\'') {
+            memcpy(&out[len], "'\\''", 4);
+            len += 4;
+        } else {
+            out[len++] = *text;
+        }
+    }
+    if (len + 1 < size) out[len++] = '\'';
+    out[len] = '\0';
+}
+
+/* Run the binary and return its whole stdout, NULL if it failed */
+static char* sweep_capture(const char* command) {
+    FILE* pipe = popen(command, "r");
+    if (!pipe) return NULL;
+
+    size_t cap = 4096, len = 0;
+    char* text = malloc(cap);
+    while (text) {
+        if (len + 1 == cap) {
+            char* grown = realloc(text, cap * 2);
+            if (!grown) {
+                free(text);
+                text = NULL;
+                break;
+            }
+            text = grown;
+            cap *= 2;
+        }
+        size_t got = fread(&text[len], 1, cap - 1 - len, pipe);
+        if (got == 0) break;
+        len += got;
+    }
+
+    int status = pclose(pipe);
+    if (!text || status == -1 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        free(text);
+        return NULL;
+    }
+    text[len] = '\0';
+    return text;
+}
+
+static bool sweep_run_one(const SweepOptions* opts, const char* binary, int grid, int threads,
+                          SweepRow* row) {
+    char command[SWEEP_COMMAND_SIZE] = "";
+    sweep_quote(command, sizeof(command), binary);
+    size_t len = strlen(command);
+    snprintf(&command[len], sizeof(command) - len, " --ticks %d --warmup %d --seed %u --threads %d",
+             opts->ticks, opts->warmup, opts->seed, threads);
+    if (opts->chunk_size) {
+        len = strlen(command);
+        snprintf(&command[len], sizeof(command) - len, " --chunk-size %d", opts->chunk_size);
+    }
+    len = strlen(command);
+    snprintf(&command[len], sizeof(command) - len, " --scene ");
+    sweep_quote(command, sizeof(command), opts->scene);
+
+    char* text = sweep_capture(command);
+    JsonValue* report = text ? json_parse(text, binary) : NULL;
+    free(text);
+    if (!report) return false;
+
+    const JsonValue* scenes = json_get(report, "scenes");
+    const JsonValue* scene = (scenes && scenes->type == JSON_ARRAY && scenes->count > 0)
+                             ? &scenes->items[0] : NULL;
+    int chunk_size = (int)json_get_number(report, "chunk_size", 0);
+    double wall_s = json_get_number(scene, "wall_s", 0);
+    bool ok = scene && chunk_size > 0 && wall_s > 0.0;
+    if (ok) {
+        double cells = (double)grid * grid;
+        double chunks_side = (grid + chunk_size - 1) / chunk_size;
+
+        row->grid = grid;
+        row->threads = (int)json_get_number(report, "threads", threads);
+        row->ticks_per_s = json_get_number(report, "ticks", opts->ticks) / wall_s;
+        row->cell_ticks_per_s = row->ticks_per_s * cells;
+        row->updates_per_s = json_get_number(scene, "cells_updated_per_s", 0);
+        row->bytes_per_cell = json_get_number(report, "peak_rss_kb", 0) * 1024.0 / cells;
+        row->active_fraction = json_get_number(scene, "active_chunks_mean", 0) /
+                               (chunks_side * chunks_side);
+    }
+    json_free(report);
+    return ok;
+}
+
+/* =============================================================================
+ * Output
+ * ============================================================================= */
+
+static void sweep_print_header(void) {
+    printf("%7s %7s %10s %12s %12s %8s %10s %10s %8s\n", "grid", "threads", "ticks/s",
+           "Mcell-t/s", "Mupdates/s", "speedup", "efficiency", "bytes/cell", "active");
+}
+
+static void sweep_print_row(const SweepRow* row) {
+    printf("%7d %7d %10.2f %12.2f %12.2f %7.2fx %9.1f%% %10.1f %7.1f%%\n", row->grid,
+           row->threads, row->ticks_per_s, row->cell_ticks_per_s * 1e-6,
+           row->updates_per_s * 1e-6, row->speedup, row->efficiency * 100.0,
+           row->bytes_per_cell, row->active_fraction * 100.0);
+}
+
+static void sweep_write_csv(FILE* file, const SweepRow* rows, int count) {
+    fprintf(file, "grid,threads,ticks_per_s,cell_ticks_per_s,cells_updated_per_s,"
+                  "speedup,efficiency,bytes_per_cell,active_chunk_fraction\n");
+    for (int i = 0; i < count; i++) {
+        const SweepRow* row = &rows[i];
+        fprintf(file, "%d,%d,%.4f,%.0f,%.0f,%.4f,%.4f,%.2f,%.4f\n", row->grid, row->threads,
+                row->ticks_per_s, row->cell_ticks_per_s, row->updates_per_s, row->speedup,
+                row->efficiency, row->bytes_per_cell, row->active_fraction);
+    }
+}
+
+/* =============================================================================
+ * Public API
+ * ============================================================================= */
+
+int sweep_run(const SweepOptions* opts) {
+    SweepRow* rows = calloc((size_t)opts->grid_count * opts->thread_count, sizeof(SweepRow));
+    if (!rows) {
+        fprintf(stderr, "Out of memory\n");
+        return 1;
+    }
+
+    int count = 0, status = 0;
+    printf("Scene %s, %d ticks after %d warm-up, seed %u\n", opts->scene, opts->ticks,
+           opts->warmup, opts->seed);
+    sweep_print_header();
+    fflush(stdout);
+
+    for (int g = 0; g < opts->grid_count; g++) {
+        int grid = opts->grids[g];
+        char binary[1024];
+        if (!sweep_binary(opts, grid, binary, sizeof(binary))) {
+            fprintf(stderr, "Skipping %dx%d: no pixelsim-bench-%d (make pixelsim-bench-%d)\n",
+                    grid, grid, grid, grid);
+            status = 1;
+            continue;
+        }
+
+        const SweepRow* base = NULL;
+        for (int t = 0; t < opts->thread_count; t++) {
+            SweepRow* row = &rows[count];
+            if (!sweep_run_one(opts, binary, grid, opts->threads[t], row)) {
+                fprintf(stderr, "Run failed: %dx%d with %d threads\n", grid, grid,
+                        opts->threads[t]);
+                status = 1;
+                continue;
+            }
+            if (!base) base = row;
+            row->speedup = base->ticks_per_s > 0.0 ? row->ticks_per_s / base->ticks_per_s : 0.0;
+            row->efficiency = row->speedup * base->threads / row->threads;
+            sweep_print_row(row);
+            fflush(stdout);
+            count++;
+        }
+    }
+
+    if (opts->csv) {
+        FILE* file = strcmp(opts->csv, "-") == 0 ? stdout : fopen(opts->csv, "w");
+        if (file) {
+            if (file == stdout) printf("\n");
+            sweep_write_csv(file, rows, count);
+            if (file != stdout) fclose(file);
+        } else {
+            fprintf(stderr, "Cannot write %s\n", opts->csv);
+            status = 1;
+        }
+    }
+
+    free(rows);
+    return status;
+}
@@ -0,0 +1,44 @@
+/*
+ * sweep.h - Grid-size and thread-count scaling sweep
+ *
+ * The grid size is fixed at compile time, so each size is a separate
+ * pixelsim-bench-N binary (make bench-grids) next to pixelsim-bench. The
+ * sweep runs one scene in a fresh process per grid size and thread count,
+ * reads its JSON report and prints a scaling table, optionally as CSV.
+ */
+#ifndef BENCH_SWEEP_H
+#define BENCH_SWEEP_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define SWEEP_GRIDS_MAX   16
+#define SWEEP_THREADS_MAX 32
+
+typedef struct {
+    const char* self;             /* argv[0], to find the per-size binaries */
+    const char* scene;            /* Built-in name or scene file */
+    int grids[SWEEP_GRIDS_MAX];   /* Square grid sides, ascending */
+    int grid_count;
+    int threads[SWEEP_THREADS_MAX]; /* Thread counts, ascending */
+    int thread_count;
+    int ticks;
+    int warmup;
+    uint32_t seed;
+    int chunk_size;               /* 0 = default */
+    const char* csv;              /* CSV path, "-" for stdout, NULL for none */
+} SweepOptions;
+
+/* Parse a comma-separated list of positive integers into out, sorted
+ * ascending without duplicates; false if malformed or too long */
+bool sweep_parse_list(const char* text, int* out, int max, int* count);
+
+/* Default lists: 256 to 8192 in powers of two, and powers of two up to the
+ * CPU count plus the CPU count itself */
+void sweep_default_grids(SweepOptions* opts);
+void sweep_default_threads(SweepOptions* opts);
+
+/* Returns 0 when every run succeeded, 1 otherwise */
+int sweep_run(const SweepOptions* opts);
+
+#endif /* BENCH_SWEEP_H */
@@ -0,0 +1,473 @@
+/*
+ * microbench.c - Microbenchmarks of the inline cell and physics primitives
+ * (pixelsim-microbench)
+ *
+ * Times cell_can_move, cell_move, phys_apply_gravity_fixed,
+ * phys_column_height, grid_iterate and behavior_get in isolation. Inputs
+ * come from a scene run for a number of ticks, so each primitive sees the
+ * material mix and neighbourhoods of a settled world, visited in row order
+ * like the sweeps visit them. The process is pinned to one CPU; every
+ * benchmark runs warm-up samples, then timed samples read from the
+ * time-stamp counter, and reports cycles per call (min, median, p90) and
+ * the median in nanoseconds.
+ */
+#define _GNU_SOURCE
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "core/types.h"
+#include "core/utils.h"
+#include "materials/material.h"
+#include "materials/behavior.h"
+#include "world/world.h"
+#include "world/cell_ops.h"
+#include "world/grid_iter.h"
+#include "world/scene.h"
+#include "physics/physics.h"
+#include "engine/simulation.h"
+#include "../bench/stats.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define MICRO_X86 1
+#include <x86intrin.h>
+#endif
+
+#define MICRO_CELLS_MAX         (1 << 16)   /* Inputs per list, sampled evenly in row order */
+#define MICRO_SAMPLES_DEFAULT   200
+#define MICRO_WARMUP_DEFAULT    20
+#define MICRO_TICKS_DEFAULT     60          /* Ticks run before the inputs are taken */
+#define MICRO_SCENE_DEFAULT     "mixed"
+#define MICRO_SEED              12345u
+#define MICRO_CALIBRATE_NS      50000000    /* Counter frequency measured over 50 ms */
+
+/* One input: a cell, its material and a neighbour it might move to */
+typedef struct {
+    int x, y;
+    int tx, ty;
+    MaterialID mat;
+    const MaterialProps* props;
+} MicroCell;
+
+typedef struct {
+    int count;
+    MicroCell* cells;
+} MicroList;
+
+typedef struct {
+    Simulation* sim;
+    World* world;
+    MicroList movers;             /* Powder, fluid and gas cells */
+    MicroList moves;              /* Movers whose target is enterable */
+    MicroList fallers;            /* Cells with BHV_FALLS */
+    MicroList fluids;             /* Fluid cells */
+    MaterialID* mats;             /* Materials of every sampled cell */
+    int mat_count;
+    volatile uint64_t sink;       /* Keeps results live */
+} MicroContext;
+
+/* A benchmark runs one sample and returns the number of calls it made */
+typedef struct {
+    const char* name;
+    const char* description;
+    uint64_t (*run)(MicroContext* ctx);
+} MicroBench;
+
+typedef struct {
+    const char* scene;            /* --scene NAME|FILE */
+    const char* filter;           /* --filter TEXT: only names containing it */
+    int ticks;                    /* --ticks N */
+    int samples;                  /* --samples N */
+    int warmup;                   /* --warmup N, untimed samples first */
+    int cpu;                      /* --cpu N, -1 = the CPU at startup */
+} MicroOptions;
+
+/* =============================================================================
+ * Timing
+ * ============================================================================= */
+
+#ifdef MICRO_X86
+#define MICRO_UNIT "cycles"
+
+/* Time-stamp counter, fenced so the timed code cannot drift across it */
+static inline uint64_t micro_cycles(void) {
+    _mm_lfence();
+    uint64_t t = __rdtsc();
+    _mm_lfence();
+    return t;
+}
+#else
+#define MICRO_UNIT "ns"
+
+static inline uint64_t micro_cycles(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+#endif
+
+static uint64_t micro_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+/* Counter ticks per nanosecond */
+static double micro_calibrate(void) {
+    uint64_t ns0 = micro_ns(), c0 = micro_cycles(), ns1;
+    do {
+        ns1 = micro_ns();
+    } while (ns1 - ns0 < MICRO_CALIBRATE_NS);
+    return (double)(micro_cycles() - c0) / (double)(ns1 - ns0);
+}
+
+/* Pin the process to one CPU; returns the CPU, or -1 if pinning failed */
+static int micro_pin(int cpu) {
+    if (cpu < 0) cpu = sched_getcpu();
+    if (cpu < 0) return -1;
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return sched_setaffinity(0, sizeof(set), &set) == 0 ? cpu : -1;
+}
+
+/* =============================================================================
+ * Inputs
+ * ============================================================================= */
+
+typedef bool (*MicroFilter)(const World* world, const MicroCell* cell);
+
+static bool micro_is_mover(const World* world, const MicroCell* cell) {
+    (void)world;
+    MaterialState state = material_state(cell->mat);
+    return state == STATE_POWDER || state == STATE_FLUID || state == STATE_GAS;
+}
+
+static bool micro_can_enter(const World* world, const MicroCell* cell) {
+    return micro_is_mover(world, cell) &&
+           cell_can_move(world, cell->mat, cell->tx, cell->ty) != MOVE_BLOCKED;
+}
+
+static bool micro_is_faller(const World* world, const MicroCell* cell) {
+    (void)world;
+    return bhv_falls(cell->mat);
+}
+
+static bool micro_is_fluid(const World* world, const MicroCell* cell) {
+    (void)world;
+    return material_state(cell->mat) == STATE_FLUID;
+}
+
+/* Cell at (x, y) with a target one row along its movement direction:
+ * up for rising materials, down otherwise, straight or diagonal */
+static MicroCell micro_cell(const World* world, int x, int y, uint32_t* rng) {
+    MicroCell cell = { .x = x, .y = y };
+    cell.mat = world->mat[IDX(x, y)];
+    cell.props = material_get(cell.mat);
+    *rng = *rng * 1664525u + 1013904223u;
+    cell.tx = x + (int)((*rng >> 16) % 3) - 1;
+    cell.ty = y + (bhv_rises(cell.mat) ? -1 : 1);
+    return cell;
+}
+
+/* Cells passing the filter in row order, at most MICRO_CELLS_MAX of them
+ * spread evenly over the grid; false when out of memory */
+static bool micro_collect(const World* world, MicroFilter filter, MicroList* list) {
+    uint32_t rng = MICRO_SEED;
+    int total = 0;
+    for (int y = 0; y < GRID_HEIGHT; y++) {
+        for (int x = 0; x < GRID_WIDTH; x++) {
+            MicroCell cell = micro_cell(world, x, y, &rng);
+            total += filter(world, &cell);
+        }
+    }
+
+    int stride = (total + MICRO_CELLS_MAX - 1) / MICRO_CELLS_MAX;
+    list->count = 0;
+    list->cells = malloc((size_t)MAX(MIN(total, MICRO_CELLS_MAX), 1) * sizeof(MicroCell));
+    if (!list->cells) return false;
+
+    rng = MICRO_SEED;
+    int seen = 0;
+    for (int y = 0; y < GRID_HEIGHT; y++) {
+        for (int x = 0; x < GRID_WIDTH; x++) {
+            MicroCell cell = micro_cell(world, x, y, &rng);
+            if (!filter(world, &cell)) continue;
+            if (seen++ % stride == 0 && list->count < MICRO_CELLS_MAX) {
+                list->cells[list->count++] = cell;
+            }
+        }
+    }
+    return true;
+}
+
+/* Build the scene, run it for a while and take the inputs from the result */
+static bool micro_setup(MicroContext* ctx, const MicroOptions* opts) {
+    if (!scene_apply(ctx->world, opts->scene)) return false;
+    simulation_reset(ctx->sim);
+    ctx->sim->rng_state = MICRO_SEED;
+    for (int t = 0; t < opts->ticks; t++) {
+        simulation_tick(ctx->sim, ctx->world);
+    }
+
+    int stride = (GRID_SIZE + MICRO_CELLS_MAX - 1) / MICRO_CELLS_MAX;
+    ctx->mats = malloc((size_t)MICRO_CELLS_MAX * sizeof(MaterialID));
+    if (!ctx->mats) return false;
+    for (int i = 0; i < GRID_SIZE && ctx->mat_count < MICRO_CELLS_MAX; i += stride) {
+        ctx->mats[ctx->mat_count++] = ctx->world->mat[i];
+    }
+
+    return micro_collect(ctx->world, micro_is_mover, &ctx->movers) &&
+           micro_collect(ctx->world, micro_can_enter, &ctx->moves) &&
+           micro_collect(ctx->world, micro_is_faller, &ctx->fallers) &&
+           micro_collect(ctx->world, micro_is_fluid, &ctx->fluids);
+}
+
+static void micro_teardown(MicroContext* ctx) {
+    free(ctx->movers.cells);
+    free(ctx->moves.cells);
+    free(ctx->fallers.cells);
+    free(ctx->fluids.cells);
+    free(ctx->mats);
+}
+
+/* =============================================================================
+ * Benchmarks
+ * ============================================================================= */
+
+static uint64_t micro_run_can_move(MicroContext* ctx) {
+    const MicroList* list = &ctx->movers;
+    uint64_t acc = 0;
+    for (int i = 0; i < list->count; i++) {
+        const MicroCell* c = &list->cells[i];
+        acc += cell_can_move(ctx->world, c->mat, c->tx, c->ty);
+    }
+    ctx->sink += acc;
+    return (uint64_t)list->count;
+}
+
+/* Every move is made and then undone in reverse order, so the world is
+ * the same at the start of each sample */
+static uint64_t micro_run_move(MicroContext* ctx) {
+    const MicroList* list = &ctx->moves;
+    uint64_t acc = 0;
+    for (int i = 0; i < list->count; i++) {
+        const MicroCell* c = &list->cells[i];
+        acc += cell_move(ctx->world, c->x, c->y, c->tx, c->ty);
+    }
+    for (int i = list->count - 1; i >= 0; i--) {
+        const MicroCell* c = &list->cells[i];
+        acc += cell_move(ctx->world, c->x, c->y, c->tx, c->ty);
+    }
+    ctx->sink += acc;
+    return 2 * (uint64_t)list->count;
+}
+
+static uint64_t micro_run_gravity(MicroContext* ctx) {
+    const MicroList* list = &ctx->fallers;
+    for (int i = 0; i < list->count; i++) {
+        const MicroCell* c = &list->cells[i];
+        phys_apply_gravity_fixed(ctx->world, c->x, c->y, c->props);
+    }
+    ctx->sink += (uint64_t)ctx->world->vel_y[0];
+    return (uint64_t)list->count;
+}
+
+static uint64_t micro_run_column(MicroContext* ctx) {
+    const MicroList* list = &ctx->fluids;
+    uint64_t acc = 0;
+    for (int i = 0; i < list->count; i++) {
+        const MicroCell* c = &list->cells[i];
+        acc += (uint64_t)phys_column_height(ctx->world, c->x, c->y, c->mat);
+    }
+    ctx->sink += acc;
+    return (uint64_t)list->count;
+}
+
+static bool micro_visit(Simulation* sim, World* world, int x, int y, void* userdata) {
+    (void)sim;
+    uint64_t* counts = userdata;
+    counts[0]++;
+    counts[1] += world->mat[IDX(x, y)] != MAT_EMPTY;
+    return true;
+}
+
+/* Calls are the cells visited in active chunks */
+static uint64_t micro_run_iterate(MicroContext* ctx) {
+    uint64_t counts[2] = { 0, 0 };
+    grid_iterate(ctx->sim, ctx->world, ITER_BOTTOM_UP, ITER_LEFT_RIGHT, micro_visit, counts);
+    ctx->sink += counts[1];
+    return counts[0];
+}
+
+static uint64_t micro_run_behavior(MicroContext* ctx) {
+    uint64_t acc = 0;
+    for (int i = 0; i < ctx->mat_count; i++) {
+        acc ^= behavior_get(ctx->mats[i]);
+    }
+    ctx->sink += acc;
+    return (uint64_t)ctx->mat_count;
+}
+
+static const MicroBench BENCHES[] = {
+    { "cell_can_move", "movers against a neighbour in their movement direction",
+      micro_run_can_move },
+    { "cell_move", "movers swapped into an enterable neighbour, then back",
+      micro_run_move },
+    { "phys_apply_gravity_fixed", "velocity step of falling cells",
+      micro_run_gravity },
+    { "phys_column_height", "same-material column above fluid cells",
+      micro_run_column },
+    { "grid_iterate", "bottom-up sweep of active chunks, per visited cell",
+      micro_run_iterate },
+    { "behavior_get", "flag lookup for the materials of sampled cells",
+      micro_run_behavior },
+};
+#define MICRO_BENCH_COUNT ((int)(sizeof(BENCHES) / sizeof(BENCHES[0])))
+
+/* =============================================================================
+ * Measurement
+ * ============================================================================= */
+
+static void micro_measure(MicroContext* ctx, const MicroBench* bench, const MicroOptions* opts,
+                          double ticks_per_ns, double* per_call) {
+    uint64_t calls = 0;
+    for (int s = 0; s < opts->warmup; s++) {
+        calls = bench->run(ctx);
+    }
+
+    for (int s = 0; s < opts->samples; s++) {
+        uint64_t start = micro_cycles();
+        calls = bench->run(ctx);
+        uint64_t end = micro_cycles();
+        per_call[s] = calls ? (double)(end - start) / (double)calls : 0.0;
+    }
+
+    if (calls == 0) {
+        printf("%-26s %12s   (no inputs in this scene)\n", bench->name, "0");
+        return;
+    }
+    stats_sort(per_call, opts->samples);
+    double median = stats_quantile(per_call, opts->samples, 0.5);
+    printf("%-26s %12llu %10.2f %10.2f %10.2f %10.2f\n", bench->name, (unsigned long long)calls,
+           per_call[0], median, stats_quantile(per_call, opts->samples, 0.9),
+           median / ticks_per_ns);
+    fflush(stdout);
+}
+
+/* =============================================================================
+ * Command Line Options
+ * ============================================================================= */
+
+static void micro_usage(void) {
+    fprintf(stderr,
+            "Usage: pixelsim-microbench [--scene NAME|FILE] [--ticks N] [--samples N]\n"
+            "                           [--warmup N] [--cpu N] [--filter TEXT] [--list]\n");
+}
+
+static void micro_list(void) {
+    for (int i = 0; i < MICRO_BENCH_COUNT; i++) {
+        printf("%-26s %s\n", BENCHES[i].name, BENCHES[i].description);
+    }
+}
+
+/* Returns 1 on success, 0 to exit successfully (--list), -1 on error */
+static int micro_parse_options(int argc, char* argv[], MicroOptions* opts) {
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--list") == 0) {
+            micro_list();
+            return 0;
+        }
+        if (i + 1 >= argc) {
+            micro_usage();
+            return -1;
+        }
+        if (strcmp(argv[i], "--scene") == 0) {
+            opts->scene = argv[++i];
+            continue;
+        }
+        if (strcmp(argv[i], "--filter") == 0) {
+            opts->filter = argv[++i];
+            continue;
+        }
+
+        char* end;
+        long value = strtol(argv[i + 1], &end, 10);
+        bool valid = *end == '\0' && end != argv[i + 1] && value >= 0 && value <= 1000000;
+        if (strcmp(argv[i], "--ticks") == 0 && valid) opts->ticks = (int)value;
+        else if (strcmp(argv[i], "--samples") == 0 && valid && value > 0) opts->samples = (int)value;
+        else if (strcmp(argv[i], "--warmup") == 0 && valid) opts->warmup = (int)value;
+        else if (strcmp(argv[i], "--cpu") == 0 && valid) opts->cpu = (int)value;
+        else {
+            fprintf(stderr, "Bad option: %s %s\n", argv[i], argv[i + 1]);
+            micro_usage();
+            return -1;
+        }
+        i++;
+    }
+    return 1;
+}
+
+/* =============================================================================
+ * Main Entry Point
+ * ============================================================================= */
+
+int main(int argc, char* argv[]) {
+    MicroOptions opts = {
+        .scene = MICRO_SCENE_DEFAULT,
+        .ticks = MICRO_TICKS_DEFAULT,
+        .samples = MICRO_SAMPLES_DEFAULT,
+        .warmup = MICRO_WARMUP_DEFAULT,
+        .cpu = -1,
+    };
+    int parsed = micro_parse_options(argc, argv, &opts);
+    if (parsed <= 0) return parsed < 0 ? 1 : 0;
+
+    material_init();
+
+    /* One thread: inputs are taken from a serial run and the primitives are
+     * called outside any parallel pass */
+    MicroContext ctx = { 0 };
+    ctx.sim = simulation_create(TICK_HZ);
+    if (!ctx.sim || !simulation_set_threads(ctx.sim, 1)) {
+        fprintf(stderr, "Failed to create simulation\n");
+        if (ctx.sim) simulation_destroy(ctx.sim);
+        return 1;
+    }
+    ctx.world = world_create_placed(GRID_WIDTH, GRID_HEIGHT, ctx.sim->workers);
+    double* per_call = malloc((size_t)opts.samples * sizeof(double));
+    int status = 0;
+    if (!ctx.world || !per_call) {
+        fprintf(stderr, "Failed to create world\n");
+        status = 1;
+    } else if (!micro_setup(&ctx, &opts)) {
+        fprintf(stderr, "Failed to set up scene %s\n", opts.scene);
+        status = 1;
+    }
+
+    if (status == 0) {
+        int cpu = micro_pin(opts.cpu);
+        if (cpu < 0) fprintf(stderr, "Warning: could not pin to a CPU\n");
+        double ticks_per_ns = micro_calibrate();
+
+        printf("Scene %s after %d ticks, %dx%d grid, CPU %d, counter %.3f GHz\n", opts.scene,
+               opts.ticks, GRID_WIDTH, GRID_HEIGHT, cpu, ticks_per_ns);
+        printf("%d samples after %d warm-up samples, %s per call\n", opts.samples, opts.warmup,
+               MICRO_UNIT);
+        printf("%-26s %12s %10s %10s %10s %10s\n", "benchmark", "calls/sample", "min", "median",
+               "p90", "ns");
+        for (int i = 0; i < MICRO_BENCH_COUNT; i++) {
+            if (opts.filter && !strstr(BENCHES[i].name, opts.filter)) continue;
+            micro_measure(&ctx, &BENCHES[i], &opts, ticks_per_ns, per_call);
+        }
+    }
+
+    free(per_call);
+    micro_teardown(&ctx);
+    if (ctx.world) world_destroy(ctx.world);
+    simulation_destroy(ctx.sim);
+    return status;
+}